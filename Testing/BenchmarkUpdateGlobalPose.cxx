@@ -0,0 +1,165 @@
+// Times vtkSkeletonPose::UpdateGlobalPose against ComputeGlobalPose when one
+// bone, 10% and 100% of the bones of a synthetic skeleton change every frame,
+// and checks that both give the same global pose, also when the global pose
+// is resized.
+//
+// Usage: BenchmarkUpdateGlobalPose [number of bones] [number of frames]
+
+#include "vtkSkeletonHierarchy.h"
+#include "vtkSkeletonPose.h"
+
+#include <vtkIdTypeArray.h>
+#include <vtkNew.h>
+#include <vtkStringArray.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace
+{
+double GetClockTime()
+{
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Bone i is the child of bone (i - 1) / 4: a balanced tree, so that subtrees
+// of random bones are small, as in character rigs (fingers, face).
+void BuildSkeleton(vtkIdType nbBones, vtkSkeletonHierarchy* hierarchy, vtkSkeletonPose* localPose)
+{
+  localPose->SetNumberOfTransforms(nbBones);
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+  {
+    double position[3] = { 0.0, 1.0, 0.0 };
+    double orientation[4] = { 1.0, 0.0, 0.0, 0.0 };
+
+    hierarchy->GetNodeNames()->InsertNextValue("Bone" + std::to_string(boneId));
+    hierarchy->GetNodeTypes()->InsertNextTuple1(boneId);
+    hierarchy->InsertNextParentId(boneId == 0 ? -1 : static_cast<int>((boneId - 1) / 4));
+    hierarchy->GetNodeTransforms()->InsertNextTransform(position, orientation);
+    localPose->SetTransform(boneId, position, orientation);
+  }
+}
+
+// Rotate every stride-th bone by an angle depending on the frame
+void AnimateBones(vtkSkeletonPose* localPose, vtkIdType first, vtkIdType stride, int frame)
+{
+  double angle = 0.01 * (frame + 1);
+  double position[3] = { 0.0, 1.0, 0.0 };
+  double orientation[4] = { std::cos(angle), std::sin(angle), 0.0, 0.0 };
+  for (vtkIdType boneId = first; boneId < localPose->GetNumberOfTransforms(); boneId += stride)
+  {
+    localPose->SetTransform(boneId, position, orientation);
+  }
+}
+
+double GetMaximumDifference(vtkSkeletonPose* pose1, vtkSkeletonPose* pose2)
+{
+  double difference = 0.0;
+  for (vtkIdType boneId = 0; boneId < pose1->GetNumberOfTransforms(); boneId++)
+  {
+    double transform1[7];
+    double transform2[7];
+    pose1->GetTransform(boneId, transform1);
+    pose2->GetTransform(boneId, transform2);
+    for (int i = 0; i < 7; i++)
+    {
+      difference = std::max(difference, std::abs(transform1[i] - transform2[i]));
+    }
+  }
+  return difference;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  vtkIdType nbBones = argc > 1 ? std::atoi(argv[1]) : 1000;
+  int nbFrames = argc > 2 ? std::atoi(argv[2]) : 1000;
+  if (nbBones < 10 || nbFrames < 1)
+  {
+    std::cerr << "Usage: " << argv[0] << " [number of bones >= 10] [number of frames >= 1]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkSkeletonHierarchy> hierarchy;
+  vtkNew<vtkSkeletonPose> localPose;
+  BuildSkeleton(nbBones, hierarchy, localPose);
+
+  struct Case
+  {
+    const char* Name;
+    vtkIdType First;
+    vtkIdType Stride;
+  };
+  const Case cases[] = {
+    { "1 bone", nbBones / 2, nbBones },
+    { "10% of the bones", 0, 10 },
+    { "100% of the bones", 0, 1 },
+  };
+
+  std::cout << nbBones << " bones, " << nbFrames << " frames" << std::endl;
+
+  bool success = true;
+  for (const Case& c : cases)
+  {
+    vtkNew<vtkSkeletonPose> nodeGlobalPose;
+    vtkNew<vtkSkeletonPose> globalPose;
+    vtkNew<vtkSkeletonPose> referencePose;
+
+    // First call does the full evaluation
+    vtkSkeletonPose::UpdateGlobalPose(localPose, hierarchy, nodeGlobalPose, globalPose);
+
+    double incrementalTime = 0.0;
+    double fullTime = 0.0;
+    vtkIdType nbComputedNodes = 0;
+    for (int frame = 0; frame < nbFrames; frame++)
+    {
+      AnimateBones(localPose, c.First, c.Stride, frame);
+
+      double start = GetClockTime();
+      nbComputedNodes += vtkSkeletonPose::UpdateGlobalPose(localPose, hierarchy, nodeGlobalPose, globalPose);
+      incrementalTime += GetClockTime() - start;
+
+      start = GetClockTime();
+      vtkSkeletonPose::ComputeGlobalPose(localPose, hierarchy, referencePose);
+      fullTime += GetClockTime() - start;
+    }
+
+    double difference = GetMaximumDifference(globalPose, referencePose);
+    std::cout << c.Name << ": UpdateGlobalPose " << 1e6 * incrementalTime / nbFrames
+              << " us/frame (" << nbComputedNodes / nbFrames << " nodes), ComputeGlobalPose "
+              << 1e6 * fullTime / nbFrames << " us/frame, difference " << difference << std::endl;
+
+    if (difference > 1e-5)
+    {
+      std::cerr << c.Name << ": UpdateGlobalPose differs from ComputeGlobalPose" << std::endl;
+      success = false;
+    }
+
+    // Back to the rest pose for the next case
+    AnimateBones(localPose, 0, 1, -1);
+  }
+
+  // An empty global pose with up to date node caches must still be filled
+  {
+    vtkNew<vtkSkeletonPose> nodeGlobalPose;
+    vtkNew<vtkSkeletonPose> globalPose;
+    vtkNew<vtkSkeletonPose> referencePose;
+    vtkSkeletonPose::UpdateGlobalPose(localPose, hierarchy, nodeGlobalPose, globalPose);
+
+    vtkNew<vtkSkeletonPose> newGlobalPose;
+    vtkSkeletonPose::UpdateGlobalPose(localPose, hierarchy, nodeGlobalPose, newGlobalPose);
+    vtkSkeletonPose::ComputeGlobalPose(localPose, hierarchy, referencePose);
+    if (GetMaximumDifference(newGlobalPose, referencePose) > 1e-5)
+    {
+      std::cerr << "UpdateGlobalPose does not fill a resized global pose" << std::endl;
+      success = false;
+    }
+  }
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
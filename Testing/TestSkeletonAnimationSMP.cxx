@@ -0,0 +1,221 @@
+// Samples one immutable clip from vtkSMPTools threads, with
+// ComputeInterpolatedPose() and SampleNodeTransform(), and checks that the
+// results are the same as a serial run.
+
+#include "vtkSkeletonAnimation.h"
+#include "vtkSkeletonPose.h"
+
+#include <vtkNew.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+const vtkIdType NB_NODES = 300;
+const vtkIdType NB_TIMES = 256;
+const double DURATION = 100.0;
+
+// Values of one pose: 7 transform values then 3 scale values per node
+const int POSE_STRIDE = 10;
+
+// Clip with non uniform scales. Every third node has no keys, every fifth
+// one only has rotation keys, so that both keep rest pose values.
+void BuildClip(vtkSkeletonAnimation* animation)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+  std::uniform_real_distribution<double> scale(0.5, 2.0);
+  std::uniform_int_distribution<vtkIdType> nbKeys(2, 20);
+
+  vtkNew<vtkSkeletonPose> restPose;
+  restPose->SetScaleMode(vtkSkeletonPose::NON_UNIFORM_SCALE);
+  restPose->SetNumberOfTransforms(NB_NODES);
+  for (vtkIdType nodeId = 0; nodeId < NB_NODES; nodeId++)
+  {
+    double transform[7] = { value(generator), value(generator), value(generator), 1.0, 0.0, 0.0, 0.0 };
+    double restScale[3] = { scale(generator), scale(generator), scale(generator) };
+    restPose->SetTransform(nodeId, transform);
+    restPose->SetScale(nodeId, restScale);
+  }
+
+  animation->SetAnimationName("SMP");
+  animation->SetDuration(DURATION);
+  animation->SetTickPerSecond(25.0);
+  animation->SetNumberOfNodes(NB_NODES);
+  animation->SetRestPose(restPose);
+
+  for (vtkIdType nodeId = 0; nodeId < NB_NODES; nodeId++)
+  {
+    if (nodeId % 3 == 0)
+    {
+      continue;
+    }
+
+    for (int channelType = vtkSkeletonAnimation::POSITION; channelType <= vtkSkeletonAnimation::SCALING;
+         channelType++)
+    {
+      if (nodeId % 5 == 0 && channelType != vtkSkeletonAnimation::ROTATION)
+      {
+        continue;
+      }
+
+      vtkIdType nbChannelKeys = nbKeys(generator);
+      animation->AllocateNodeKeys(nodeId, channelType, nbChannelKeys);
+      for (vtkIdType keyId = 0; keyId < nbChannelKeys; keyId++)
+      {
+        double key[4];
+        if (channelType == vtkSkeletonAnimation::ROTATION)
+        {
+          double norm = 0.0;
+          for (int i = 0; i < 4; i++)
+          {
+            key[i] = value(generator);
+            norm += key[i] * key[i];
+          }
+          norm = std::sqrt(norm);
+          for (int i = 0; i < 4; i++)
+          {
+            key[i] /= norm;
+          }
+        }
+        else
+        {
+          for (int i = 0; i < 3; i++)
+          {
+            key[i] = channelType == vtkSkeletonAnimation::SCALING ? scale(generator) : value(generator);
+          }
+        }
+        double time = DURATION * keyId / (nbChannelKeys - 1);
+        animation->SetNodeKey(nodeId, channelType, keyId, key, time);
+      }
+    }
+  }
+
+  animation->SetImmutable();
+}
+
+double GetSampleTime(vtkIdType timeId)
+{
+  return DURATION * timeId / NB_TIMES;
+}
+
+void StorePose(vtkSkeletonPose* pose, double* output)
+{
+  for (vtkIdType nodeId = 0; nodeId < pose->GetNumberOfTransforms(); nodeId++)
+  {
+    pose->GetTransform(nodeId, output + POSE_STRIDE * nodeId);
+    pose->GetScale(nodeId, output + POSE_STRIDE * nodeId + 7);
+  }
+}
+
+void StoreNodeTransform(const vtkSkeletonAnimation* animation, vtkIdType nodeId, double time, double* output)
+{
+  animation->SampleNodeTransform(nodeId, time, output, output + 3, output + 7);
+}
+
+// Each thread reuses its pose over the times of its range
+struct PoseSampler
+{
+  const vtkSkeletonAnimation* Animation;
+  double* Poses;
+  vtkSMPThreadLocalObject<vtkSkeletonPose> Pose;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkSkeletonPose* pose = this->Pose.Local();
+    for (vtkIdType timeId = begin; timeId < end; timeId++)
+    {
+      this->Animation->ComputeInterpolatedPose(GetSampleTime(timeId), pose);
+      StorePose(pose, this->Poses + POSE_STRIDE * NB_NODES * timeId);
+    }
+  }
+};
+
+// One task per (time, node) pair
+struct NodeSampler
+{
+  const vtkSkeletonAnimation* Animation;
+  double* Transforms;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType sampleId = begin; sampleId < end; sampleId++)
+    {
+      StoreNodeTransform(this->Animation, sampleId % NB_NODES, GetSampleTime(sampleId / NB_NODES),
+        this->Transforms + POSE_STRIDE * sampleId);
+    }
+  }
+};
+
+bool Compare(const std::vector<double>& serial, const std::vector<double>& parallel, const char* name)
+{
+  for (size_t i = 0; i < serial.size(); i++)
+  {
+    if (std::abs(serial[i] - parallel[i]) > 1e-12)
+    {
+      vtkIdType sampleId = static_cast<vtkIdType>(i / POSE_STRIDE);
+      std::cerr << name << ": node " << sampleId % NB_NODES << " at time "
+                << GetSampleTime(sampleId / NB_NODES) << " differs from the serial run" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main(int, char*[])
+{
+  vtkNew<vtkSkeletonAnimation> animation;
+  BuildClip(animation);
+  if (animation->GetScaleMode() != vtkSkeletonPose::NON_UNIFORM_SCALE)
+  {
+    std::cerr << "Unexpected scale mode " << animation->GetScaleMode() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  size_t nbValues = static_cast<size_t>(POSE_STRIDE * NB_NODES * NB_TIMES);
+
+  // Serial run, with a new pose for each time
+  std::vector<double> serialPoses(nbValues);
+  std::vector<double> serialTransforms(nbValues);
+  for (vtkIdType timeId = 0; timeId < NB_TIMES; timeId++)
+  {
+    vtkNew<vtkSkeletonPose> pose;
+    animation->ComputeInterpolatedPose(GetSampleTime(timeId), pose);
+    StorePose(pose, &serialPoses[POSE_STRIDE * NB_NODES * timeId]);
+
+    for (vtkIdType nodeId = 0; nodeId < NB_NODES; nodeId++)
+    {
+      StoreNodeTransform(animation, nodeId, GetSampleTime(timeId),
+        &serialTransforms[POSE_STRIDE * (NB_NODES * timeId + nodeId)]);
+    }
+  }
+
+  // Small grains so that the threads interleave
+  std::vector<double> parallelPoses(nbValues);
+  PoseSampler poseSampler;
+  poseSampler.Animation = animation;
+  poseSampler.Poses = parallelPoses.data();
+  vtkSMPTools::For(0, NB_TIMES, 4, poseSampler);
+
+  std::vector<double> parallelTransforms(nbValues);
+  NodeSampler nodeSampler;
+  nodeSampler.Animation = animation;
+  nodeSampler.Transforms = parallelTransforms.data();
+  vtkSMPTools::For(0, NB_NODES * NB_TIMES, 64, nodeSampler);
+
+  if (!Compare(serialPoses, parallelPoses, "ComputeInterpolatedPose") ||
+    !Compare(serialTransforms, parallelTransforms, "SampleNodeTransform"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
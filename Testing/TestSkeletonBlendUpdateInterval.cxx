@@ -0,0 +1,144 @@
+// Plays a blend of two layers on a vtkSkeletonPolyDataMapper with a pose
+// update interval, and checks that the pose is only evaluated every interval
+// animation steps, and right away when a layer is modified. No rendering.
+
+#include "vtkSkeletonAnimation.h"
+#include "vtkSkeletonAnimationBlend.h"
+#include "vtkSkeletonHierarchy.h"
+#include "vtkSkeletonPolyDataMapper.h"
+#include "vtkSkeletonPose.h"
+
+#include <vtkIdTypeArray.h>
+#include <vtkNew.h>
+#include <vtkStringArray.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace
+{
+const vtkIdType NB_BONES = 8;
+const int UPDATE_INTERVAL = 4;
+const int NB_STEPS = 12;
+
+// Chain of bones, each one the child of the previous one
+void BuildSkeleton(vtkSkeletonHierarchy* hierarchy, vtkSkeletonPose* bindPose)
+{
+  bindPose->SetNumberOfTransforms(NB_BONES);
+  for (vtkIdType boneId = 0; boneId < NB_BONES; boneId++)
+  {
+    double position[3] = { 0.0, 1.0, 0.0 };
+    double orientation[4] = { 1.0, 0.0, 0.0, 0.0 };
+
+    hierarchy->GetNodeNames()->InsertNextValue("Bone" + std::to_string(boneId));
+    hierarchy->GetNodeTypes()->InsertNextTuple1(boneId);
+    hierarchy->InsertNextParentId(static_cast<int>(boneId) - 1);
+    hierarchy->GetNodeTransforms()->InsertNextTransform(position, orientation);
+    bindPose->SetTransform(boneId, position, orientation);
+  }
+}
+
+// Every bone turns around x over the clip
+void BuildClip(vtkSkeletonAnimation* animation)
+{
+  const vtkIdType nbKeys = 5;
+  const double duration = 40.0;
+
+  animation->SetAnimationName("Turn");
+  animation->SetDuration(duration);
+  animation->SetTickPerSecond(30.0);
+  animation->SetNumberOfNodes(NB_BONES);
+
+  for (vtkIdType boneId = 0; boneId < NB_BONES; boneId++)
+  {
+    animation->AllocateNodeKeys(boneId, vtkSkeletonAnimation::ROTATION, nbKeys);
+    for (vtkIdType keyId = 0; keyId < nbKeys; keyId++)
+    {
+      double angle = 0.1 * keyId;
+      double key[4] = { std::cos(angle), std::sin(angle), 0.0, 0.0 };
+      animation->SetNodeKey(boneId, vtkSkeletonAnimation::ROTATION, keyId, key,
+        duration * keyId / (nbKeys - 1));
+    }
+  }
+}
+
+// Prepare and evaluate the pose like vtkSkeletonAnimationUpdater does.
+// Returns whether the pose was evaluated.
+bool UpdatePose(vtkSkeletonPolyDataMapper* mapper)
+{
+  if (!mapper->PrepareSkinningPose())
+  {
+    return false;
+  }
+  mapper->EvaluateSkinningPose();
+  return true;
+}
+}
+
+int main(int, char*[])
+{
+  vtkNew<vtkSkeletonHierarchy> hierarchy;
+  vtkNew<vtkSkeletonPose> bindPose;
+  BuildSkeleton(hierarchy, bindPose);
+
+  vtkNew<vtkSkeletonAnimation> animation;
+  BuildClip(animation);
+
+  vtkNew<vtkSkeletonAnimationBlend> blend;
+  blend->AddLayer(animation, 1.0, vtkSkeletonAnimationBlend::BLEND);
+  blend->AddLayer(animation, 0.5, vtkSkeletonAnimationBlend::ADDITIVE);
+  blend->SetLayerTime(1, 10.0);
+
+  vtkNew<vtkSkeletonPolyDataMapper> mapper;
+  mapper->SetSkeletonHierarchy(hierarchy);
+  mapper->SetSkeletonBindPose(bindPose);
+  mapper->SetAnimationBlend(blend);
+  mapper->SetPoseUpdateInterval(UPDATE_INTERVAL);
+
+  // The first step evaluates the pose, then one step of each interval
+  int nbEvaluations = 0;
+  for (int step = 0; step < NB_STEPS; step++)
+  {
+    if (step > 0)
+    {
+      blend->AdvanceTime(1.0 / 30.0);
+    }
+    if (UpdatePose(mapper))
+    {
+      nbEvaluations++;
+    }
+
+    // Same animation step: nothing to evaluate
+    if (UpdatePose(mapper))
+    {
+      std::cerr << "Pose evaluated twice at step " << step << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  int expectedEvaluations = 1 + (NB_STEPS - 1) / UPDATE_INTERVAL;
+  if (nbEvaluations != expectedEvaluations)
+  {
+    std::cerr << nbEvaluations << " pose evaluations in " << NB_STEPS << " steps, "
+              << expectedEvaluations << " expected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (mapper->GetSkinningPalette().size() != static_cast<size_t>(12 * NB_BONES))
+  {
+    std::cerr << "Unexpected skinning palette size " << mapper->GetSkinningPalette().size() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A layer setup change is not an animation step: evaluated right away
+  blend->SetLayerWeight(1, 0.25);
+  if (!UpdatePose(mapper))
+  {
+    std::cerr << "Pose not evaluated after a layer weight change" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+// Runs vtkSkinnedMeshOptimizer on a 100x100 grid whose triangles and points
+// are shuffled, and checks that the average cache miss ratio decreases and
+// that the point data follow the points.
+
+#include "vtkSkinnedMeshOptimizer.h"
+
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+const vtkIdType GRID_SIZE = 100;
+
+// Grid of GRID_SIZE x GRID_SIZE points with 2 triangles per quad, in random
+// order. The "Coordinates" point data array duplicates the point coordinates.
+void BuildShuffledGrid(vtkPolyData* output)
+{
+  std::mt19937 generator(42);
+
+  vtkIdType nbPoints = GRID_SIZE * GRID_SIZE;
+  std::vector<vtkIdType> pointIds(nbPoints);
+  std::iota(pointIds.begin(), pointIds.end(), 0);
+  std::shuffle(pointIds.begin(), pointIds.end(), generator);
+
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(nbPoints);
+  vtkNew<vtkFloatArray> coordinates;
+  coordinates->SetName("Coordinates");
+  coordinates->SetNumberOfComponents(3);
+  coordinates->SetNumberOfTuples(nbPoints);
+  for (vtkIdType j = 0; j < GRID_SIZE; j++)
+  {
+    for (vtkIdType i = 0; i < GRID_SIZE; i++)
+    {
+      double point[3] = { static_cast<double>(i), static_cast<double>(j), 0.0 };
+      points->SetPoint(pointIds[j * GRID_SIZE + i], point);
+      coordinates->SetTuple(pointIds[j * GRID_SIZE + i], point);
+    }
+  }
+
+  std::vector<vtkIdType> triangles;
+  for (vtkIdType j = 0; j < GRID_SIZE - 1; j++)
+  {
+    for (vtkIdType i = 0; i < GRID_SIZE - 1; i++)
+    {
+      vtkIdType p00 = pointIds[j * GRID_SIZE + i];
+      vtkIdType p10 = pointIds[j * GRID_SIZE + i + 1];
+      vtkIdType p01 = pointIds[(j + 1) * GRID_SIZE + i];
+      vtkIdType p11 = pointIds[(j + 1) * GRID_SIZE + i + 1];
+      triangles.insert(triangles.end(), { p00, p10, p11, p00, p11, p01 });
+    }
+  }
+
+  std::vector<vtkIdType> order(triangles.size() / 3);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), generator);
+
+  vtkNew<vtkCellArray> polys;
+  for (size_t t = 0; t < order.size(); t++)
+  {
+    polys->InsertNextCell(3, &triangles[3 * order[t]]);
+  }
+
+  output->SetPoints(points);
+  output->SetPolys(polys);
+  output->GetPointData()->AddArray(coordinates);
+}
+}
+
+int main(int, char*[])
+{
+  vtkNew<vtkPolyData> grid;
+  BuildShuffledGrid(grid);
+
+  vtkNew<vtkSkinnedMeshOptimizer> optimizer;
+  optimizer->SetInputData(grid);
+  optimizer->SetCacheSize(32);
+  optimizer->Update();
+  vtkPolyData* output = optimizer->GetOutput();
+
+  std::cout << "ACMR of the shuffled grid: " << optimizer->GetInputACMR()
+            << ", after optimization: " << optimizer->GetOutputACMR() << std::endl;
+
+  if (output->GetNumberOfPoints() != grid->GetNumberOfPoints() ||
+    output->GetNumberOfPolys() != grid->GetNumberOfPolys())
+  {
+    std::cerr << "The number of points or triangles changed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A shuffled mesh misses almost every vertex (ACMR close to 3), an optimized
+  // regular grid is under 1
+  if (optimizer->GetInputACMR() < 2.5 || optimizer->GetOutputACMR() > 1.0)
+  {
+    std::cerr << "Unexpected cache miss ratios" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkDataArray* coordinates = output->GetPointData()->GetArray("Coordinates");
+  if (coordinates == nullptr)
+  {
+    std::cerr << "Point data array lost" << std::endl;
+    return EXIT_FAILURE;
+  }
+  for (vtkIdType pointId = 0; pointId < output->GetNumberOfPoints(); pointId++)
+  {
+    double point[3];
+    double coordinate[3];
+    output->GetPoint(pointId, point);
+    coordinates->GetTuple(pointId, coordinate);
+    if (point[0] != coordinate[0] || point[1] != coordinate[1] || point[2] != coordinate[2])
+    {
+      std::cerr << "Point data not permuted with point " << pointId << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -19,9 +19,13 @@ int main(int argc, char** argv)
   // Inform the rendering manager about option change
   QObject::connect(&mainWindow, SIGNAL(dataListRowChanged(int)), &renderManager, SLOT(onDataListRowChanged(int)));
   QObject::connect(&mainWindow, SIGNAL(animationListRowChanged(int)), &renderManager, SLOT(onAnimationListRowChanged(int)));
+  QObject::connect(&mainWindow, SIGNAL(skeletonToggled(bool)), &renderManager, SLOT(setSkeletonVisible(bool)));
+  QObject::connect(&mainWindow, SIGNAL(frameProfilerToggled(bool)), &renderManager, SLOT(setFrameProfilerVisible(bool)));
+  QObject::connect(&mainWindow, SIGNAL(frameTraceRecordingToggled(bool)), &renderManager, SLOT(setFrameTraceRecording(bool)));
 
   // Menu File actions
   QObject::connect(&mainWindow, SIGNAL(modelFileOpened(QString)), &renderManager, SLOT(open3DModel(QString)));
+  QObject::connect(&mainWindow, SIGNAL(frameTraceExported(QString)), &renderManager, SLOT(exportFrameTrace(QString)));
 
   QString title = "Skinned Mesh Viewer";
   mainWindow.setWindowTitle(title);
@@ -30,6 +30,14 @@ smvMainWindow::smvMainWindow(QWidget *parent, Qt::WindowFlags flags) :QMainWindo
      this, SIGNAL(animationListRowChanged(int)));
 
    QObject::connect(this->ui->actionOpen3DModel, SIGNAL(triggered()), this, SLOT(onActionOpen3DModel()));
+   QObject::connect(this->ui->actionExportFrameTrace, SIGNAL(triggered()), this, SLOT(onActionExportFrameTrace()));
+
+   QObject::connect(this->ui->actionShowSkeleton, SIGNAL(toggled(bool)),
+     this, SIGNAL(skeletonToggled(bool)));
+   QObject::connect(this->ui->actionShowFrameProfiler, SIGNAL(toggled(bool)),
+     this, SIGNAL(frameProfilerToggled(bool)));
+   QObject::connect(this->ui->actionRecordFrameTrace, SIGNAL(toggled(bool)),
+     this, SIGNAL(frameTraceRecordingToggled(bool)));
 }
 
 /** Destructor */
@@ -59,6 +67,21 @@ void smvMainWindow::onActionOpen3DModel()
   emit modelFileOpened(modelFilename);
 }
 
+/** Export the recorded frame timings.
+  SLot called on menu File action : Export frame trace */
+void smvMainWindow::onActionExportFrameTrace()
+{
+  QString traceFilename = QFileDialog::getSaveFileName(this,
+    tr("Export frame trace ..."), "", tr("Chrome trace (*.json)"));
+
+  if (traceFilename.isEmpty())
+  {
+    return;
+  }
+
+  emit frameTraceExported(traceFilename);
+}
+
 /** Fill Mesh information tab from polydata
   Slot called on smvRenderManager::skinnedMeshLoaded(vtkPolyData*) */
 void smvMainWindow::setMeshInformation(vtkPolyData* polydata)
@@ -151,10 +174,10 @@ void smvMainWindow::setSkeletonAnimationInformation(vtkSkeletonAnimationStack* a
 
   for (int k = 0; k < animStack->GetNumberOfAnimations(); k++)
   {
-    vtkSkeletonAnimation* anim = animStack->GetAnimation(k);
-    vtkStdString animName = anim->GetAnimationName();
-    double tickPerSecond = anim->GetTickPerSecond();
-    int duration = anim->GetDuration();
+    // Directory information only: does not decode the clip
+    vtkStdString animName = animStack->GetAnimationName(k);
+    double tickPerSecond = animStack->GetAnimationTickPerSecond(k);
+    int duration = animStack->GetAnimationDuration(k);
 
 
     std::stringstream animLabel;
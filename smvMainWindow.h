@@ -27,6 +27,7 @@ public:
 
 public slots:
   void onActionOpen3DModel();
+  void onActionExportFrameTrace();
 
   void setMeshInformation(vtkPolyData*);
   void setHierarchyInformation(vtkSkeletonHierarchy*);
@@ -35,6 +36,11 @@ public slots:
 
 signals:
   void modelFileOpened(QString);
+  void frameTraceExported(QString);
+
+  void skeletonToggled(bool);
+  void frameProfilerToggled(bool);
+  void frameTraceRecordingToggled(bool);
 
   void dataListRowChanged(int);
   void animationListRowChanged(int);
@@ -1,15 +1,16 @@
 #include "smvRenderManager.h"
 
 #include "vtkAssimpImporter.h"
-#include "vtkSkeletonAnimation.h"
 #include "vtkSkeletonAnimationStack.h"
 #include "vtkSkeletonHierarchy.h"
-#include "vtkSkeletonPose.h"
+#include "vtkSkeletonOverlay.h"
 #include "vtkSkeletonPolyDataMapper.h"
+#include "vtkSkinningProfiler.h"
 
 #include <QVTKOpenGLWidget.h>
 #include <vtkActor.h>
 #include <vtkAxesActor.h>
+#include <vtkCoordinate.h>
 #include <vtkCallbackCommand.h>
 #include <vtkGenericOpenGLRenderWindow.h>
 #include <vtkLight.h>
@@ -21,6 +22,8 @@
 #include <vtkRendererCollection.h>
 #include <vtkRenderWindowInteractor.h>
 #include <vtkScalarsToColors.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
 
 /** Constructor */
 smvRenderManager::smvRenderManager(QObject *parent)
@@ -29,12 +32,43 @@ smvRenderManager::smvRenderManager(QObject *parent)
   this->RenderWidget = nullptr;
   this->OrientationAxesWidget = nullptr;
   this->Mesh = nullptr;
+  this->Mapper = nullptr;
+
+  // Bones of the displayed pose (hidden by default)
+  this->SkeletonOverlay = vtkSkeletonOverlay::New();
+  this->SkeletonOverlay->GetActor()->VisibilityOff();
+
+  this->SkeletonOverlayCallback = vtkCallbackCommand::New();
+  this->SkeletonOverlayCallback->SetCallback(smvRenderManager::UpdateSkeletonOverlayCallback);
+  this->SkeletonOverlayCallback->SetClientData(this);
+
+  this->Profiler = vtkSkinningProfiler::New();
+
+  this->ProfilerOverlay = vtkTextActor::New();
+  this->ProfilerOverlay->GetTextProperty()->SetFontFamilyToCourier();
+  this->ProfilerOverlay->GetTextProperty()->SetFontSize(14);
+  this->ProfilerOverlay->GetTextProperty()->SetColor(1.0, 1.0, 0.8);
+  this->ProfilerOverlay->GetTextProperty()->SetVerticalJustificationToTop();
+  this->ProfilerOverlay->GetPositionCoordinate()->SetCoordinateSystemToNormalizedViewport();
+  this->ProfilerOverlay->SetPosition(0.01, 0.99);
+  this->ProfilerOverlay->VisibilityOff();
+
+  this->ProfilerOverlayCallback = vtkCallbackCommand::New();
+  this->ProfilerOverlayCallback->SetCallback(smvRenderManager::UpdateProfilerOverlayCallback);
+  this->ProfilerOverlayCallback->SetClientData(this);
 }
 
 /** Destructor */
 smvRenderManager::~smvRenderManager()
 {
   this->OrientationAxesWidget->Delete();
+
+  this->SkeletonOverlayCallback->Delete();
+  this->SkeletonOverlay->Delete();
+
+  this->ProfilerOverlayCallback->Delete();
+  this->ProfilerOverlay->Delete();
+  this->Profiler->Delete();
 }
 
 /** Set QVTKOpenGLWidget used for rendering and initialize the scene resources. */
@@ -64,6 +98,13 @@ void smvRenderManager::setRenderWidget(QVTKOpenGLWidget* widget)
   //light->SetSpecularColor(0, 0, 1);
   renderer->AddLight(light);
 
+  // Frame profiler overlay (hidden by default)
+  renderer->AddActor2D(this->ProfilerOverlay);
+
+  // Skeleton overlay, brought up to date with the pose before each render
+  renderer->AddActor(this->SkeletonOverlay->GetActor());
+  renderer->AddObserver(vtkCommand::StartEvent, this->SkeletonOverlayCallback);
+
   vtkNew<vtkGenericOpenGLRenderWindow> renderWindow;
   renderWindow->AddRenderer(renderer);
   this->RenderWidget->SetRenderWindow(renderWindow);
@@ -77,6 +118,10 @@ void smvRenderManager::setRenderWidget(QVTKOpenGLWidget* widget)
   this->OrientationAxesWidget->SetViewport(0.0, 0.0, 0.2, 0.2);
   this->OrientationAxesWidget->SetEnabled(1);
   this->OrientationAxesWidget->InteractiveOn();
+
+  // Refresh the profiler overlay before the animation callbacks render
+  this->RenderWidget->GetInteractor()->AddObserver(vtkCommand::TimerEvent,
+    this->ProfilerOverlayCallback, 1.0);
 }
 
 /** Load skinned mesh from file.
@@ -103,6 +148,7 @@ void smvRenderManager::open3DModel(QString fileName)
 
   // Create resources;
   this->Mapper = assimpImporter->GetMapper();
+  this->Mapper->SetProfiler(this->Profiler);
   this->Mapper->SetInputData(this->Mesh);
   this->Mapper->SetSkeletonHierarchy(assimpImporter->GetOutputSkeletonHierarchy());
   this->Mapper->SetSkeletonBindPose(assimpImporter->GetOutputSkeletonBindPose());
@@ -111,24 +157,12 @@ void smvRenderManager::open3DModel(QString fileName)
   vtkActor* actor = assimpImporter->GetActor();
   actor->SetMapper(this->Mapper);
 
-  // Create resources
-  vtkNew<vtkPolyData> skeletonPolyData;
-  if (assimpImporter->GetOutputSkeletonAnimationStack()->GetNumberOfAnimations() > 0)
-  {
-    vtkNew<vtkSkeletonPose> pose;
-    assimpImporter->GetOutputSkeletonAnimationStack()->GetAnimation(0)->ComputeInterpolatedPose(0, pose);
-    vtkSkeletonPose::ExtractBones(pose, assimpImporter->GetOutputSkeletonHierarchy(), skeletonPolyData);
-  }
-  vtkNew<vtkPolyDataMapper> skeletonMapper;
-  vtkNew<vtkActor> skeletonActor;
-  skeletonMapper->SetInputData(skeletonPolyData);
-
-  skeletonActor->SetMapper(skeletonMapper);
+  // Bones follow the pose evaluated by the mapper
+  this->SkeletonOverlay->SetMapper(this->Mapper);
 
   vtkRenderer* renderer =
     this->RenderWidget->GetRenderWindow()->GetRenderers()->GetFirstRenderer();
   renderer->AddActor(actor);
-  //renderer->AddActor(skeletonActor);
 
   // Reset view
   renderer->ResetCamera();
@@ -169,3 +203,67 @@ void smvRenderManager::onAnimationListRowChanged(int index)
   this->Mapper->SetAlpha(0);
   this->Mapper->SetCurrentAnimationIndex(index);
 }
+
+/** Show/Hide the bones of the animated skeleton */
+void smvRenderManager::setSkeletonVisible(bool visible)
+{
+  this->SkeletonOverlay->GetActor()->SetVisibility(visible);
+
+  if (this->RenderWidget != nullptr)
+  {
+    this->RenderWidget->GetRenderWindow()->Render();
+  }
+}
+
+/** Show/Hide per-stage timings on top of the render view */
+void smvRenderManager::setFrameProfilerVisible(bool visible)
+{
+  this->ProfilerOverlay->SetVisibility(visible);
+
+  if (this->RenderWidget != nullptr)
+  {
+    this->RenderWidget->GetRenderWindow()->Render();
+  }
+}
+
+/** Start/Stop recording trace events */
+void smvRenderManager::setFrameTraceRecording(bool record)
+{
+  this->Profiler->SetTraceEnabled(record);
+}
+
+/** Write recorded trace events in the Chrome trace-event JSON format */
+void smvRenderManager::exportFrameTrace(QString fileName)
+{
+  this->Profiler->WriteChromeTrace(fileName.toStdString().c_str());
+}
+
+/** Update overlay text from the profiler rolling statistics.
+  Called on interactor timer events */
+void smvRenderManager::UpdateProfilerOverlayCallback(vtkObject* vtkNotUsed(caller),
+  unsigned long vtkNotUsed(eventId), void* clientData, void* vtkNotUsed(callData))
+{
+  smvRenderManager* manager = static_cast<smvRenderManager*>(clientData);
+
+  if (!manager->ProfilerOverlay->GetVisibility())
+  {
+    return;
+  }
+
+  manager->ProfilerOverlay->SetInput(manager->Profiler->GetSummary().c_str());
+}
+
+/** Update skeleton overlay points from the mapper global pose.
+  Called on renderer start events */
+void smvRenderManager::UpdateSkeletonOverlayCallback(vtkObject* vtkNotUsed(caller),
+  unsigned long vtkNotUsed(eventId), void* clientData, void* vtkNotUsed(callData))
+{
+  smvRenderManager* manager = static_cast<smvRenderManager*>(clientData);
+
+  if (!manager->SkeletonOverlay->GetActor()->GetVisibility())
+  {
+    return;
+  }
+
+  manager->SkeletonOverlay->Update();
+}
@@ -4,13 +4,18 @@
 #include <QObject>
 
 class QVTKOpenGLWidget;
+class vtkCallbackCommand;
+class vtkObject;
 class vtkOrientationMarkerWidget;
 class vtkPolyData;
+class vtkTextActor;
 
 class vtkSkeletonAnimationStack;
 class vtkSkeletonHierarchy;
+class vtkSkeletonOverlay;
 class vtkSkeletonPolyDataMapper;
 class vtkSkeletonPose;
+class vtkSkinningProfiler;
 
 class smvRenderManager : public QObject
 {
@@ -28,6 +33,11 @@ public slots:
   void onDataListRowChanged(int);
   void onAnimationListRowChanged(int);
 
+  void setSkeletonVisible(bool);
+  void setFrameProfilerVisible(bool);
+  void setFrameTraceRecording(bool);
+  void exportFrameTrace(QString fileName);
+
 signals:
   void skinnedMeshLoaded(vtkPolyData*);
   void hierarchyLoaded(vtkSkeletonHierarchy*);
@@ -35,11 +45,21 @@ signals:
   void skeletonAnimationLoaded(vtkSkeletonAnimationStack*);
 
 private:
+  static void UpdateProfilerOverlayCallback(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+  static void UpdateSkeletonOverlayCallback(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+
   QVTKOpenGLWidget* RenderWidget;
   vtkOrientationMarkerWidget* OrientationAxesWidget;
 
   vtkPolyData* Mesh;
   vtkSkeletonPolyDataMapper* Mapper;
+
+  vtkSkeletonOverlay* SkeletonOverlay;
+  vtkCallbackCommand* SkeletonOverlayCallback;
+
+  vtkSkinningProfiler* Profiler;
+  vtkTextActor* ProfilerOverlay;
+  vtkCallbackCommand* ProfilerOverlayCallback;
 };
 
 #endif //__smvRenderManager_h
@@ -1,17 +1,22 @@
 #include "vtkAssimpImporter.h"
 
 #include "vtkSkeletonAnimation.h"
+#include "vtkSkeletonAnimationLoader.h"
+#include "vtkSkeletonAnimationRegistry.h"
 #include "vtkSkeletonAnimationStack.h"
-#include "vtkSkeletonAnimationKeys.h"
 #include "vtkSkeletonHierarchy.h"
+#include "vtkSkeletonMorphTargets.h"
 #include "vtkSkeletonPose.h"
+#include "vtkSkinnedMeshOptimizer.h"
 
 #include <vtkCellArray.h>
 #include <vtkDoubleArray.h>
 #include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
 #include <vtkIntArray.h>
 #include <vtkMatrix3x3.h>
 #include <vtkMatrix4x4.h>
+#include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
@@ -35,6 +40,7 @@
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
+#include <algorithm>
 #include <set>
 #include <sstream>
 
@@ -48,11 +54,445 @@ bool GreaterThanBonePair(BoneWeightPair a, BoneWeightPair b)
   return a.second > b.second;
 }
 
+//----------------------------------------------------------------------------
+// Append a transform to a pose, raising the pose scale mode if the scale needs it
+void InsertNextScaledTransform(vtkSkeletonPose* pose, double position[3],
+  double orientation[4], const double scale[3])
+{
+  pose->InsertNextTransform(position, orientation);
+  pose->SetScaleMode(std::max(pose->GetScaleMode(), vtkSkeletonPose::ClassifyScale(scale)));
+  if (pose->GetScaleMode() != vtkSkeletonPose::NO_SCALE)
+  {
+    pose->SetScale(pose->GetNumberOfTransforms() - 1, scale);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Squared length under which a morph target delta is not stored
+const float MORPH_DELTA_EPSILON = 1e-12f;
+
+// Mesh ids by mesh name and by name of the nodes referencing them, used to
+// resolve the mesh names of morph animation channels.
+void CollectMeshNames(const aiScene* pScene, const aiNode* pNode,
+  std::multimap<vtkStdString, unsigned int>& meshNames)
+{
+  if (pNode == pScene->mRootNode)
+  {
+    for (unsigned int meshId = 0; meshId < pScene->mNumMeshes; meshId++)
+    {
+      meshNames.insert(std::make_pair(vtkStdString(pScene->mMeshes[meshId]->mName.C_Str()), meshId));
+    }
+  }
+
+  for (unsigned int i = 0; i < pNode->mNumMeshes; i++)
+  {
+    meshNames.insert(std::make_pair(vtkStdString(pNode->mName.C_Str()), pNode->mMeshes[i]));
+  }
+
+  for (unsigned int i = 0; i < pNode->mNumChildren; i++)
+  {
+    CollectMeshNames(pScene, pNode->mChildren[i], meshNames);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Decoder of the clips of an Assimp scene. The takes are converted to compact
+// key arrays at initialization, then the whole scene is released.
+class vtkAssimpAnimationLoader : public vtkSkeletonAnimationLoader
+{
+public:
+  static vtkAssimpAnimationLoader* New();
+  vtkTypeMacro(vtkAssimpAnimationLoader, vtkSkeletonAnimationLoader)
+
+  /** Take ownership of the scene, released once its takes are converted. */
+  void Initialize(aiScene* pScene, const char* fileName, bool shareAnimations,
+    vtkSkeletonHierarchy* hierarchy, vtkIdType nbBones, const std::vector<vtkIdType>& meshFirstMorphTarget);
+
+  vtkIdType GetNumberOfAnimations() const;
+  vtkStdString GetAnimationName(vtkIdType index) const;
+  double GetAnimationDuration(vtkIdType index) const;
+  double GetAnimationTickPerSecond(vtkIdType index) const;
+  vtkIdType GetAnimationNumberOfKeys(vtkIdType index) const;
+
+  vtkSkeletonAnimation* LoadAnimation(vtkIdType index) override;
+  bool IsAnimationInUse(vtkIdType index, vtkSkeletonAnimation* animation) override;
+  void ReleaseAnimation(vtkIdType index, vtkSkeletonAnimation* animation) override;
+
+protected:
+  vtkAssimpAnimationLoader();
+  ~vtkAssimpAnimationLoader() override;
+
+  // Keys of a node channel (bone id) or of a morph weight channel (target id)
+  struct ClipChannel
+  {
+    vtkIdType Id;
+    int Type; // vtkSkeletonAnimation::ChannelTypes
+    std::vector<float> Times;
+    std::vector<float> Values;
+  };
+
+  // Take of the scene, without the channels of the nodes that are not bones
+  struct ClipSource
+  {
+    vtkStdString Name;
+    double Duration;
+    double TickPerSecond;
+    std::vector<ClipChannel> Channels;
+  };
+
+  void ConvertAnimation(const aiAnimation* pAnimation, vtkSkeletonHierarchy* hierarchy, ClipSource& clip);
+  void ConvertMorphChannels(const aiAnimation* pAnimation, const std::multimap<vtkStdString, unsigned int>& meshNames,
+    const std::vector<unsigned int>& meshNbMorphTargets, ClipSource& clip);
+
+private:
+  vtkAssimpAnimationLoader(const vtkAssimpAnimationLoader&) = delete;
+  void operator=(const vtkAssimpAnimationLoader&) = delete;
+
+  std::vector<ClipSource> Clips;
+  vtkStdString SourceKey;
+  bool ShareAnimations;
+  vtkIdType NumberOfBones;
+  vtkSkeletonPose* RestPose; // Local bone transforms of the unanimated bones
+  std::vector<vtkIdType> MeshFirstMorphTarget;
+};
+
+vtkStandardNewMacro(vtkAssimpAnimationLoader)
+
+//----------------------------------------------------------------------------
+vtkAssimpAnimationLoader::vtkAssimpAnimationLoader()
+{
+  this->ShareAnimations = true;
+  this->NumberOfBones = 0;
+  this->RestPose = vtkSkeletonPose::New();
+}
+
+//----------------------------------------------------------------------------
+vtkAssimpAnimationLoader::~vtkAssimpAnimationLoader()
+{
+  this->RestPose->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkAssimpAnimationLoader::Initialize(aiScene* pScene, const char* fileName, bool shareAnimations,
+  vtkSkeletonHierarchy* hierarchy, vtkIdType nbBones, const std::vector<vtkIdType>& meshFirstMorphTarget)
+{
+  this->SourceKey = vtkSkeletonAnimationRegistry::GetSourceKey(fileName);
+  this->ShareAnimations = shareAnimations;
+  this->NumberOfBones = nbBones;
+  this->MeshFirstMorphTarget = meshFirstMorphTarget;
+
+  // Bones without keys in a clip keep the local transform of their node
+  vtkSkeletonPose* nodeTransforms = hierarchy->GetNodeTransforms();
+  this->RestPose->SetScaleMode(nodeTransforms->GetScaleMode());
+  this->RestPose->SetNumberOfTransforms(nbBones);
+  double identity[7];
+  vtkSkeletonPose::GetIdentityTransform(identity);
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+  {
+    this->RestPose->SetTransform(boneId, identity);
+  }
+  for (vtkIdType nodeId = 0; nodeId < hierarchy->GetNodeTypes()->GetNumberOfTuples(); nodeId++)
+  {
+    vtkIdType boneId = hierarchy->GetNodeBoneId(nodeId);
+    if (boneId < 0 || boneId >= nbBones)
+    {
+      continue;
+    }
+
+    double transform[7];
+    double scale[3];
+    nodeTransforms->GetTransform(nodeId, transform);
+    nodeTransforms->GetScale(nodeId, scale);
+    this->RestPose->SetTransform(boneId, transform);
+    this->RestPose->SetScale(boneId, scale);
+  }
+
+  // What morph channels need from the meshes
+  std::multimap<vtkStdString, unsigned int> meshNames;
+  std::vector<unsigned int> meshNbMorphTargets;
+  CollectMeshNames(pScene, pScene->mRootNode, meshNames);
+  for (unsigned int meshId = 0; meshId < pScene->mNumMeshes; meshId++)
+  {
+    meshNbMorphTargets.push_back(pScene->mMeshes[meshId]->mNumAnimMeshes);
+  }
+
+  // Convert the takes, releasing each one right away
+  this->Clips.resize(pScene->mNumAnimations);
+  for (unsigned int animId = 0; animId < pScene->mNumAnimations; animId++)
+  {
+    ClipSource& clip = this->Clips[animId];
+    clip.Name = pScene->mAnimations[animId]->mName.C_Str();
+    if (clip.Name.empty())
+    {
+      clip.Name = "Animation" + std::to_string(animId);
+    }
+    this->ConvertAnimation(pScene->mAnimations[animId], hierarchy, clip);
+    this->ConvertMorphChannels(pScene->mAnimations[animId], meshNames, meshNbMorphTargets, clip);
+
+    delete pScene->mAnimations[animId];
+    pScene->mAnimations[animId] = nullptr;
+  }
+
+  delete pScene;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkAssimpAnimationLoader::GetNumberOfAnimations() const
+{
+  return static_cast<vtkIdType>(this->Clips.size());
+}
+
+//----------------------------------------------------------------------------
+vtkStdString vtkAssimpAnimationLoader::GetAnimationName(vtkIdType index) const
+{
+  return this->Clips[index].Name;
+}
+
+//----------------------------------------------------------------------------
+double vtkAssimpAnimationLoader::GetAnimationDuration(vtkIdType index) const
+{
+  return this->Clips[index].Duration;
+}
+
+//----------------------------------------------------------------------------
+double vtkAssimpAnimationLoader::GetAnimationTickPerSecond(vtkIdType index) const
+{
+  return this->Clips[index].TickPerSecond;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkAssimpAnimationLoader::GetAnimationNumberOfKeys(vtkIdType index) const
+{
+  vtkIdType nbKeys = 0;
+  for (const ClipChannel& channel : this->Clips[index].Channels)
+  {
+    nbKeys += static_cast<vtkIdType>(channel.Times.size());
+  }
+  return nbKeys;
+}
+
+//----------------------------------------------------------------------------
+vtkSkeletonAnimation* vtkAssimpAnimationLoader::LoadAnimation(vtkIdType index)
+{
+  if (index < 0 || index >= this->GetNumberOfAnimations())
+  {
+    return nullptr;
+  }
+
+  vtkSkeletonAnimationRegistry* registry = vtkSkeletonAnimationRegistry::GetInstance();
+  const ClipSource& clip = this->Clips[index];
+
+  // Reuse the clip if it was already decoded from the same file
+  if (this->ShareAnimations)
+  {
+    vtkSkeletonAnimation* sharedAnimation = registry->GetAnimation(this->SourceKey, index, clip.Name);
+    if (sharedAnimation != nullptr)
+    {
+      sharedAnimation->Register(this);
+      return sharedAnimation;
+    }
+  }
+
+  vtkSkeletonAnimation* animation = vtkSkeletonAnimation::New();
+  animation->SetTickPerSecond(clip.TickPerSecond);
+  animation->SetAnimationName(clip.Name);
+  animation->SetDuration(clip.Duration);
+  animation->SetNumberOfNodes(this->NumberOfBones);
+  animation->SetRestPose(this->RestPose);
+
+  // Size the flat key buffers of the clip at once
+  vtkIdType nbValues = 0;
+  for (const ClipChannel& channel : clip.Channels)
+  {
+    nbValues += static_cast<vtkIdType>(channel.Values.size());
+  }
+  animation->ReserveKeys(this->GetAnimationNumberOfKeys(index), nbValues);
+
+  for (const ClipChannel& channel : clip.Channels)
+  {
+    vtkIdType nbKeys = static_cast<vtkIdType>(channel.Times.size());
+    if (channel.Type == vtkSkeletonAnimation::WEIGHT)
+    {
+      vtkIdType weightChannel = animation->InsertNextMorphWeightChannel(channel.Id, nbKeys);
+      for (vtkIdType keyId = 0; keyId < nbKeys; keyId++)
+      {
+        animation->SetMorphWeightKey(weightChannel, keyId, channel.Values[keyId], channel.Times[keyId]);
+      }
+      continue;
+    }
+
+    int nbComponents = vtkSkeletonAnimation::GetNumberOfComponents(channel.Type);
+    animation->AllocateNodeKeys(channel.Id, channel.Type, nbKeys);
+    for (vtkIdType keyId = 0; keyId < nbKeys; keyId++)
+    {
+      double value[4];
+      std::copy(channel.Values.begin() + keyId * nbComponents,
+        channel.Values.begin() + (keyId + 1) * nbComponents, value);
+      animation->SetNodeKey(channel.Id, channel.Type, keyId, value, channel.Times[keyId]);
+    }
+  }
+
+  animation->ClassifyScale();
+
+  if (this->ShareAnimations)
+  {
+    registry->RegisterAnimation(this->SourceKey, index, animation);
+  }
+
+  return animation;
+}
+
+//----------------------------------------------------------------------------
+bool vtkAssimpAnimationLoader::IsAnimationInUse(vtkIdType index, vtkSkeletonAnimation* animation)
+{
+  // The registry holds a reference to the shared clips
+  int nbOwners = 1;
+  if (this->ShareAnimations && vtkSkeletonAnimationRegistry::GetInstance()->GetAnimation(
+    this->SourceKey, index, animation->GetAnimationName()) == animation)
+  {
+    nbOwners++;
+  }
+  return animation->GetReferenceCount() > nbOwners;
+}
+
+//----------------------------------------------------------------------------
+void vtkAssimpAnimationLoader::ReleaseAnimation(vtkIdType index, vtkSkeletonAnimation* animation)
+{
+  // Only referenced by the stack and the registry: drop it from the registry
+  // too, so that the memory is actually released
+  if (this->ShareAnimations && !this->IsAnimationInUse(index, animation))
+  {
+    vtkSkeletonAnimationRegistry::GetInstance()->RemoveAnimation(
+      this->SourceKey, index, animation->GetAnimationName());
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkAssimpAnimationLoader::ConvertAnimation(const aiAnimation* pAnimation,
+  vtkSkeletonHierarchy* hierarchy, ClipSource& clip)
+{
+  clip.Duration = pAnimation->mDuration;
+  clip.TickPerSecond = pAnimation->mTicksPerSecond;
+
+  // Iterate over the animated nodes
+  for (unsigned int channelId = 0; channelId < pAnimation->mNumChannels; channelId++)
+  {
+    const aiNodeAnim* pNodeAnim = pAnimation->mChannels[channelId];
+    vtkIdType nodeId = hierarchy->GetNodeNames()->LookupValue(vtkStdString(pNodeAnim->mNodeName.C_Str()));
+    vtkIdType boneId = nodeId >= 0 ? hierarchy->GetNodeBoneId(nodeId) : -1;
+    if (boneId < 0 || boneId >= this->NumberOfBones)
+    {
+      continue;
+    }
+
+    // Position keys
+    ClipChannel position;
+    position.Id = boneId;
+    position.Type = vtkSkeletonAnimation::POSITION;
+    for (unsigned int keyId = 0; keyId < pNodeAnim->mNumPositionKeys; keyId++)
+    {
+      const aiVectorKey& key = pNodeAnim->mPositionKeys[keyId];
+      position.Times.push_back(static_cast<float>(key.mTime));
+      position.Values.insert(position.Values.end(), { key.mValue.x, key.mValue.y, key.mValue.z });
+    }
+
+    // Rotation keys, wxyz
+    ClipChannel rotation;
+    rotation.Id = boneId;
+    rotation.Type = vtkSkeletonAnimation::ROTATION;
+    for (unsigned int keyId = 0; keyId < pNodeAnim->mNumRotationKeys; keyId++)
+    {
+      const aiQuatKey& key = pNodeAnim->mRotationKeys[keyId];
+      rotation.Times.push_back(static_cast<float>(key.mTime));
+      rotation.Values.insert(rotation.Values.end(), { key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z });
+    }
+
+    // Scaling keys
+    ClipChannel scaling;
+    scaling.Id = boneId;
+    scaling.Type = vtkSkeletonAnimation::SCALING;
+    for (unsigned int keyId = 0; keyId < pNodeAnim->mNumScalingKeys; keyId++)
+    {
+      const aiVectorKey& key = pNodeAnim->mScalingKeys[keyId];
+      scaling.Times.push_back(static_cast<float>(key.mTime));
+      scaling.Values.insert(scaling.Values.end(), { key.mValue.x, key.mValue.y, key.mValue.z });
+    }
+
+    clip.Channels.push_back(std::move(position));
+    clip.Channels.push_back(std::move(rotation));
+    clip.Channels.push_back(std::move(scaling));
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkAssimpAnimationLoader::ConvertMorphChannels(const aiAnimation* pAnimation,
+  const std::multimap<vtkStdString, unsigned int>& meshNames,
+  const std::vector<unsigned int>& meshNbMorphTargets, ClipSource& clip)
+{
+  for (unsigned int channelId = 0; channelId < pAnimation->mNumMorphMeshChannels; channelId++)
+  {
+    const aiMeshMorphAnim* pMorphAnim = pAnimation->mMorphMeshChannels[channelId];
+
+    // Meshes animated by the channel
+    std::set<unsigned int> meshIds;
+    auto range = meshNames.equal_range(vtkStdString(pMorphAnim->mName.C_Str()));
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      meshIds.insert(it->second);
+    }
+
+    // Targets (anim mesh indices) referenced by the keys
+    std::set<unsigned int> animMeshIds;
+    for (unsigned int keyId = 0; keyId < pMorphAnim->mNumKeys; keyId++)
+    {
+      const aiMeshMorphKey& key = pMorphAnim->mKeys[keyId];
+      animMeshIds.insert(key.mValues, key.mValues + key.mNumValuesAndWeights);
+    }
+
+    for (auto meshIt = meshIds.begin(); meshIt != meshIds.end(); ++meshIt)
+    {
+      for (auto animMeshIt = animMeshIds.begin(); animMeshIt != animMeshIds.end(); ++animMeshIt)
+      {
+        if (*animMeshIt >= meshNbMorphTargets[*meshIt])
+        {
+          continue;
+        }
+
+        // One weight key per channel key, zero when the target is not listed
+        ClipChannel weights;
+        weights.Id = this->MeshFirstMorphTarget[*meshIt] + *animMeshIt;
+        weights.Type = vtkSkeletonAnimation::WEIGHT;
+        for (unsigned int keyId = 0; keyId < pMorphAnim->mNumKeys; keyId++)
+        {
+          const aiMeshMorphKey& key = pMorphAnim->mKeys[keyId];
+          double weight = 0.0;
+          for (unsigned int v = 0; v < key.mNumValuesAndWeights; v++)
+          {
+            if (key.mValues[v] == *animMeshIt)
+            {
+              weight = key.mWeights[v];
+            }
+          }
+          weights.Times.push_back(static_cast<float>(key.mTime));
+          weights.Values.push_back(static_cast<float>(weight));
+        }
+        clip.Channels.push_back(std::move(weights));
+      }
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 vtkAssimpImporter::vtkAssimpImporter()
 {
   this->Output = nullptr;
   this->FileName = nullptr;
+  this->ShareAnimations = true;
+  this->CollapseStaticNodes = true;
+  this->OptimizeMesh = false;
+  this->LazyAnimations = true;
+  this->AnimationMemoryBudget = 0;
+  this->MorphTargets = nullptr;
 
   this->Actor = vtkActor::New();
   this->Mapper = vtkSkeletonPolyDataMapper::New();
@@ -65,6 +505,10 @@ vtkAssimpImporter::~vtkAssimpImporter()
   this->SkeletonAnimationStack->Delete();
   this->SkeletonHierarchy->Delete();
   this->SkeletonBindPose->Delete();
+  if (this->MorphTargets != nullptr)
+  {
+    this->MorphTargets->Delete();
+  }
 
   this->BoneMap.clear();
  
@@ -81,6 +525,12 @@ void vtkAssimpImporter::Update()
   this->SkeletonAnimationStack = vtkSkeletonAnimationStack::New();
   this->SkeletonHierarchy = vtkSkeletonHierarchy::New();
   this->SkeletonBindPose = vtkSkeletonPose::New();
+  if (this->MorphTargets != nullptr)
+  {
+    this->MorphTargets->Delete();
+  }
+  this->MorphTargets = vtkSkeletonMorphTargets::New();
+  this->MeshFirstMorphTarget.clear();
 
   Assimp::Importer importer;
   const aiScene* pScene = importer.ReadFile(this->FileName,
@@ -93,9 +543,48 @@ void vtkAssimpImporter::Update()
   }
 
   this->ProcessMesh(pScene);
+  if (this->OptimizeMesh)
+  {
+    // Track the point renumbering to update the morph targets
+    bool hasMorphTargets = this->MorphTargets->GetNumberOfTargets() > 0;
+    if (hasMorphTargets)
+    {
+      vtkNew<vtkIdTypeArray> pointIds;
+      pointIds->SetName("MorphPointIds");
+      pointIds->SetNumberOfTuples(this->Output->GetNumberOfPoints());
+      for (vtkIdType i = 0; i < this->Output->GetNumberOfPoints(); i++)
+      {
+        pointIds->SetValue(i, i);
+      }
+      this->Output->GetPointData()->AddArray(pointIds);
+    }
+
+    vtkNew<vtkSkinnedMeshOptimizer> optimizer;
+    optimizer->SetInputData(this->Output);
+    optimizer->Update();
+    this->Output->ShallowCopy(optimizer->GetOutput());
+
+    if (hasMorphTargets)
+    {
+      vtkIdTypeArray* pointIds =
+        vtkIdTypeArray::SafeDownCast(this->Output->GetPointData()->GetArray("MorphPointIds"));
+      std::vector<vtkIdType> newPointIds(pointIds->GetNumberOfTuples());
+      for (vtkIdType i = 0; i < pointIds->GetNumberOfTuples(); i++)
+      {
+        newPointIds[pointIds->GetValue(i)] = i;
+      }
+      this->MorphTargets->RenumberPoints(newPointIds);
+      this->Output->GetPointData()->RemoveArray("MorphPointIds");
+    }
+  }
   this->ProcessHierarchyRecursive(pScene->mRootNode);
-  this->ProcessAnimations(pScene);
+  this->SkeletonHierarchy->SetCollapseStaticNodes(this->CollapseStaticNodes);
   this->ProcessMaterials(pScene);
+
+  // The clips are decoded from the scene, kept alive by the animation loader
+  this->ProcessAnimations(importer.GetOrphanedScene());
+
+  this->Mapper->SetMorphTargets(this->MorphTargets);
 }
 
 //----------------------------------------------------------------------------
@@ -134,6 +623,12 @@ vtkSkeletonPose* vtkAssimpImporter::GetOutputSkeletonBindPose()
   return this->SkeletonBindPose;
 }
 
+//----------------------------------------------------------------------------
+vtkSkeletonMorphTargets* vtkAssimpImporter::GetOutputMorphTargets()
+{
+  return this->MorphTargets;
+}
+
 //----------------------------------------------------------------------------
 void vtkAssimpImporter::ProcessMesh(const aiScene* pScene)
 {
@@ -209,11 +704,12 @@ void vtkAssimpImporter::ProcessMesh(const aiScene* pScene)
       vtkQuaternion<double> orientation;
       orientation.Set(RotationQ.w, RotationQ.x, RotationQ.y, RotationQ.z);
 
-      double position[3] = { PositionV.x * ScalingV.x, PositionV.y * ScalingV.y, PositionV.z * ScalingV.z };
+      double position[3] = { PositionV.x, PositionV.y, PositionV.z };
+      double scale[3] = { ScalingV.x, ScalingV.y, ScalingV.z };
 
       if (this->BoneMap.find(boneName) == this->BoneMap.end())
       {
-        this->SkeletonBindPose->InsertNextTransform(position, orientation.GetData());
+        InsertNextScaledTransform(this->SkeletonBindPose, position, orientation.GetData(), scale);
         this->BoneMap[boneName] = this->SkeletonBindPose->GetNumberOfTransforms() - 1;
         uniqueBoneCount++;
       }
@@ -293,6 +789,48 @@ void vtkAssimpImporter::ProcessMesh(const aiScene* pScene)
       weights->InsertNextTuple4(weight[0], weight[1], weight[2], weight[3]);
     }
 
+    // Morph targets, stored as sparse deltas from the base mesh
+    this->MeshFirstMorphTarget.push_back(this->MorphTargets->GetNumberOfTargets());
+    for (unsigned int animMeshId = 0; animMeshId < pMesh->mNumAnimMeshes; animMeshId++)
+    {
+      const aiAnimMesh* pAnimMesh = pMesh->mAnimMeshes[animMeshId];
+
+      vtkStdString targetName = pAnimMesh->mName.C_Str();
+      if (targetName.empty())
+      {
+        targetName = vtkStdString(pMesh->mName.C_Str()) + "_" + std::to_string(animMeshId);
+      }
+      vtkIdType targetId = this->MorphTargets->InsertNextTarget(targetName);
+
+      if (!pAnimMesh->HasPositions())
+      {
+        continue;
+      }
+
+      // Anim meshes store absolute positions and normals
+      bool hasNormals = pMesh->HasNormals() && pAnimMesh->HasNormals();
+      unsigned int targetVertexCount = std::min(vertexCount, pAnimMesh->mNumVertices);
+      for (unsigned int i = 0; i < targetVertexCount; i++)
+      {
+        aiVector3D delta = pAnimMesh->mVertices[i] - pMesh->mVertices[i];
+        aiVector3D normalDelta;
+        if (hasNormals)
+        {
+          normalDelta = pAnimMesh->mNormals[i] - pMesh->mNormals[i];
+        }
+
+        if (delta.SquareLength() < MORPH_DELTA_EPSILON && normalDelta.SquareLength() < MORPH_DELTA_EPSILON)
+        {
+          continue;
+        }
+
+        double position[3] = { delta.x, delta.y, delta.z };
+        double normal[3] = { normalDelta.x, normalDelta.y, normalDelta.z };
+        this->MorphTargets->InsertNextTargetDelta(targetId, VERTEX_ID_OFFSET + i,
+          position, hasNormals ? normal : nullptr);
+      }
+    }
+
     // Cells
     vtkIdType polygonCount = pMesh->mNumFaces;
     for (int i = 0; i < polygonCount; i++)
@@ -364,9 +902,10 @@ void vtkAssimpImporter::ProcessHierarchyRecursive(const aiNode* pNode)
   vtkQuaternion<double> orientation;
   orientation.Set(RotationQ.w, RotationQ.x, RotationQ.y, RotationQ.z);
 
-  double position[3] = { PositionV.x * ScalingV.x, PositionV.y * ScalingV.y, PositionV.z * ScalingV.z };
+  double position[3] = { PositionV.x, PositionV.y, PositionV.z };
+  double scale[3] = { ScalingV.x, ScalingV.y, ScalingV.z };
 
-  this->SkeletonHierarchy->GetNodeTransforms()->InsertNextTransform(position, orientation.GetData());
+  InsertNextScaledTransform(this->SkeletonHierarchy->GetNodeTransforms(), position, orientation.GetData(), scale);
 
   // Recursively process children
   for (unsigned int i = 0; i < pNode->mNumChildren; i++)
@@ -376,71 +915,41 @@ void vtkAssimpImporter::ProcessHierarchyRecursive(const aiNode* pNode)
 }
 
 //----------------------------------------------------------------------------
-void vtkAssimpImporter::ProcessAnimations(const aiScene* pScene)
+void vtkAssimpImporter::ProcessAnimations(aiScene* pScene)
 {
   if (pScene == nullptr || pScene->mNumAnimations == 0)
   {
+    delete pScene;
     return;
   }
 
-  for (unsigned int animId = 0; animId < pScene->mNumAnimations; animId++)
-  {
-    // Animation
-    const aiAnimation* pAnimation = pScene->mAnimations[animId];
-
-    vtkNew<vtkSkeletonAnimation> animation;
-    animation->SetTickPerSecond(pAnimation->mTicksPerSecond);
-    animation->SetAnimationName(pAnimation->mName.C_Str());
-    animation->SetDuration(pAnimation->mDuration);
-    animation->SetNumberOfNodes(this->SkeletonBindPose->GetNumberOfTransforms());
+  vtkNew<vtkAssimpAnimationLoader> loader;
+  loader->Initialize(pScene, this->FileName, this->ShareAnimations,
+    this->SkeletonHierarchy, this->SkeletonBindPose->GetNumberOfTransforms(), this->MeshFirstMorphTarget);
 
-    this->SkeletonAnimationStack->InsertNextAnimation(animation);
+  this->SkeletonAnimationStack->SetMemoryBudget(this->AnimationMemoryBudget);
 
-    // Iterate over the animated nodes
-    for (unsigned int channelId = 0; channelId < pAnimation->mNumChannels; channelId++)
+  for (vtkIdType animId = 0; animId < loader->GetNumberOfAnimations(); animId++)
+  {
+    if (this->LazyAnimations)
     {
-      vtkStdString currentNodeName = vtkStdString(pAnimation->mChannels[channelId]->mNodeName.C_Str());
-      vtkIdType nodeId = this->SkeletonHierarchy->GetNodeNames()->LookupValue(currentNodeName);
-      vtkIdType boneId = this->SkeletonHierarchy->GetNodeTypes()->GetTuple1(nodeId);
-
-      if (boneId == -1)
-      {
-        continue;
-      }
-
-      aiNodeAnim* pNodeAnim = pAnimation->mChannels[channelId];
-
-      // Position keys
-      vtkSkeletonAnimationKeys* positionKeys = animation->GetNodePositionKeys(boneId);
-      positionKeys->SetNumberOfKeys(pNodeAnim->mNumPositionKeys);
-      for (vtkIdType pKeyId = 0; pKeyId < pNodeAnim->mNumPositionKeys; pKeyId++)
-      {
-        const aiVector3D& PositionV = pNodeAnim->mPositionKeys[pKeyId].mValue;
-        double position[3] = { PositionV.x, PositionV.y, PositionV.z };
-        positionKeys->SetKey(pKeyId, position, pNodeAnim->mPositionKeys[pKeyId].mTime);
-      }
-
-      // Rotation keys
-      vtkSkeletonAnimationKeys* rotationKeys = animation->GetNodeRotationKeys(boneId);
-      rotationKeys->SetNumberOfKeys(pNodeAnim->mNumRotationKeys);
-      for (vtkIdType rKeyId = 0; rKeyId < pNodeAnim->mNumRotationKeys; rKeyId++)
-      {
-        const aiQuaternion& RotationQ = pNodeAnim->mRotationKeys[rKeyId].mValue;
-        double rotation[4] = { RotationQ.w, RotationQ.x, RotationQ.y, RotationQ.z };
-        rotationKeys->SetKey(rKeyId, rotation, pNodeAnim->mRotationKeys[rKeyId].mTime);
-      }
-
-      // Scaling keys
-      vtkSkeletonAnimationKeys* scalingKeys = animation->GetNodeScalingKeys(boneId);
-      scalingKeys->SetNumberOfKeys(pNodeAnim->mNumScalingKeys);
-      for (vtkIdType sKeyId = 0; sKeyId < pNodeAnim->mNumScalingKeys; sKeyId++)
-      {
-        const aiVector3D& ScalingV = pNodeAnim->mScalingKeys[sKeyId].mValue;
-        double scaling[3] = { ScalingV.x, ScalingV.y, ScalingV.z };
-        scalingKeys->SetKey(sKeyId, scaling, pNodeAnim->mScalingKeys[sKeyId].mTime);
-      }
+      // Directory entry only, decoded on first use
+      this->SkeletonAnimationStack->InsertNextAnimationEntry(loader->GetAnimationName(animId),
+        loader->GetAnimationDuration(animId), loader->GetAnimationTickPerSecond(animId),
+        loader->GetAnimationNumberOfKeys(animId));
+    }
+    else
+    {
+      vtkSkeletonAnimation* animation = loader->LoadAnimation(animId);
+      this->SkeletonAnimationStack->InsertNextAnimation(animation);
+      animation->Delete();
     }
   }
+
+  if (this->LazyAnimations)
+  {
+    this->SkeletonAnimationStack->SetLoader(loader);
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -21,14 +21,16 @@
 #ifndef __vtkAssimpImporter_h
 #define __vtkAssimpImporter_h
 
+#include "vtkSkinningModule.h" // For export macro
 #include "vtkObject.h"
-
-#include <assimp/scene.h>
+#include "vtkStdString.h" // For BoneMap
 
 #include <map>
+#include <vector>
 
 class vtkSkeletonAnimationStack;
 class vtkSkeletonHierarchy;
+class vtkSkeletonMorphTargets;
 class vtkSkeletonPose;
 
 class vtkSkeletonPolyDataMapper;
@@ -39,8 +41,9 @@ class vtkPolyData;
 class vtkStringArray;
 
 struct aiNode;
+struct aiScene;
 
-class VTK_EXPORT vtkAssimpImporter : public vtkObject  // WARNING : Consider use of vtkImporter
+class VTKSKINNING_EXPORT vtkAssimpImporter : public vtkObject  // WARNING : Consider use of vtkImporter
 {
 public:
   static vtkAssimpImporter *New();
@@ -49,6 +52,39 @@ public:
   vtkSetStringMacro(FileName);
   vtkGetStringMacro(FileName);
 
+  /** Share animation clips through vtkSkeletonAnimationRegistry (default true).
+  * Clips already decoded from the same file are reused by reference. */
+  vtkSetMacro(ShareAnimations, bool);
+  vtkGetMacro(ShareAnimations, bool);
+  vtkBooleanMacro(ShareAnimations, bool);
+
+  /** Fold static non-bone nodes of the output hierarchy into the global pose
+  * evaluation of their bone descendants (default true).
+  * See vtkSkeletonHierarchy::SetCollapseStaticNodes(). */
+  vtkSetMacro(CollapseStaticNodes, bool);
+  vtkGetMacro(CollapseStaticNodes, bool);
+  vtkBooleanMacro(CollapseStaticNodes, bool);
+
+  /** Reorder the output triangles and points for vertex cache reuse and fetch
+  * locality (default false). See vtkSkinnedMeshOptimizer. */
+  vtkSetMacro(OptimizeMesh, bool);
+  vtkGetMacro(OptimizeMesh, bool);
+  vtkBooleanMacro(OptimizeMesh, bool);
+
+  /** Decode the animation clips on first use instead of at import (default
+  * true). The stack then only holds the clip directory (names, durations,
+  * key counts) until a clip is requested, and its loader a compact copy of
+  * the keys of the file (the Assimp scene is released). See
+  * vtkSkeletonAnimationStack. */
+  vtkSetMacro(LazyAnimations, bool);
+  vtkGetMacro(LazyAnimations, bool);
+  vtkBooleanMacro(LazyAnimations, bool);
+
+  /** Memory budget of the decoded clips of the output stack, in KiB (default
+  * 0, unlimited). Least recently used clips are unloaded beyond it. */
+  vtkSetMacro(AnimationMemoryBudget, unsigned long);
+  vtkGetMacro(AnimationMemoryBudget, unsigned long);
+
   void Update();
 
   vtkPolyData* GetOutput();
@@ -56,6 +92,9 @@ public:
   vtkSkeletonHierarchy* GetOutputSkeletonHierarchy();
   vtkSkeletonPose* GetOutputSkeletonBindPose();
 
+  /** Morph targets (blend shapes) of the output mesh. Empty if the file has none. */
+  vtkSkeletonMorphTargets* GetOutputMorphTargets();
+
   vtkActor* GetActor();
   vtkSkeletonPolyDataMapper* GetMapper();
 
@@ -69,16 +108,23 @@ private:
 
   void ProcessMesh(const aiScene* pScene);
   void ProcessHierarchyRecursive(const aiNode* pNode);
-  void ProcessAnimations(const aiScene* pScene);
+  void ProcessAnimations(aiScene* pScene);
   void ProcessMaterials(const aiScene* pScene);
 
   char* FileName;
+  bool ShareAnimations;
+  bool CollapseStaticNodes;
+  bool OptimizeMesh;
+  bool LazyAnimations;
+  unsigned long AnimationMemoryBudget;
   vtkPolyData* Output;
   vtkSkeletonAnimationStack* SkeletonAnimationStack;
   vtkSkeletonHierarchy* SkeletonHierarchy;
   vtkSkeletonPose* SkeletonBindPose;
+  vtkSkeletonMorphTargets* MorphTargets;
 
   std::map<vtkStdString, int> BoneMap;
+  std::vector<vtkIdType> MeshFirstMorphTarget; // Index of the first morph target of each mesh
 
   vtkSkeletonPolyDataMapper* Mapper;
   vtkActor* Actor;
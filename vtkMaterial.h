@@ -21,10 +21,11 @@ PURPOSE.  See the above copyright notice for more information.
 #ifndef vtkMaterial_h
 #define vtkMaterial_h
 
+#include "vtkSkinningModule.h" // For export macro
 #include <vtkObject.h>
 #include <vtkStdString.h>
 
-class vtkMaterial : public vtkObject
+class VTKSKINNING_EXPORT vtkMaterial : public vtkObject
 {
 public:
   static vtkMaterial* New();
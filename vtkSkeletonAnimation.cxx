@@ -1,146 +1,607 @@
 #include "vtkSkeletonAnimation.h"
 
 #include "vtkSkeletonPose.h"
-#include "vtkSkeletonAnimationKeys.h"
 
-#include <vtkFloatArray.h>
 #include <vtkObjectFactory.h> // For New macro
 #include <vtkQuaternion.h>
 
+#include <algorithm>
+
+namespace
+{
+// Index of the last key at or before time, clamped to the keys range
+vtkIdType FindKey(const float* times, vtkIdType nbKeys, double time)
+{
+  const float* next = std::upper_bound(times, times + nbKeys, static_cast<float>(time));
+  return std::max(static_cast<vtkIdType>(next - times) - 1, vtkIdType(0));
+}
+
+// Interpolation factor between keyId and keyId + 1 in [0, 1], 0 past the last key
+double GetKeyAlpha(const float* times, vtkIdType nbKeys, vtkIdType keyId, double time)
+{
+  if (keyId + 1 >= nbKeys || times[keyId + 1] <= times[keyId])
+  {
+    return 0.0;
+  }
+  double alpha = (time - times[keyId]) / (times[keyId + 1] - times[keyId]);
+  return std::min(std::max(alpha, 0.0), 1.0);
+}
+}
+
 //-----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSkeletonAnimation)
 
 //-----------------------------------------------------------------------------
 vtkSkeletonAnimation::vtkSkeletonAnimation()
 {
+  this->TickPerSecond = 0.0;
+  this->Duration = 0.0;
+  this->Immutable = false;
+  this->ScaleMode = vtkSkeletonPose::NON_UNIFORM_SCALE;
+  this->RestPose = nullptr;
 }
 
 //-----------------------------------------------------------------------------
 vtkSkeletonAnimation::~vtkSkeletonAnimation()
 {
+  this->Immutable = false;
   this->Clear();
+  if (this->RestPose != nullptr)
+  {
+    this->RestPose->Delete();
+  }
+}
+
+void vtkSkeletonAnimation::SetImmutable()
+{
+  if (this->Immutable)
+  {
+    return;
+  }
+  this->ClassifyScale();
+
+  // The keys are final, release the growth slack of the buffers
+  this->KeyTimes.shrink_to_fit();
+  this->KeyValues.shrink_to_fit();
+
+  this->Immutable = true;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimation::ClassifyScale()
+{
+  // Unanimated channels take their value in the rest pose
+  int scaleMode = this->RestPose != nullptr ? this->RestPose->GetScaleMode() : vtkSkeletonPose::NO_SCALE;
+  for (vtkIdType k = 0; k < this->GetNumberOfNodes() && scaleMode != vtkSkeletonPose::NON_UNIFORM_SCALE; k++)
+  {
+    const Channel& channel = this->NodeChannels[3 * k + SCALING];
+    const float* values = this->KeyValues.data() + channel.ValueOffset;
+    for (vtkIdType keyId = 0; keyId < channel.NumberOfKeys; keyId++)
+    {
+      double scaling[3] = { values[3 * keyId], values[3 * keyId + 1], values[3 * keyId + 2] };
+      scaleMode = std::max(scaleMode, vtkSkeletonPose::ClassifyScale(scaling));
+    }
+  }
+
+  if (this->ScaleMode != scaleMode)
+  {
+    this->ScaleMode = scaleMode;
+    this->Modified();
+  }
 }
 
 void vtkSkeletonAnimation::Clear()
 {
-  for (int i = 0; i < this->PositionKeys.size(); i++)
+  if (this->Immutable)
   {
-    this->PositionKeys[i]->Delete();
+    vtkErrorMacro(<< "Cannot clear immutable animation " << this->AnimationName);
+    return;
   }
-  this->PositionKeys.clear();
 
-  for (int i = 0; i < this->RotationKeys.size(); i++)
+  // Freeing a clip is freeing its two key buffers
+  std::vector<float>().swap(this->KeyTimes);
+  std::vector<float>().swap(this->KeyValues);
+  std::vector<Channel>().swap(this->NodeChannels);
+  std::vector<unsigned char>().swap(this->NodeAnimated);
+  std::vector<vtkIdType>().swap(this->AnimatedNodes);
+  std::vector<Channel>().swap(this->MorphWeightChannels);
+  this->MorphWeightTargets.clear();
+}
+
+int vtkSkeletonAnimation::GetNumberOfComponents(int channelType)
+{
+  switch (channelType)
   {
-    this->RotationKeys[i]->Delete();
+    case ROTATION:
+      return 4;
+    case WEIGHT:
+      return 1;
+    default:
+      return 3;
   }
-  this->RotationKeys.clear();
+}
 
-  for (int i = 0; i < this->ScalingKeys.size(); i++)
+vtkSkeletonAnimation::Channel vtkSkeletonAnimation::AllocateChannel(int channelType, vtkIdType nbKeys)
+{
+  Channel channel;
+  channel.TimeOffset = static_cast<vtkIdType>(this->KeyTimes.size());
+  channel.ValueOffset = static_cast<vtkIdType>(this->KeyValues.size());
+  channel.NumberOfKeys = nbKeys;
+
+  this->KeyTimes.resize(this->KeyTimes.size() + nbKeys, 0.0f);
+  this->KeyValues.resize(this->KeyValues.size() + nbKeys * GetNumberOfComponents(channelType), 0.0f);
+  return channel;
+}
+
+void vtkSkeletonAnimation::ReserveKeys(vtkIdType nbKeys, vtkIdType nbValues)
+{
+  if (this->Immutable)
   {
-    this->ScalingKeys[i]->Delete();
+    vtkErrorMacro(<< "Cannot modify immutable animation " << this->AnimationName);
+    return;
   }
-  this->ScalingKeys.clear();
+  this->KeyTimes.reserve(nbKeys);
+  this->KeyValues.reserve(nbValues);
 }
 
-// Insert rotation keys for a node
-void vtkSkeletonAnimation::InsertNextPositionKeys(vtkSkeletonAnimationKeys* positionKeys)
+void vtkSkeletonAnimation::SetAnimationName(const vtkStdString& name)
 {
-  positionKeys->Register(this);
-  this->PositionKeys.push_back(positionKeys);
+  if (this->AnimationName == name)
+  {
+    return;
+  }
+  if (this->Immutable)
+  {
+    vtkErrorMacro(<< "Cannot rename immutable animation " << this->AnimationName);
+    return;
+  }
+  this->AnimationName = name;
+  this->Modified();
 }
 
-void vtkSkeletonAnimation::InsertNextRotationKeys(vtkSkeletonAnimationKeys* rotationKeys)
+void vtkSkeletonAnimation::SetTickPerSecond(double tickPerSecond)
 {
-  rotationKeys->Register(this);
-  this->RotationKeys.push_back(rotationKeys);
+  if (this->TickPerSecond == tickPerSecond)
+  {
+    return;
+  }
+  if (this->Immutable)
+  {
+    vtkErrorMacro(<< "Cannot modify immutable animation " << this->AnimationName);
+    return;
+  }
+  this->TickPerSecond = tickPerSecond;
+  this->Modified();
 }
 
-void vtkSkeletonAnimation::InsertNextScalingKeys(vtkSkeletonAnimationKeys* scalingKeys)
+void vtkSkeletonAnimation::SetDuration(double duration)
 {
-  scalingKeys->Register(this);
-  this->ScalingKeys.push_back(scalingKeys);
+  if (this->Duration == duration)
+  {
+    return;
+  }
+  if (this->Immutable)
+  {
+    vtkErrorMacro(<< "Cannot modify immutable animation " << this->AnimationName);
+    return;
+  }
+  this->Duration = duration;
+  this->Modified();
 }
 
 void vtkSkeletonAnimation::SetNumberOfNodes(vtkIdType nbNodes)
 {
-  for (int i = 0; i < nbNodes; i++)
+  if (this->Immutable)
+  {
+    vtkErrorMacro(<< "Cannot modify immutable animation " << this->AnimationName);
+    return;
+  }
+
+  // New nodes have no keys until AllocateNodeKeys()
+  Channel empty;
+  empty.TimeOffset = empty.ValueOffset = empty.NumberOfKeys = 0;
+  this->NodeChannels.resize(3 * nbNodes, empty);
+  this->NodeAnimated.resize(nbNodes, 0);
+  this->AnimatedNodes.erase(std::lower_bound(this->AnimatedNodes.begin(), this->AnimatedNodes.end(), nbNodes),
+    this->AnimatedNodes.end());
+}
+
+void vtkSkeletonAnimation::SetRestPose(vtkSkeletonPose* pose)
+{
+  if (this->RestPose == pose)
+  {
+    return;
+  }
+  if (this->Immutable)
+  {
+    vtkErrorMacro(<< "Cannot modify immutable animation " << this->AnimationName);
+    return;
+  }
+  if (this->RestPose != nullptr)
+  {
+    this->RestPose->Delete();
+  }
+  if (pose != nullptr)
+  {
+    pose->Register(this);
+  }
+  this->RestPose = pose;
+  this->Modified();
+}
+
+void vtkSkeletonAnimation::GetRestTransform(vtkIdType nodeId, double position[3], double orientation[4], double scale[3]) const
+{
+  double transform[7];
+  if (this->RestPose != nullptr && nodeId < this->RestPose->GetNumberOfTransforms())
+  {
+    this->RestPose->GetTransform(nodeId, transform);
+    if (scale != nullptr)
+    {
+      this->RestPose->GetScale(nodeId, scale);
+    }
+  }
+  else
+  {
+    vtkSkeletonPose::GetIdentityTransform(transform);
+    if (scale != nullptr)
+    {
+      scale[0] = scale[1] = scale[2] = 1.0;
+    }
+  }
+  std::copy(transform, transform + 3, position);
+  std::copy(transform + 3, transform + 7, orientation);
+}
+
+bool vtkSkeletonAnimation::IsNodeAnimated(vtkIdType nodeId) const
+{
+  return nodeId >= 0 && nodeId < static_cast<vtkIdType>(this->NodeAnimated.size()) && this->NodeAnimated[nodeId];
+}
+
+vtkIdType vtkSkeletonAnimation::GetNumberOfAnimatedNodes() const
+{
+  return static_cast<vtkIdType>(this->AnimatedNodes.size());
+}
+
+vtkIdType vtkSkeletonAnimation::GetAnimatedNode(vtkIdType index) const
+{
+  return this->AnimatedNodes[index];
+}
+
+void vtkSkeletonAnimation::AllocateNodeKeys(vtkIdType nodeId, int channelType, vtkIdType nbKeys)
+{
+  if (this->Immutable)
+  {
+    vtkErrorMacro(<< "Cannot modify immutable animation " << this->AnimationName);
+    return;
+  }
+  if (nodeId < 0 || nodeId >= this->GetNumberOfNodes() || channelType < POSITION || channelType > SCALING)
+  {
+    vtkErrorMacro(<< "Invalid channel " << channelType << " of node " << nodeId);
+    return;
+  }
+
+  Channel& channel = this->NodeChannels[3 * nodeId + channelType];
+  if (channel.NumberOfKeys != 0)
+  {
+    vtkErrorMacro(<< "Keys of channel " << channelType << " of node " << nodeId << " already allocated");
+    return;
+  }
+  channel = this->AllocateChannel(channelType, nbKeys);
+
+  if (nbKeys > 0 && !this->NodeAnimated[nodeId])
+  {
+    this->NodeAnimated[nodeId] = 1;
+    this->AnimatedNodes.insert(
+      std::lower_bound(this->AnimatedNodes.begin(), this->AnimatedNodes.end(), nodeId), nodeId);
+  }
+}
+
+void vtkSkeletonAnimation::SetNodeKey(vtkIdType nodeId, int channelType, vtkIdType keyId,
+  const double* value, double time)
+{
+  if (this->Immutable)
   {
-    vtkNew<vtkSkeletonAnimationKeys> positionKey;
-    positionKey->SetType(vtkSkeletonAnimationKeys::POSITION);
-    this->InsertNextPositionKeys(positionKey);
+    vtkErrorMacro(<< "Cannot modify immutable animation " << this->AnimationName);
+    return;
+  }
+  if (nodeId < 0 || nodeId >= this->GetNumberOfNodes() || channelType < POSITION || channelType > SCALING)
+  {
+    vtkErrorMacro(<< "Invalid channel " << channelType << " of node " << nodeId);
+    return;
+  }
 
-    vtkNew<vtkSkeletonAnimationKeys> rotationKey;
-    rotationKey->SetType(vtkSkeletonAnimationKeys::ROTATION);
-    this->InsertNextRotationKeys(rotationKey);
+  const Channel& channel = this->NodeChannels[3 * nodeId + channelType];
+  if (keyId < 0 || keyId >= channel.NumberOfKeys)
+  {
+    vtkErrorMacro(<< "Invalid key " << keyId << " of channel " << channelType << " of node " << nodeId);
+    return;
+  }
+  int nbComponents = GetNumberOfComponents(channelType);
 
-    vtkNew<vtkSkeletonAnimationKeys> scalingKey;
-    scalingKey->SetType(vtkSkeletonAnimationKeys::SCALING);
-    this->InsertNextScalingKeys(scalingKey);
+  this->KeyTimes[channel.TimeOffset + keyId] = static_cast<float>(time);
+  float* keyValue = &this->KeyValues[channel.ValueOffset + nbComponents * keyId];
+  for (int i = 0; i < nbComponents; i++)
+  {
+    keyValue[i] = static_cast<float>(value[i]);
   }
 }
 
-vtkSkeletonAnimationKeys* vtkSkeletonAnimation::GetNodePositionKeys(vtkIdType nodeId)
+vtkIdType vtkSkeletonAnimation::GetNodeNumberOfKeys(vtkIdType nodeId, int channelType) const
+{
+  return this->NodeChannels[3 * nodeId + channelType].NumberOfKeys;
+}
+
+const float* vtkSkeletonAnimation::GetNodeKeyTimes(vtkIdType nodeId, int channelType) const
 {
-  return this->PositionKeys[nodeId];
+  return this->KeyTimes.data() + this->NodeChannels[3 * nodeId + channelType].TimeOffset;
+}
+
+const float* vtkSkeletonAnimation::GetNodeKeyValues(vtkIdType nodeId, int channelType) const
+{
+  return this->KeyValues.data() + this->NodeChannels[3 * nodeId + channelType].ValueOffset;
+}
+
+vtkIdType vtkSkeletonAnimation::InsertNextMorphWeightChannel(vtkIdType targetId, vtkIdType nbKeys)
+{
+  if (this->Immutable)
+  {
+    vtkErrorMacro(<< "Cannot modify immutable animation " << this->AnimationName);
+    return -1;
+  }
+  this->MorphWeightTargets.push_back(targetId);
+  this->MorphWeightChannels.push_back(this->AllocateChannel(WEIGHT, nbKeys));
+  return static_cast<vtkIdType>(this->MorphWeightChannels.size()) - 1;
+}
+
+void vtkSkeletonAnimation::SetMorphWeightKey(vtkIdType channelId, vtkIdType keyId, double weight, double time)
+{
+  if (this->Immutable)
+  {
+    vtkErrorMacro(<< "Cannot modify immutable animation " << this->AnimationName);
+    return;
+  }
+  if (channelId < 0 || channelId >= this->GetNumberOfMorphWeightChannels())
+  {
+    vtkErrorMacro(<< "Invalid morph weight channel " << channelId);
+    return;
+  }
+
+  const Channel& channel = this->MorphWeightChannels[channelId];
+  if (keyId < 0 || keyId >= channel.NumberOfKeys)
+  {
+    vtkErrorMacro(<< "Invalid key " << keyId << " of morph weight channel " << channelId);
+    return;
+  }
+  this->KeyTimes[channel.TimeOffset + keyId] = static_cast<float>(time);
+  this->KeyValues[channel.ValueOffset + keyId] = static_cast<float>(weight);
 }
 
-vtkSkeletonAnimationKeys* vtkSkeletonAnimation::GetNodeRotationKeys(vtkIdType nodeId)
+vtkIdType vtkSkeletonAnimation::GetNumberOfMorphWeightChannels() const
 {
-  return this->RotationKeys[nodeId];
+  return static_cast<vtkIdType>(this->MorphWeightChannels.size());
 }
 
-vtkSkeletonAnimationKeys* vtkSkeletonAnimation::GetNodeScalingKeys(vtkIdType nodeId)
+vtkIdType vtkSkeletonAnimation::GetMorphWeightChannelTarget(vtkIdType channelId) const
 {
-  return this->ScalingKeys[nodeId];
+  return this->MorphWeightTargets[channelId];
 }
 
-void vtkSkeletonAnimation::ComputeInterpolatedPose(float const animationTime, vtkSkeletonPose* outputPose)
+vtkIdType vtkSkeletonAnimation::GetMorphWeightChannelNumberOfKeys(vtkIdType channelId) const
 {
-  outputPose->SetNumberOfTransforms(this->RotationKeys.size());
+  return this->MorphWeightChannels[channelId].NumberOfKeys;
+}
 
-  for (int k = 0; k < outputPose->GetNumberOfTransforms(); k++)
+void vtkSkeletonAnimation::ComputeMorphWeights(double animTime, std::vector<double>& weights) const
+{
+  for (size_t c = 0; c < this->MorphWeightChannels.size(); c++)
   {
-    double animTime = fmod(animationTime, this->Duration);
-    vtkIdType pKeyId = this->PositionKeys[k]->GetKeyTimeIndex(animTime);// xyz position
-    vtkIdType rKeyId = this->RotationKeys[k]->GetKeyTimeIndex(animTime);// wxyz quaternion
-    vtkIdType sKeyId = this->ScalingKeys[k]->GetKeyTimeIndex(animTime);  // xyz scaling
+    const Channel& channel = this->MorphWeightChannels[c];
+    if (channel.NumberOfKeys == 0)
+    {
+      continue;
+    }
 
-    double* position = this->PositionKeys[k]->GetData()->GetTuple3(pKeyId);// xyz position
-    double* rotation = this->RotationKeys[k]->GetData()->GetTuple4(rKeyId);// wxyz quaternion
-    double* scaling = this->ScalingKeys[k]->GetData()->GetTuple3(sKeyId);  // xyz scaling
+    vtkIdType targetId = this->MorphWeightTargets[c];
+    if (targetId >= static_cast<vtkIdType>(weights.size()))
+    {
+      weights.resize(targetId + 1, 0.0);
+    }
 
-    double* nextPosition = this->PositionKeys[k]->GetData()->GetTuple3((pKeyId + 1 )% this->PositionKeys[k]->GetData()->GetNumberOfTuples());// xyz position
-    double* nextRotation = this->RotationKeys[k]->GetData()->GetTuple4((rKeyId + 1) % this->RotationKeys[k]->GetData()->GetNumberOfTuples());// wxyz quaternion
-    double* nextScaling = this->ScalingKeys[k]->GetData()->GetTuple3((sKeyId + 1) % this->ScalingKeys[k]->GetData()->GetNumberOfTuples());  // xyz scaling
+    // Linear interpolation, clamped to the first and last keys
+    const float* times = this->KeyTimes.data() + channel.TimeOffset;
+    const float* values = this->KeyValues.data() + channel.ValueOffset;
+    vtkIdType keyId = FindKey(times, channel.NumberOfKeys, animTime);
+    double alpha = GetKeyAlpha(times, channel.NumberOfKeys, keyId, animTime);
+    double weight = values[keyId];
+    if (alpha > 0.0)
+    {
+      weight = (1 - alpha) * weight + alpha * values[keyId + 1];
+    }
+    weights[targetId] = weight;
+  }
+}
 
-    double currentPTime = this->PositionKeys[k]->GetTimeData()->GetTuple1(pKeyId);
-    double nextPTime = this->PositionKeys[k]->GetTimeData()->GetTuple1((pKeyId + 1) % this->PositionKeys[k]->GetData()->GetNumberOfTuples());
-    double alphaP = (animTime - currentPTime) / (nextPTime - currentPTime);
+unsigned long vtkSkeletonAnimation::GetActualMemorySize() const
+{
+  size_t size = this->KeyTimes.capacity() * sizeof(float) +
+    this->KeyValues.capacity() * sizeof(float) +
+    (this->NodeChannels.capacity() + this->MorphWeightChannels.capacity()) * sizeof(Channel) +
+    (this->MorphWeightTargets.capacity() + this->AnimatedNodes.capacity()) * sizeof(vtkIdType) +
+    this->NodeAnimated.capacity();
+  return static_cast<unsigned long>((size + 1023) / 1024);
+}
 
-    double currentRTime = this->RotationKeys[k]->GetTimeData()->GetTuple1(rKeyId);
-    double nextRTime = this->RotationKeys[k]->GetTimeData()->GetTuple1((rKeyId + 1) % this->RotationKeys[k]->GetData()->GetNumberOfTuples());
-    double alphaR = (animTime - currentRTime) / (nextRTime - currentRTime);
+vtkIdType vtkSkeletonAnimation::GetNumberOfKeys() const
+{
+  return static_cast<vtkIdType>(this->KeyTimes.size());
+}
 
-    double currentSTime = this->ScalingKeys[k]->GetTimeData()->GetTuple1(sKeyId);
-    double nextSTime = this->ScalingKeys[k]->GetTimeData()->GetTuple1((sKeyId + 1) % this->ScalingKeys[k]->GetData()->GetNumberOfTuples());
-    double alphaS = (nextSTime - currentSTime) >0?(animTime - currentSTime) / (nextSTime - currentSTime) : 0;
+vtkIdType vtkSkeletonAnimation::GetNumberOfNodes() const
+{
+  return static_cast<vtkIdType>(this->NodeChannels.size() / 3);
+}
 
-    double boneScaling[3] = { 0, 0, 0 };
-    double bonePosition[3] = { 0, 0, 0 };
+void vtkSkeletonAnimation::ComputeInterpolatedPose(float const animationTime, vtkSkeletonPose* outputPose) const
+{
+  outputPose->SetScaleMode(this->ScaleMode);
+  switch (this->ScaleMode)
+  {
+    case vtkSkeletonPose::NO_SCALE:
+      this->InterpolatePose<vtkSkeletonPose::NO_SCALE>(animationTime, outputPose);
+      break;
+    case vtkSkeletonPose::UNIFORM_SCALE:
+      this->InterpolatePose<vtkSkeletonPose::UNIFORM_SCALE>(animationTime, outputPose);
+      break;
+    default:
+      this->InterpolatePose<vtkSkeletonPose::NON_UNIFORM_SCALE>(animationTime, outputPose);
+      break;
+  }
+}
+
+template <int Mode>
+void vtkSkeletonAnimation::InterpolatePose(double animationTime, vtkSkeletonPose* outputPose) const
+{
+  vtkIdType nbNodes = this->GetNumberOfNodes();
+  if (outputPose->GetNumberOfTransforms() != nbNodes)
+  {
+    outputPose->SetNumberOfTransforms(nbNodes);
+  }
+
+  // Times past the end loop, the end itself samples the last keys. The time is
+  // a float: compare it to the float duration
+  double animTime = animationTime;
+  if (this->Duration <= 0.0)
+  {
+    animTime = 0.0;
+  }
+  else if (animationTime > static_cast<float>(this->Duration))
+  {
+    animTime = fmod(animationTime, this->Duration);
+  }
+  double bonePosition[3];
+  double boneOrientation[4];
+  double boneScale[3];
+
+  // The nodes without keys keep their rest transform: only written when the
+  // pose was resized or last evaluated for another clip
+  vtkMTimeType animationMTime = this->MTime.GetMTime();
+  if (outputPose->GetRestTransformsAnimationTime() != animationMTime)
+  {
+    for (vtkIdType k = 0; k < nbNodes; k++)
+    {
+      if (!this->NodeAnimated[k])
+      {
+        this->GetRestTransform(k, bonePosition, boneOrientation, Mode != vtkSkeletonPose::NO_SCALE ? boneScale : nullptr);
+        outputPose->SetTransform(k, bonePosition, boneOrientation);
+        if (Mode != vtkSkeletonPose::NO_SCALE)
+        {
+          outputPose->SetScale(k, boneScale);
+        }
+      }
+    }
+    outputPose->SetRestTransformsAnimationTime(animationMTime);
+  }
+
+  for (size_t i = 0; i < this->AnimatedNodes.size(); i++)
+  {
+    vtkIdType k = this->AnimatedNodes[i];
+    this->SampleNode<Mode>(k, animTime, bonePosition, boneOrientation, boneScale);
+    outputPose->SetTransform(k, bonePosition, boneOrientation);
+    if (Mode != vtkSkeletonPose::NO_SCALE)
+    {
+      outputPose->SetScale(k, boneScale);
+    }
+  }
+}
+
+void vtkSkeletonAnimation::SampleNodeTransform(vtkIdType k, double animTime, double* bonePosition, double* boneOrientation) const
+{
+  this->SampleNode<vtkSkeletonPose::NO_SCALE>(k, animTime, bonePosition, boneOrientation, nullptr);
+}
+
+void vtkSkeletonAnimation::SampleNodeTransform(vtkIdType k, double animTime, double* bonePosition,
+  double* boneOrientation, double* boneScale) const
+{
+  this->SampleNode<vtkSkeletonPose::NON_UNIFORM_SCALE>(k, animTime, bonePosition, boneOrientation, boneScale);
+}
+
+template <int Mode>
+void vtkSkeletonAnimation::SampleNode(vtkIdType k, double animTime, double* bonePosition,
+  double* boneOrientation, double* boneScale) const
+{
+  const Channel* channels = &this->NodeChannels[3 * k];
+  const float* times = this->KeyTimes.data();
+  const float* values = this->KeyValues.data();
+
+  // Channels without keys keep the rest pose value
+  if (channels[POSITION].NumberOfKeys == 0 || channels[ROTATION].NumberOfKeys == 0 ||
+    (Mode != vtkSkeletonPose::NO_SCALE && channels[SCALING].NumberOfKeys == 0))
+  {
+    double restPosition[3];
+    double restOrientation[4];
+    double restScale[3];
+    this->GetRestTransform(k, restPosition, restOrientation, restScale);
+    if (channels[POSITION].NumberOfKeys == 0)
+    {
+      std::copy(restPosition, restPosition + 3, bonePosition);
+    }
+    if (channels[ROTATION].NumberOfKeys == 0)
+    {
+      std::copy(restOrientation, restOrientation + 4, boneOrientation);
+    }
+    if (Mode != vtkSkeletonPose::NO_SCALE && channels[SCALING].NumberOfKeys == 0)
+    {
+      std::copy(restScale, restScale + 3, boneScale);
+    }
+  }
+
+  // xyz position
+  const Channel& positionChannel = channels[POSITION];
+  if (positionChannel.NumberOfKeys > 0)
+  {
+    const float* positionTimes = times + positionChannel.TimeOffset;
+    vtkIdType pKeyId = FindKey(positionTimes, positionChannel.NumberOfKeys, animTime);
+    double alphaP = GetKeyAlpha(positionTimes, positionChannel.NumberOfKeys, pKeyId, animTime);
+    const float* position = values + positionChannel.ValueOffset + 3 * pKeyId;
+    const float* nextPosition = alphaP > 0.0 ? position + 3 : position;
 
     for (int i = 0; i < 3; i++)
     {
       bonePosition[i] = (1 - alphaP) * position[i] + alphaP * nextPosition[i];
-      boneScaling[i] = (1 - alphaS) * scaling[i] + alphaS * nextScaling[i];
-
-      bonePosition[i] *= boneScaling[i];
     }
+  }
+
+  // wxyz quaternion
+  const Channel& rotationChannel = channels[ROTATION];
+  if (rotationChannel.NumberOfKeys > 0)
+  {
+    const float* rotationTimes = times + rotationChannel.TimeOffset;
+    vtkIdType rKeyId = FindKey(rotationTimes, rotationChannel.NumberOfKeys, animTime);
+    double alphaR = GetKeyAlpha(rotationTimes, rotationChannel.NumberOfKeys, rKeyId, animTime);
+    const float* rotation = values + rotationChannel.ValueOffset + 4 * rKeyId;
+    const float* nextRotation = alphaR > 0.0 ? rotation + 4 : rotation;
 
     // Interpolate orientation
     vtkQuaternion<double> orientationQ_1(rotation[0], rotation[1], rotation[2], rotation[3]);
     vtkQuaternion<double> orientationQ_2(nextRotation[0], nextRotation[1], nextRotation[2], nextRotation[3]);
-    vtkQuaternion<double> boneOrientation = orientationQ_1.Slerp(alphaR, orientationQ_2);
+    vtkQuaternion<double> interpolatedOrientation = orientationQ_1.Slerp(alphaR, orientationQ_2);
+    interpolatedOrientation.Get(boneOrientation);
+  }
+
+  // Scaling keys are not even looked up for unscaled rigs
+  const Channel& scalingChannel = channels[SCALING];
+  if (Mode != vtkSkeletonPose::NO_SCALE && scalingChannel.NumberOfKeys > 0)
+  {
+    const float* scalingTimes = times + scalingChannel.TimeOffset;
+    vtkIdType sKeyId = FindKey(scalingTimes, scalingChannel.NumberOfKeys, animTime);
+    double alphaS = GetKeyAlpha(scalingTimes, scalingChannel.NumberOfKeys, sKeyId, animTime);
+    const float* scaling = values + scalingChannel.ValueOffset + 3 * sKeyId;
+    const float* nextScaling = alphaS > 0.0 ? scaling + 3 : scaling;
 
-    outputPose->SetTransform(k, bonePosition, boneOrientation.GetData());
+    for (int i = 0; i < 3; i++)
+    {
+      boneScale[i] = (1 - alphaS) * scaling[i] + alphaS * nextScaling[i];
+    }
   }
 }
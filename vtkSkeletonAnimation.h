@@ -16,51 +16,150 @@ PURPOSE.  See the above copyright notice for more information.
 * @brief   vtkSkeletonAnimation.
 *
 * Class storing skeleton animation keys per bone.
-* The size of each animation keys vector must be equal to the number of bones
+* The number of nodes of the animation must be equal to the number of bones
 * in the skeleton.
+*
+* All the keys of a clip are stored flat, in one buffer of times and one
+* buffer of values. Each channel (position, rotation and scaling of a node,
+* morph target weights) is a range of keys in these buffers. Channels are
+* allocated once with their number of keys (see AllocateNodeKeys()), then
+* filled with SetNodeKey().
+*
+* Clips often animate a subset of the rig. Nodes without keys are not
+* sampled: they keep their local transform in the rest pose (see
+* SetRestPose()), as do the channels without keys of animated nodes.
+*
+* An animation can also hold morph target weight channels (see
+* vtkSkeletonMorphTargets). Only the animated targets have a channel.
+*
+* The sampled poses carry the bone scales only when the scaling keys are not
+* all identity (see ClassifyScale() and vtkSkeletonPose::ScaleModes), so that
+* unscaled rigs skip the scaling keys and the scale composition entirely.
+*
+* Once made immutable (e.g. when registered in vtkSkeletonAnimationRegistry),
+* an animation can be shared by reference between several mappers and must not
+* be modified anymore. Const methods only read the keys into caller storage,
+* so an immutable animation can be sampled from several threads at once.
 */
 
 #ifndef vtkSkeletonAnimation_h
 #define vtkSkeletonAnimation_h
 
+#include "vtkSkinningModule.h" // For export macro
 #include <vtkObject.h>
 #include <vtkStdString.h>
 
 #include <vector>
 
 class vtkSkeletonPose;
-class vtkSkeletonAnimationKeys;
 
-class vtkSkeletonAnimation : public vtkObject
+class VTKSKINNING_EXPORT vtkSkeletonAnimation : public vtkObject
 {
 public:
   static vtkSkeletonAnimation* New();
   vtkTypeMacro(vtkSkeletonAnimation, vtkObject)
 
   /** Access to an interpolated skeleton at time given by (keyframe, value)
-  * The alpha value is supposed to be between [0,1]  */
-  void ComputeInterpolatedPose(float const animationTime, vtkSkeletonPose* outputPose);
+  * The alpha value is supposed to be between [0,1]
+  * Times past the duration loop over the clip, the duration itself samples
+  * the last keys.
+  * Only the animated nodes are sampled. The rest transforms of the others are
+  * written when outputPose is resized or was last filled for another clip
+  * (see vtkSkeletonPose::GetRestTransformsAnimationTime()). */
+  void ComputeInterpolatedPose(float const animationTime, vtkSkeletonPose* outputPose) const;
+
+  /** Interpolated local transform of a single node at the given animation time
+  * (in ticks, expected to be in [0, Duration]).
+  * position is a xyz position, orientation a wxyz quaternion. */
+  void SampleNodeTransform(vtkIdType nodeId, double animationTime, double position[3], double orientation[4]) const;
+
+  /** Same as above, also interpolating the xyz scale of the node. */
+  void SampleNodeTransform(vtkIdType nodeId, double animationTime, double position[3],
+    double orientation[4], double scale[3]) const;
+
+  /** Channel types. Values are xyz for POSITION and SCALING, wxyz for ROTATION. */
+  enum ChannelTypes { POSITION = 0, ROTATION, SCALING, WEIGHT };
+
+  /** Number of values per key of a channel type. */
+  static int GetNumberOfComponents(int channelType);
+
+  vtkIdType GetNumberOfNodes() const;
 
   /** Empty the structure */
   void Clear();
 
-  void InsertNextPositionKeys(vtkSkeletonAnimationKeys* positionKeys);
-  void InsertNextRotationKeys(vtkSkeletonAnimationKeys* rotationKeys);
-  void InsertNextScalingKeys(vtkSkeletonAnimationKeys* scalingKeys);
-
+  /** Set the number of animated nodes. Added nodes have no keys. */
   void SetNumberOfNodes(vtkIdType nbNodes);
-  vtkSkeletonAnimationKeys* GetNodePositionKeys(vtkIdType nodeId);
-  vtkSkeletonAnimationKeys* GetNodeRotationKeys(vtkIdType nodeId);
-  vtkSkeletonAnimationKeys* GetNodeScalingKeys(vtkIdType nodeId);
 
+  /** Optional: reserve the key buffers before allocating the channels.
+  * nbValues is the total number of values, over all keys. */
+  void ReserveKeys(vtkIdType nbKeys, vtkIdType nbValues);
+
+  /** Allocate the keys of the POSITION, ROTATION or SCALING channel of a node.
+  * A channel can only be allocated once. */
+  void AllocateNodeKeys(vtkIdType nodeId, int channelType, vtkIdType nbKeys);
+
+  /** Set a key of an allocated node channel. Keys are expected sorted by time. */
+  void SetNodeKey(vtkIdType nodeId, int channelType, vtkIdType keyId, const double* value, double time);
+
+  /** Nodes with at least one key, in increasing order. */
+  bool IsNodeAnimated(vtkIdType nodeId) const;
+  vtkIdType GetNumberOfAnimatedNodes() const;
+  vtkIdType GetAnimatedNode(vtkIdType index) const;
+
+  /** Local transforms of the nodes in rest pose, used for the nodes and
+  * channels without keys. Identity if not set. May be shared between the
+  * animations of a skeleton. */
+  void SetRestPose(vtkSkeletonPose* pose);
+  vtkGetMacro(RestPose, vtkSkeletonPose*);
+
+  /** Rest pose local transform of a node. scale can be null. */
+  void GetRestTransform(vtkIdType nodeId, double position[3], double orientation[4], double scale[3]) const;
+
+  vtkIdType GetNodeNumberOfKeys(vtkIdType nodeId, int channelType) const;
+  /** Key times of a node channel, GetNodeNumberOfKeys() values. */
+  const float* GetNodeKeyTimes(vtkIdType nodeId, int channelType) const;
+  /** Key values of a node channel, GetNumberOfComponents() values per key. */
+  const float* GetNodeKeyValues(vtkIdType nodeId, int channelType) const;
+
+  /** Add a channel of nbKeys weight keys for a morph target, return its index. */
+  vtkIdType InsertNextMorphWeightChannel(vtkIdType targetId, vtkIdType nbKeys);
+  void SetMorphWeightKey(vtkIdType channel, vtkIdType keyId, double weight, double time);
+  vtkIdType GetNumberOfMorphWeightChannels() const;
+  vtkIdType GetMorphWeightChannelTarget(vtkIdType channel) const;
+  vtkIdType GetMorphWeightChannelNumberOfKeys(vtkIdType channel) const;
+
+  /** Interpolated morph target weights at the given animation time (in ticks).
+  * weights is indexed by target and grown if needed; the weights of targets
+  * without channel are left unchanged. */
+  void ComputeMorphWeights(double animationTime, std::vector<double>& weights) const;
+
+  /** Clip metadata. Like the keys, it cannot be set once the animation is immutable. */
   vtkGetMacro(AnimationName, vtkStdString);
-  vtkSetMacro(AnimationName, vtkStdString);
+  void SetAnimationName(const vtkStdString& name);
 
   vtkGetMacro(TickPerSecond, double);
-  vtkSetMacro(TickPerSecond, double);
+  void SetTickPerSecond(double tickPerSecond);
 
   vtkGetMacro(Duration, double);
-  vtkSetMacro(Duration, double);
+  void SetDuration(double duration);
+
+  /** Memory used by the animation keys, in kibibytes. */
+  unsigned long GetActualMemorySize() const;
+
+  /** Total number of keys, over all channels. */
+  vtkIdType GetNumberOfKeys() const;
+
+  /** Prevent further modifications of the animation keys and metadata: all the
+  * setters fail with an error afterwards. This cannot be undone. */
+  void SetImmutable();
+  vtkGetMacro(Immutable, bool);
+
+  /** Scan the scaling keys and set the scale mode to the smallest
+  * vtkSkeletonPose::ScaleModes able to represent them. Called by SetImmutable().
+  * Until then, the animation is considered NON_UNIFORM_SCALE. */
+  void ClassifyScale();
+  vtkGetMacro(ScaleMode, int);
 
 protected:
   vtkSkeletonAnimation();
@@ -70,13 +169,38 @@ private:
   vtkSkeletonAnimation(const vtkSkeletonAnimation&) = delete;
   void operator=(const vtkSkeletonAnimation&) = delete;
 
+  // A range of keys in the flat buffers
+  struct Channel
+  {
+    vtkIdType TimeOffset;
+    vtkIdType ValueOffset;
+    vtkIdType NumberOfKeys;
+  };
+
+  Channel AllocateChannel(int channelType, vtkIdType nbKeys);
+
+  template <int Mode>
+  void InterpolatePose(double animationTime, vtkSkeletonPose* outputPose) const;
+
+  template <int Mode>
+  void SampleNode(vtkIdType nodeId, double animationTime, double* position,
+    double* orientation, double* scale) const;
+
   vtkStdString AnimationName;
   double TickPerSecond;
   double Duration;
-
-  std::vector<vtkSkeletonAnimationKeys*> PositionKeys;
-  std::vector<vtkSkeletonAnimationKeys*> RotationKeys;
-  std::vector<vtkSkeletonAnimationKeys*> ScalingKeys;
+  bool Immutable;
+  int ScaleMode;
+
+  std::vector<float> KeyTimes;
+  std::vector<float> KeyValues;
+
+  std::vector<Channel> NodeChannels; // POSITION, ROTATION and SCALING of each node
+  std::vector<unsigned char> NodeAnimated;
+  std::vector<vtkIdType> AnimatedNodes;
+  vtkSkeletonPose* RestPose;
+  std::vector<Channel> MorphWeightChannels;
+  std::vector<vtkIdType> MorphWeightTargets;
 };
 
 #endif
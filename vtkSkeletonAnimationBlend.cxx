@@ -0,0 +1,520 @@
+#include "vtkSkeletonAnimationBlend.h"
+
+#include "vtkSkeletonAnimation.h"
+#include "vtkSkeletonHierarchy.h"
+#include "vtkSkeletonPose.h"
+
+#include <vtkIdTypeArray.h>
+#include <vtkObjectFactory.h> // For New macro
+#include <vtkQuaternion.h>
+#include <vtkStringArray.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Normalized linear interpolation between the identity and a wxyz quaternion.
+void WeightQuaternion(const double* q, double weight, double* output)
+{
+  double sign = q[0] < 0.0 ? -1.0 : 1.0;
+  output[0] = (1.0 - weight) + weight * sign * q[0];
+  for (int i = 1; i < 4; i++)
+  {
+    output[i] = weight * sign * q[i];
+  }
+
+  double norm = std::sqrt(output[0] * output[0] + output[1] * output[1] +
+    output[2] * output[2] + output[3] * output[3]);
+  for (int i = 0; i < 4; i++)
+  {
+    output[i] /= norm;
+  }
+}
+}
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSkeletonAnimationBlend)
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationBlend::vtkSkeletonAnimationBlend()
+{
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationBlend::~vtkSkeletonAnimationBlend()
+{
+  this->RemoveAllLayers();
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSkeletonAnimationBlend::IsValidLayer(int layer) const
+{
+  return layer >= 0 && layer < static_cast<int>(this->Layers.size());
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::LayersModified()
+{
+  this->LayersTime.Modified();
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::LayerTimesModified()
+{
+  this->LayerTimesTime.Modified();
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+vtkMTimeType vtkSkeletonAnimationBlend::GetLayersMTime()
+{
+  vtkMTimeType layersTime = this->LayersTime.GetMTime();
+  for (size_t i = 0; i < this->Layers.size(); i++)
+  {
+    layersTime = std::max(layersTime, this->Layers[i].Animation->GetMTime());
+  }
+  return layersTime;
+}
+
+//-----------------------------------------------------------------------------
+vtkMTimeType vtkSkeletonAnimationBlend::GetLayerTimesMTime()
+{
+  return this->LayerTimesTime.GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkeletonAnimationBlend::AddLayer(vtkSkeletonAnimation* animation, double weight, int mode)
+{
+  if (animation == nullptr)
+  {
+    vtkErrorMacro(<< "Cannot add a layer without animation.");
+    return -1;
+  }
+
+  animation->Register(this);
+
+  Layer layer;
+  layer.Animation = animation;
+  layer.Time = 0.0;
+  layer.Weight = weight;
+  layer.Mode = mode;
+  layer.ReferenceTime = 0;
+  this->Layers.push_back(layer);
+
+  this->LayersModified();
+  return static_cast<int>(this->Layers.size()) - 1;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::RemoveAllLayers()
+{
+  if (this->Layers.empty())
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < this->Layers.size(); i++)
+  {
+    this->Layers[i].Animation->Delete();
+  }
+  this->Layers.clear();
+  this->LayersModified();
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkeletonAnimationBlend::GetNumberOfLayers() const
+{
+  return static_cast<int>(this->Layers.size());
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimation* vtkSkeletonAnimationBlend::GetLayerAnimation(int layer)
+{
+  return this->IsValidLayer(layer) ? this->Layers[layer].Animation : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::SetLayerTime(int layer, double time)
+{
+  if (!this->IsValidLayer(layer) || this->Layers[layer].Time == time)
+  {
+    return;
+  }
+  this->Layers[layer].Time = time;
+  this->LayerTimesModified();
+}
+
+//-----------------------------------------------------------------------------
+double vtkSkeletonAnimationBlend::GetLayerTime(int layer) const
+{
+  return this->IsValidLayer(layer) ? this->Layers[layer].Time : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::SetLayerWeight(int layer, double weight)
+{
+  if (!this->IsValidLayer(layer) || this->Layers[layer].Weight == weight)
+  {
+    return;
+  }
+  this->Layers[layer].Weight = weight;
+  this->LayersModified();
+}
+
+//-----------------------------------------------------------------------------
+double vtkSkeletonAnimationBlend::GetLayerWeight(int layer) const
+{
+  return this->IsValidLayer(layer) ? this->Layers[layer].Weight : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::SetLayerMode(int layer, int mode)
+{
+  if (!this->IsValidLayer(layer) || this->Layers[layer].Mode == mode)
+  {
+    return;
+  }
+  this->Layers[layer].Mode = mode;
+  this->LayersModified();
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkeletonAnimationBlend::GetLayerMode(int layer) const
+{
+  return this->IsValidLayer(layer) ? this->Layers[layer].Mode : BLEND;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::SetLayerBoneMask(int layer, const std::vector<double>& boneWeights)
+{
+  if (!this->IsValidLayer(layer))
+  {
+    return;
+  }
+  this->Layers[layer].BoneMask = boneWeights;
+  this->LayersModified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::SetLayerBoneMask(int layer,
+  vtkSkeletonHierarchy* hierarchy, const char* rootNodeName)
+{
+  if (!this->IsValidLayer(layer) || hierarchy == nullptr || rootNodeName == nullptr)
+  {
+    return;
+  }
+
+  vtkIdType rootNodeId = hierarchy->GetNodeNames()->LookupValue(rootNodeName);
+  if (rootNodeId == -1)
+  {
+    vtkErrorMacro(<< "Node " << rootNodeName << " not found in hierarchy.");
+    return;
+  }
+
+  std::vector<double> boneWeights(this->Layers[layer].Animation->GetNumberOfNodes(), 0.0);
+  for (vtkIdType nodeId = 0; nodeId < hierarchy->GetNumberOfNodes(); nodeId++)
+  {
+    vtkIdType boneId = hierarchy->GetNodeTypes()->GetValue(nodeId);
+    if (boneId < 0 || boneId >= static_cast<vtkIdType>(boneWeights.size()))
+    {
+      continue;
+    }
+
+    // Walk up to the root to find out whether the node is in the subtree
+    vtkIdType ancestorId = nodeId;
+    while (ancestorId != -1 && ancestorId != rootNodeId)
+    {
+      ancestorId = hierarchy->GetParentId(ancestorId);
+    }
+    if (ancestorId == rootNodeId)
+    {
+      boneWeights[boneId] = 1.0;
+    }
+  }
+
+  this->SetLayerBoneMask(layer, boneWeights);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::RemoveLayerBoneMask(int layer)
+{
+  if (!this->IsValidLayer(layer) || this->Layers[layer].BoneMask.empty())
+  {
+    return;
+  }
+  this->Layers[layer].BoneMask.clear();
+  this->LayersModified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::AdvanceTime(double seconds)
+{
+  for (size_t i = 0; i < this->Layers.size(); i++)
+  {
+    Layer& layer = this->Layers[i];
+    layer.Time += seconds * layer.Animation->GetTickPerSecond();
+    if (layer.Animation->GetDuration() > 0.0)
+    {
+      layer.Time = std::fmod(layer.Time, layer.Animation->GetDuration());
+    }
+  }
+  this->LayerTimesModified();
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSkeletonAnimationBlend::IsReferenceValid(const Layer& layer)
+{
+  return layer.ReferenceTime == layer.Animation->GetMTime() &&
+    layer.Reference.size() == static_cast<size_t>(10 * layer.Animation->GetNumberOfNodes());
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::UpdateReference(Layer& layer)
+{
+  if (IsReferenceValid(layer))
+  {
+    return;
+  }
+
+  vtkIdType nbNodes = layer.Animation->GetNumberOfNodes();
+
+  // Position, wxyz orientation and scale of each node at time 0
+  layer.Reference.resize(10 * nbNodes);
+  for (vtkIdType nodeId = 0; nodeId < nbNodes; nodeId++)
+  {
+    double* reference = &layer.Reference[10 * nodeId];
+    layer.Animation->SampleNodeTransform(nodeId, 0.0, reference, reference + 3, reference + 7);
+  }
+  layer.ReferenceTime = layer.Animation->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::Prepare()
+{
+  for (size_t l = 0; l < this->Layers.size(); l++)
+  {
+    if (this->Layers[l].Mode == ADDITIVE)
+    {
+      UpdateReference(this->Layers[l]);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationBlend::ComputePose(vtkSkeletonPose* outputPose) const
+{
+  vtkIdType nbBones = 0;
+  int scaleMode = vtkSkeletonPose::NO_SCALE;
+  for (size_t l = 0; l < this->Layers.size(); l++)
+  {
+    nbBones = std::max(nbBones, this->Layers[l].Animation->GetNumberOfNodes());
+    scaleMode = std::max(scaleMode, this->Layers[l].Animation->GetScaleMode());
+  }
+  bool scaled = scaleMode != vtkSkeletonPose::NO_SCALE;
+
+  if (nbBones == 0)
+  {
+    return;
+  }
+
+  // Every transform is blended: they are not the rest transforms of a clip
+  outputPose->SetRestTransformsAnimationTime(0);
+
+  outputPose->SetScaleMode(scaleMode);
+  if (outputPose->GetNumberOfTransforms() != nbBones)
+  {
+    outputPose->SetNumberOfTransforms(nbBones);
+  }
+
+  // Layer times wrapped in the animation range
+  std::vector<double> layerTimes(this->Layers.size());
+  std::vector<bool> referenceValid(this->Layers.size());
+  for (size_t l = 0; l < this->Layers.size(); l++)
+  {
+    double duration = this->Layers[l].Animation->GetDuration();
+    layerTimes[l] = duration > 0.0 ? std::fmod(this->Layers[l].Time, duration) : 0.0;
+    referenceValid[l] = IsReferenceValid(this->Layers[l]);
+  }
+
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+  {
+    double position[3] = { 0.0, 0.0, 0.0 };
+    double orientation[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double scale[3] = { 0.0, 0.0, 0.0 };
+    double totalWeight = 0.0;
+    int fallbackLayer = -1;
+
+    // Weighted blend of the BLEND layers
+    for (size_t l = 0; l < this->Layers.size(); l++)
+    {
+      const Layer& layer = this->Layers[l];
+      if (layer.Mode != BLEND || boneId >= layer.Animation->GetNumberOfNodes())
+      {
+        continue;
+      }
+
+      if (fallbackLayer == -1)
+      {
+        fallbackLayer = static_cast<int>(l);
+      }
+
+      double weight = layer.Weight;
+      if (!layer.BoneMask.empty())
+      {
+        weight *= boneId < static_cast<vtkIdType>(layer.BoneMask.size()) ? layer.BoneMask[boneId] : 0.0;
+      }
+      if (weight <= 0.0)
+      {
+        continue;
+      }
+
+      double layerPosition[3];
+      double layerOrientation[4];
+      double layerScale[3] = { 1.0, 1.0, 1.0 };
+      if (scaled)
+      {
+        layer.Animation->SampleNodeTransform(boneId, layerTimes[l], layerPosition, layerOrientation, layerScale);
+      }
+      else
+      {
+        layer.Animation->SampleNodeTransform(boneId, layerTimes[l], layerPosition, layerOrientation);
+      }
+
+      // Keep quaternions in the same hemisphere before averaging them
+      double dot = orientation[0] * layerOrientation[0] + orientation[1] * layerOrientation[1] +
+        orientation[2] * layerOrientation[2] + orientation[3] * layerOrientation[3];
+      double sign = dot < 0.0 ? -1.0 : 1.0;
+
+      for (int i = 0; i < 3; i++)
+      {
+        position[i] += weight * layerPosition[i];
+        scale[i] += weight * layerScale[i];
+      }
+      for (int i = 0; i < 4; i++)
+      {
+        orientation[i] += sign * weight * layerOrientation[i];
+      }
+      totalWeight += weight;
+    }
+
+    double orientationNorm = std::sqrt(orientation[0] * orientation[0] +
+      orientation[1] * orientation[1] + orientation[2] * orientation[2] +
+      orientation[3] * orientation[3]);
+
+    if (totalWeight > 0.0 && orientationNorm > 0.0)
+    {
+      for (int i = 0; i < 3; i++)
+      {
+        position[i] /= totalWeight;
+        scale[i] /= totalWeight;
+      }
+      for (int i = 0; i < 4; i++)
+      {
+        orientation[i] /= orientationNorm;
+      }
+    }
+    else if (fallbackLayer != -1)
+    {
+      // Bone masked out of every layer: use the first clip as is
+      scale[0] = scale[1] = scale[2] = 1.0;
+      if (scaled)
+      {
+        this->Layers[fallbackLayer].Animation->SampleNodeTransform(
+          boneId, layerTimes[fallbackLayer], position, orientation, scale);
+      }
+      else
+      {
+        this->Layers[fallbackLayer].Animation->SampleNodeTransform(
+          boneId, layerTimes[fallbackLayer], position, orientation);
+      }
+    }
+    else
+    {
+      // No BLEND layer on this bone: start from the rest pose of the first clip
+      // animating it, so that ADDITIVE layers alone do not collapse the skeleton
+      size_t restLayer = 0;
+      while (boneId >= this->Layers[restLayer].Animation->GetNumberOfNodes())
+      {
+        restLayer++;
+      }
+      this->Layers[restLayer].Animation->GetRestTransform(boneId, position, orientation, scale);
+    }
+
+    // ADDITIVE layers apply their difference to their first frame
+    for (size_t l = 0; l < this->Layers.size(); l++)
+    {
+      const Layer& layer = this->Layers[l];
+      if (layer.Mode != ADDITIVE || boneId >= layer.Animation->GetNumberOfNodes())
+      {
+        continue;
+      }
+
+      double weight = layer.Weight;
+      if (!layer.BoneMask.empty())
+      {
+        weight *= boneId < static_cast<vtkIdType>(layer.BoneMask.size()) ? layer.BoneMask[boneId] : 0.0;
+      }
+      if (weight <= 0.0)
+      {
+        continue;
+      }
+
+      double layerPosition[3];
+      double layerOrientation[4];
+      double layerScale[3] = { 1.0, 1.0, 1.0 };
+      if (scaled)
+      {
+        layer.Animation->SampleNodeTransform(boneId, layerTimes[l], layerPosition, layerOrientation, layerScale);
+      }
+      else
+      {
+        layer.Animation->SampleNodeTransform(boneId, layerTimes[l], layerPosition, layerOrientation);
+      }
+
+      // First frame sampled by Prepare(), or now if the clip changed since
+      double sampledReference[10];
+      const double* referencePosition = sampledReference;
+      if (referenceValid[l])
+      {
+        referencePosition = &layer.Reference[10 * boneId];
+      }
+      else
+      {
+        layer.Animation->SampleNodeTransform(
+          boneId, 0.0, sampledReference, sampledReference + 3, sampledReference + 7);
+      }
+      const double* referenceOrientation = referencePosition + 3;
+      const double* referenceScale = referencePosition + 7;
+
+      for (int i = 0; i < 3; i++)
+      {
+        position[i] += weight * (layerPosition[i] - referencePosition[i]);
+        // Scales are additive as ratios to the reference frame
+        if (referenceScale[i] != 0.0)
+        {
+          scale[i] *= 1.0 + weight * (layerScale[i] / referenceScale[i] - 1.0);
+        }
+      }
+
+      // delta = conj(reference) * sample, expressed in the bone local frame
+      vtkQuaternion<double> delta =
+        vtkQuaternion<double>(referenceOrientation).Conjugated() * vtkQuaternion<double>(layerOrientation);
+
+      double weightedDelta[4];
+      WeightQuaternion(delta.GetData(), weight, weightedDelta);
+
+      vtkQuaternion<double> result =
+        vtkQuaternion<double>(orientation) * vtkQuaternion<double>(weightedDelta);
+      result.Normalize();
+      result.Get(orientation);
+    }
+
+    outputPose->SetTransform(boneId, position, orientation);
+    if (scaled)
+    {
+      outputPose->SetScale(boneId, scale);
+    }
+  }
+}
@@ -0,0 +1,139 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkeletonAnimationBlend
+* @brief   vtkSkeletonAnimationBlend.
+*
+* Blend node mixing several animation clips into a single local pose.
+* Each layer plays a clip at its own time with a weight, a mode and an optional
+* per-bone mask:
+* - BLEND layers are averaged using their weights (e.g. crossfade walk/run).
+* - ADDITIVE layers add the difference between the clip and its first frame on
+*   top of the blended result (e.g. upper-body wave over walk). The first frame
+*   is sampled once per layer by Prepare() and kept until the clip is modified.
+*
+* Bones without any BLEND layer (e.g. only ADDITIVE layers) start from the rest
+* pose of the clips (see vtkSkeletonAnimation::GetRestTransform()).
+*
+* ComputePose() samples all the participating clips and blends them in a single
+* pass over the bones, without intermediate vtkSkeletonPose objects. It only
+* reads the layers, so that mappers sharing a blend can compute their poses
+* concurrently once Prepare() was called.
+*/
+
+#ifndef vtkSkeletonAnimationBlend_h
+#define vtkSkeletonAnimationBlend_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkObject.h>
+
+#include <vector>
+
+class vtkSkeletonAnimation;
+class vtkSkeletonHierarchy;
+class vtkSkeletonPose;
+
+class VTKSKINNING_EXPORT vtkSkeletonAnimationBlend : public vtkObject
+{
+public:
+  enum BlendMode { BLEND = 0, ADDITIVE };
+
+  static vtkSkeletonAnimationBlend* New();
+  vtkTypeMacro(vtkSkeletonAnimationBlend, vtkObject)
+
+  /** Add a layer playing animation and return its index. */
+  int AddLayer(vtkSkeletonAnimation* animation, double weight = 1.0, int mode = BLEND);
+
+  /** Empty the structure */
+  void RemoveAllLayers();
+
+  int GetNumberOfLayers() const;
+
+  vtkSkeletonAnimation* GetLayerAnimation(int layer);
+
+  /** Layer animation time, in ticks. */
+  void SetLayerTime(int layer, double time);
+  double GetLayerTime(int layer) const;
+
+  void SetLayerWeight(int layer, double weight);
+  double GetLayerWeight(int layer) const;
+
+  void SetLayerMode(int layer, int mode);
+  int GetLayerMode(int layer) const;
+
+  /** Per-bone weight factors of a layer, indexed by bone id.
+  * Bones outside the mask are not affected by the layer. */
+  void SetLayerBoneMask(int layer, const std::vector<double>& boneWeights);
+
+  /** Restrict a layer to the bones of the subtree rooted at the given node. */
+  void SetLayerBoneMask(int layer, vtkSkeletonHierarchy* hierarchy, const char* rootNodeName);
+
+  void RemoveLayerBoneMask(int layer);
+
+  /** Advance the time of all layers by the given duration in seconds.
+  * Layer times loop over their animation duration. */
+  void AdvanceTime(double seconds);
+
+  /** Last modification of the layers (clips, weights, modes, masks), layer
+  * times excluded. */
+  vtkMTimeType GetLayersMTime();
+
+  /** Last modification of the layer times (SetLayerTime(), AdvanceTime()). */
+  vtkMTimeType GetLayerTimesMTime();
+
+  /** Sample the first frame of the ADDITIVE layers whose clip changed.
+  * Not thread safe: call it serially before ComputePose(). */
+  void Prepare();
+
+  /** Blend the layers into outputPose (local bone transforms). ADDITIVE layers
+  * not prepared since their clip changed sample their first frame on the fly. */
+  void ComputePose(vtkSkeletonPose* outputPose) const;
+
+protected:
+  vtkSkeletonAnimationBlend();
+  ~vtkSkeletonAnimationBlend() override;
+
+private:
+  vtkSkeletonAnimationBlend(const vtkSkeletonAnimationBlend&) = delete;
+  void operator=(const vtkSkeletonAnimationBlend&) = delete;
+
+  struct Layer
+  {
+    vtkSkeletonAnimation* Animation;
+    double Time;
+    double Weight;
+    int Mode;
+    std::vector<double> BoneMask; // Empty means all bones
+    std::vector<double> Reference; // First frame of ADDITIVE layers, 10 values per bone
+    vtkMTimeType ReferenceTime; // Animation time of Reference
+  };
+
+  bool IsValidLayer(int layer) const;
+
+  /** Modify the layers, or only their times. */
+  void LayersModified();
+  void LayerTimesModified();
+
+  /** Sample the first frame of the layer animation if it changed. */
+  static void UpdateReference(Layer& layer);
+
+  /** Whether the first frame of the layer is up to date. */
+  static bool IsReferenceValid(const Layer& layer);
+
+  std::vector<Layer> Layers;
+  vtkTimeStamp LayersTime;
+  vtkTimeStamp LayerTimesTime;
+};
+
+#endif
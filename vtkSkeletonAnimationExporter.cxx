@@ -0,0 +1,430 @@
+#include "vtkSkeletonAnimationExporter.h"
+
+#include "vtkSkeletonAnimation.h"
+#include "vtkSkeletonAnimationStack.h"
+#include "vtkSkeletonHierarchy.h"
+#include "vtkSkeletonMorphTargets.h"
+#include "vtkSkeletonPose.h"
+
+#include <vtkCellData.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIntArray.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h> // For New macro
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkXMLPolyDataWriter.h>
+
+#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+// Precompute the cached ranges of the arrays shared by all the frames, so that
+// the concurrent writers only read them
+void ComputeRanges(vtkFieldData* fieldData)
+{
+  for (int i = 0; i < fieldData->GetNumberOfArrays(); i++)
+  {
+    vtkDataArray* array = fieldData->GetArray(i);
+    if (array == nullptr)
+    {
+      continue;
+    }
+    array->GetRange(-1);
+    for (int c = 0; c < array->GetNumberOfComponents(); c++)
+    {
+      array->GetRange(c);
+    }
+  }
+}
+
+// Skins and writes a range of frames. Each frame is a shallow copy of the
+// shared mesh, only its points and normals are computed here. They are
+// released with the frame once it is written.
+struct FrameWriter
+{
+  const vtkSkeletonAnimation* Animation;
+  vtkSkeletonHierarchy* Hierarchy;
+  vtkSkeletonPose* BindPose;
+  const vtkSkeletonMorphTargets* MorphTargets; // nullptr if none
+  vtkDataArray* Points;
+  vtkDataArray* Normals;
+  vtkDoubleArray* Weights;
+  vtkIntArray* BoneIds;
+  const std::vector<double>* Ticks;
+  const std::vector<std::string>* FileNames;
+  vtkPolyData* SharedMesh;
+  std::atomic<int>* NumberOfFailures;
+
+  vtkSMPThreadLocalObject<vtkSkeletonPose> LocalPose;
+  vtkSMPThreadLocalObject<vtkSkeletonPose> GlobalPose;
+  vtkSMPThreadLocalObject<vtkSkeletonPose> SkinningPose;
+  vtkSMPThreadLocal<std::vector<float> > Palette;
+  vtkSMPThreadLocalObject<vtkXMLPolyDataWriter> Writer;
+
+  void Initialize()
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkSkeletonPose* localPose = this->LocalPose.Local();
+    vtkSkeletonPose* globalPose = this->GlobalPose.Local();
+    vtkSkeletonPose* skinningPose = this->SkinningPose.Local();
+    std::vector<float>& palette = this->Palette.Local();
+    vtkXMLPolyDataWriter* writer = this->Writer.Local();
+
+    for (vtkIdType frameId = begin; frameId < end; frameId++)
+    {
+      this->Animation->ComputeInterpolatedPose((*this->Ticks)[frameId], localPose);
+      vtkSkeletonPose::ComputeGlobalPose(localPose, this->Hierarchy, globalPose);
+      vtkSkeletonPose::MultiplyToPalette(globalPose, this->BindPose, skinningPose, palette);
+
+      vtkNew<vtkPolyData> frame;
+      frame->ShallowCopy(this->SharedMesh);
+
+      // Morph targets are applied in bind space, before skinning
+      vtkDataArray* points = this->Points;
+      vtkDataArray* normals = this->Normals;
+      vtkSmartPointer<vtkDataArray> morphedPoints;
+      vtkSmartPointer<vtkDataArray> morphedNormals;
+      if (this->MorphTargets != nullptr)
+      {
+        size_t nbTargets = static_cast<size_t>(this->MorphTargets->GetNumberOfTargets());
+        std::vector<double> morphWeights(nbTargets, 0.0);
+        this->Animation->ComputeMorphWeights((*this->Ticks)[frameId], morphWeights);
+        morphWeights.resize(nbTargets);
+
+        morphedPoints.TakeReference(vtkDataArray::CreateDataArray(points->GetDataType()));
+        if (normals != nullptr)
+        {
+          morphedNormals.TakeReference(vtkDataArray::CreateDataArray(normals->GetDataType()));
+        }
+        if (!this->MorphTargets->Apply(morphWeights, points, morphedPoints, normals, morphedNormals))
+        {
+          ++(*this->NumberOfFailures);
+          continue;
+        }
+        points = morphedPoints;
+        normals = morphedNormals;
+      }
+
+      vtkNew<vtkFloatArray> skinnedPointsData;
+      vtkSkeletonPose::SkinVectors(points, this->Weights, this->BoneIds, palette, 1.0, skinnedPointsData);
+      vtkNew<vtkPoints> skinnedPoints;
+      skinnedPoints->SetData(skinnedPointsData);
+      frame->SetPoints(skinnedPoints);
+
+      if (normals != nullptr)
+      {
+        vtkNew<vtkFloatArray> skinnedNormals;
+        skinnedNormals->SetName(this->Normals->GetName());
+        vtkSkeletonPose::SkinVectors(normals, this->Weights, this->BoneIds, palette, 0.0, skinnedNormals);
+        float* normal = skinnedNormals->GetPointer(0);
+        for (vtkIdType pointId = 0; pointId < skinnedNormals->GetNumberOfTuples(); pointId++, normal += 3)
+        {
+          vtkMath::Normalize(normal);
+        }
+        frame->GetPointData()->SetNormals(skinnedNormals);
+      }
+
+      writer->SetInputData(frame);
+      writer->SetFileName((*this->FileNames)[frameId].c_str());
+      if (writer->Write() == 0)
+      {
+        ++(*this->NumberOfFailures);
+      }
+      writer->SetInputData(nullptr);
+    }
+  }
+
+  void Reduce()
+  {
+  }
+};
+}
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSkeletonAnimationExporter)
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationExporter::vtkSkeletonAnimationExporter()
+{
+  this->Mesh = nullptr;
+  this->SkeletonBindPose = nullptr;
+  this->SkeletonHierarchy = nullptr;
+  this->SkeletonAnimationStack = nullptr;
+  this->MorphTargets = nullptr;
+  this->AnimationIndex = 0;
+  this->FileName = nullptr;
+  this->FrameStride = 1;
+  this->KeepSkinningArrays = false;
+  this->Parallel = true;
+
+  this->NumberOfExportedFrames = 0;
+  this->ExportTime = 0.0;
+  this->FramesPerSecond = 0.0;
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationExporter::~vtkSkeletonAnimationExporter()
+{
+  this->SetMesh(nullptr);
+  this->SetSkeletonBindPose(nullptr);
+  this->SetSkeletonHierarchy(nullptr);
+  this->SetSkeletonAnimationStack(nullptr);
+  this->SetMorphTargets(nullptr);
+  this->SetFileName(nullptr);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationExporter::SetMesh(vtkPolyData* mesh)
+{
+  if (this->Mesh == mesh)
+  {
+    return;
+  }
+
+  if (this->Mesh != nullptr)
+  {
+    this->Mesh->Delete();
+  }
+  if (mesh != nullptr)
+  {
+    mesh->Register(this);
+  }
+  this->Mesh = mesh;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationExporter::SetSkeletonBindPose(vtkSkeletonPose* pose)
+{
+  if (this->SkeletonBindPose == pose)
+  {
+    return;
+  }
+
+  if (this->SkeletonBindPose != nullptr)
+  {
+    this->SkeletonBindPose->Delete();
+  }
+  if (pose != nullptr)
+  {
+    pose->Register(this);
+  }
+  this->SkeletonBindPose = pose;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationExporter::SetSkeletonHierarchy(vtkSkeletonHierarchy* hierarchy)
+{
+  if (this->SkeletonHierarchy == hierarchy)
+  {
+    return;
+  }
+
+  if (this->SkeletonHierarchy != nullptr)
+  {
+    this->SkeletonHierarchy->Delete();
+  }
+  if (hierarchy != nullptr)
+  {
+    hierarchy->Register(this);
+  }
+  this->SkeletonHierarchy = hierarchy;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationExporter::SetSkeletonAnimationStack(vtkSkeletonAnimationStack* animationStack)
+{
+  if (this->SkeletonAnimationStack == animationStack)
+  {
+    return;
+  }
+
+  if (this->SkeletonAnimationStack != nullptr)
+  {
+    this->SkeletonAnimationStack->Delete();
+  }
+  if (animationStack != nullptr)
+  {
+    animationStack->Register(this);
+  }
+  this->SkeletonAnimationStack = animationStack;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationExporter::SetMorphTargets(vtkSkeletonMorphTargets* morphTargets)
+{
+  if (this->MorphTargets == morphTargets)
+  {
+    return;
+  }
+
+  if (this->MorphTargets != nullptr)
+  {
+    this->MorphTargets->Delete();
+  }
+  if (morphTargets != nullptr)
+  {
+    morphTargets->Register(this);
+  }
+  this->MorphTargets = morphTargets;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSkeletonAnimationExporter::Write()
+{
+  this->NumberOfExportedFrames = 0;
+  this->ExportTime = 0.0;
+  this->FramesPerSecond = 0.0;
+
+  if (this->FileName == nullptr || this->Mesh == nullptr || this->Mesh->GetPoints() == nullptr ||
+    this->SkeletonBindPose == nullptr || this->SkeletonHierarchy == nullptr ||
+    this->SkeletonAnimationStack == nullptr)
+  {
+    vtkErrorMacro(<< "Missing file name, mesh, bind pose, hierarchy or animation stack.");
+    return false;
+  }
+
+  vtkDoubleArray* weights = vtkDoubleArray::SafeDownCast(this->Mesh->GetPointData()->GetAbstractArray("Weights"));
+  vtkIntArray* boneIds = vtkIntArray::SafeDownCast(this->Mesh->GetPointData()->GetAbstractArray("BoneIDs"));
+  if (weights == nullptr || boneIds == nullptr ||
+    weights->GetNumberOfComponents() != 4 || boneIds->GetNumberOfComponents() != 4)
+  {
+    vtkErrorMacro(<< "The mesh has no skinning weights.");
+    return false;
+  }
+
+  vtkSkeletonAnimation* animation = nullptr;
+  if (this->AnimationIndex >= 0 && this->AnimationIndex < this->SkeletonAnimationStack->GetNumberOfAnimations())
+  {
+    animation = this->SkeletonAnimationStack->GetAnimation(this->AnimationIndex);
+  }
+  if (animation == nullptr)
+  {
+    vtkErrorMacro(<< "Invalid animation " << this->AnimationIndex);
+    return false;
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
+
+  // Frames to export, from tick 0 up to the duration included, whose frame
+  // samples the last keys of the clip
+  double ticksPerSecond = animation->GetTickPerSecond() > 0.0 ? animation->GetTickPerSecond() : 1.0;
+  double duration = std::max(animation->GetDuration(), 0.0);
+  vtkIdType nbFrames = static_cast<vtkIdType>(std::floor(duration / this->FrameStride)) + 1;
+  std::vector<double> ticks(nbFrames);
+  for (vtkIdType frameId = 0; frameId < nbFrames; frameId++)
+  {
+    ticks[frameId] = static_cast<double>(frameId * this->FrameStride);
+  }
+
+  std::string directory = vtksys::SystemTools::GetFilenamePath(this->FileName);
+  std::string baseName = vtksys::SystemTools::GetFilenameWithoutLastExtension(this->FileName);
+  std::vector<std::string> frameNames(nbFrames);
+  std::vector<std::string> fileNames(nbFrames);
+  for (vtkIdType frameId = 0; frameId < nbFrames; frameId++)
+  {
+    std::ostringstream frameName;
+    frameName << baseName << "_" << std::setw(4) << std::setfill('0') << frameId << ".vtp";
+    frameNames[frameId] = frameName.str();
+    fileNames[frameId] = directory.empty() ? frameNames[frameId] : directory + "/" + frameNames[frameId];
+  }
+
+  // Arrays shared by all the frames
+  vtkNew<vtkPolyData> sharedMesh;
+  sharedMesh->ShallowCopy(this->Mesh);
+  if (!this->KeepSkinningArrays)
+  {
+    sharedMesh->GetPointData()->RemoveArray("Weights");
+    sharedMesh->GetPointData()->RemoveArray("BoneIDs");
+  }
+  vtkDataArray* normals = this->Mesh->GetPointData()->GetNormals();
+  if (normals != nullptr && normals->GetNumberOfComponents() != 3)
+  {
+    normals = nullptr;
+  }
+  ComputeRanges(sharedMesh->GetPointData());
+  ComputeRanges(sharedMesh->GetCellData());
+  ComputeRanges(sharedMesh->GetFieldData());
+
+  // The hierarchy is shared: build its evaluation order now
+  this->SkeletonHierarchy->GetEvaluationNodes();
+
+  std::atomic<int> nbFailures(0);
+  FrameWriter frameWriter;
+  frameWriter.Animation = animation;
+  frameWriter.Hierarchy = this->SkeletonHierarchy;
+  frameWriter.BindPose = this->SkeletonBindPose;
+  frameWriter.MorphTargets = this->MorphTargets != nullptr && this->MorphTargets->GetNumberOfTargets() > 0 ?
+    this->MorphTargets : nullptr;
+  frameWriter.Points = this->Mesh->GetPoints()->GetData();
+  frameWriter.Normals = normals;
+  frameWriter.Weights = weights;
+  frameWriter.BoneIds = boneIds;
+  frameWriter.Ticks = &ticks;
+  frameWriter.FileNames = &fileNames;
+  frameWriter.SharedMesh = sharedMesh;
+  frameWriter.NumberOfFailures = &nbFailures;
+
+  if (this->Parallel)
+  {
+    vtkSMPTools::For(0, nbFrames, 1, frameWriter);
+  }
+  else
+  {
+    frameWriter(0, nbFrames);
+  }
+
+  if (nbFailures > 0)
+  {
+    vtkErrorMacro(<< nbFailures << " frames of " << this->FileName << " could not be written.");
+    return false;
+  }
+
+  // Collection referencing the frames by their time in seconds
+  std::ofstream collection(this->FileName);
+  if (!collection)
+  {
+    vtkErrorMacro(<< "Cannot write " << this->FileName);
+    return false;
+  }
+  collection << "<?xml version=\"1.0\"?>\n";
+  collection << "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+  collection << "  <Collection>\n";
+  for (vtkIdType frameId = 0; frameId < nbFrames; frameId++)
+  {
+    collection << "    <DataSet timestep=\"" << ticks[frameId] / ticksPerSecond
+      << "\" group=\"\" part=\"0\" file=\"" << frameNames[frameId] << "\"/>\n";
+  }
+  collection << "  </Collection>\n";
+  collection << "</VTKFile>\n";
+
+  this->NumberOfExportedFrames = nbFrames;
+  this->ExportTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+  this->FramesPerSecond = this->ExportTime > 0.0 ? nbFrames / this->ExportTime : 0.0;
+
+  return true;
+}
@@ -0,0 +1,125 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkeletonAnimationExporter
+* @brief   vtkSkeletonAnimationExporter.
+*
+* Bake a clip of a vtkSkeletonAnimationStack into a VTK time series: one
+* .vtp file per exported frame, referenced by a .pvd collection (FileName),
+* so that the deformed meshes can be read by simulation or analysis tools.
+*
+* The mesh is the bind mesh, with the "Weights" and "BoneIDs" point arrays
+* written by vtkAssimpImporter. Frames are skinned on the CPU and written in
+* parallel with vtkSMPTools, each thread with its own poses and writer.
+* All the frames share the unchanging arrays of the mesh (cells, TCoords,
+* material and other point and cell data) in memory: only the points and
+* normals are computed per frame, and released once the frame is written.
+* Morph targets (see SetMorphTargets()) are applied before skinning, and the
+* skinned normals are normalized. The skinning arrays are dropped from the
+* files unless KeepSkinningArrays is on.
+*
+* Frame files are named after FileName: "walk.pvd" gives "walk_0000.vtp"...
+*/
+
+#ifndef vtkSkeletonAnimationExporter_h
+#define vtkSkeletonAnimationExporter_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkObject.h>
+
+class vtkPolyData;
+class vtkSkeletonAnimationStack;
+class vtkSkeletonHierarchy;
+class vtkSkeletonMorphTargets;
+class vtkSkeletonPose;
+
+class VTKSKINNING_EXPORT vtkSkeletonAnimationExporter : public vtkObject
+{
+public:
+  static vtkSkeletonAnimationExporter* New();
+  vtkTypeMacro(vtkSkeletonAnimationExporter, vtkObject)
+
+  void SetMesh(vtkPolyData* mesh);
+  vtkGetMacro(Mesh, vtkPolyData*);
+
+  void SetSkeletonBindPose(vtkSkeletonPose* pose);
+  vtkGetMacro(SkeletonBindPose, vtkSkeletonPose*);
+
+  void SetSkeletonHierarchy(vtkSkeletonHierarchy* hierarchy);
+  vtkGetMacro(SkeletonHierarchy, vtkSkeletonHierarchy*);
+
+  void SetSkeletonAnimationStack(vtkSkeletonAnimationStack* animationStack);
+  vtkGetMacro(SkeletonAnimationStack, vtkSkeletonAnimationStack*);
+
+  /** Optional morph targets of the mesh, weighted by the morph channels of
+  * the clip. */
+  void SetMorphTargets(vtkSkeletonMorphTargets* morphTargets);
+  vtkGetMacro(MorphTargets, vtkSkeletonMorphTargets*);
+
+  /** Clip of the stack to export (default 0). */
+  vtkGetMacro(AnimationIndex, int);
+  vtkSetMacro(AnimationIndex, int);
+
+  /** Name of the .pvd collection file. */
+  vtkSetStringMacro(FileName);
+  vtkGetStringMacro(FileName);
+
+  /** Number of animation ticks between two exported frames (default 1). */
+  vtkGetMacro(FrameStride, int);
+  vtkSetClampMacro(FrameStride, int, 1, VTK_INT_MAX);
+
+  /** Keep the "Weights" and "BoneIDs" arrays in the frame files. Off by default. */
+  vtkGetMacro(KeepSkinningArrays, bool);
+  vtkSetMacro(KeepSkinningArrays, bool);
+  vtkBooleanMacro(KeepSkinningArrays, bool);
+
+  /** Enable/Disable the parallel export of the frames. On by default. */
+  vtkGetMacro(Parallel, bool);
+  vtkSetMacro(Parallel, bool);
+  vtkBooleanMacro(Parallel, bool);
+
+  /** Export the frames and the collection. Returns false on error. */
+  bool Write();
+
+  /** Statistics of the last Write(): exported frames, wall time in seconds
+  * and throughput in frames per second. */
+  vtkGetMacro(NumberOfExportedFrames, vtkIdType);
+  vtkGetMacro(ExportTime, double);
+  vtkGetMacro(FramesPerSecond, double);
+
+protected:
+  vtkSkeletonAnimationExporter();
+  ~vtkSkeletonAnimationExporter() override;
+
+private:
+  vtkSkeletonAnimationExporter(const vtkSkeletonAnimationExporter&) = delete;
+  void operator=(const vtkSkeletonAnimationExporter&) = delete;
+
+  vtkPolyData* Mesh;
+  vtkSkeletonPose* SkeletonBindPose;
+  vtkSkeletonHierarchy* SkeletonHierarchy;
+  vtkSkeletonAnimationStack* SkeletonAnimationStack;
+  vtkSkeletonMorphTargets* MorphTargets;
+  int AnimationIndex;
+  char* FileName;
+  int FrameStride;
+  bool KeepSkinningArrays;
+  bool Parallel;
+
+  vtkIdType NumberOfExportedFrames;
+  double ExportTime;
+  double FramesPerSecond;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#include "vtkSkeletonAnimationLoader.h"
+
+#include "vtkSkeletonAnimation.h"
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationLoader::vtkSkeletonAnimationLoader()
+{
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationLoader::~vtkSkeletonAnimationLoader()
+{
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSkeletonAnimationLoader::IsAnimationInUse(vtkIdType vtkNotUsed(index),
+  vtkSkeletonAnimation* animation)
+{
+  return animation->GetReferenceCount() > 1;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationLoader::ReleaseAnimation(vtkIdType vtkNotUsed(index),
+  vtkSkeletonAnimation* vtkNotUsed(animation))
+{
+}
@@ -0,0 +1,59 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkeletonAnimationLoader
+* @brief   vtkSkeletonAnimationLoader.
+*
+* Abstract decoder of the clips of a vtkSkeletonAnimationStack.
+* Importers that do not decode every clip up front declare the clips in the
+* stack directory and give it a loader. The stack calls LoadAnimation() the
+* first time a clip is accessed, and again if the clip was evicted.
+*/
+
+#ifndef vtkSkeletonAnimationLoader_h
+#define vtkSkeletonAnimationLoader_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkObject.h>
+
+class vtkSkeletonAnimation;
+
+class VTKSKINNING_EXPORT vtkSkeletonAnimationLoader : public vtkObject
+{
+public:
+  vtkAbstractTypeMacro(vtkSkeletonAnimationLoader, vtkObject)
+
+  /** Decode a clip, given its index in the stack directory.
+  * Returns a new reference, or nullptr on error. */
+  virtual vtkSkeletonAnimation* LoadAnimation(vtkIdType index) = 0;
+
+  /** Whether a decoded clip is referenced by other objects than the stack and
+  * the loader itself, e.g. a mapper evaluating it. The stack does not evict
+  * such clips. By default, true if the stack is not the only owner. */
+  virtual bool IsAnimationInUse(vtkIdType index, vtkSkeletonAnimation* animation);
+
+  /** Called when the stack evicts a decoded clip, before releasing its
+  * reference. Does nothing by default. */
+  virtual void ReleaseAnimation(vtkIdType index, vtkSkeletonAnimation* animation);
+
+protected:
+  vtkSkeletonAnimationLoader();
+  ~vtkSkeletonAnimationLoader() override;
+
+private:
+  vtkSkeletonAnimationLoader(const vtkSkeletonAnimationLoader&) = delete;
+  void operator=(const vtkSkeletonAnimationLoader&) = delete;
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "vtkSkeletonAnimationRegistry.h"
+
+#include "vtkSkeletonAnimation.h"
+
+#include <vtkObjectFactory.h> // For New macro
+#include <vtkSmartPointer.h>
+
+#include <vtksys/SystemTools.hxx>
+
+namespace
+{
+long GetSourceTime(const vtkStdString& sourceName)
+{
+  if (!vtksys::SystemTools::FileExists(sourceName))
+  {
+    return 0;
+  }
+  return vtksys::SystemTools::ModifiedTime(sourceName);
+}
+}
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSkeletonAnimationRegistry)
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationRegistry::vtkSkeletonAnimationRegistry()
+{
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationRegistry::~vtkSkeletonAnimationRegistry()
+{
+  this->Clear();
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationRegistry* vtkSkeletonAnimationRegistry::GetInstance()
+{
+  static vtkSmartPointer<vtkSkeletonAnimationRegistry> instance =
+    vtkSmartPointer<vtkSkeletonAnimationRegistry>::New();
+  return instance;
+}
+
+//-----------------------------------------------------------------------------
+vtkStdString vtkSkeletonAnimationRegistry::GetSourceKey(const char* fileName)
+{
+  if (fileName == nullptr)
+  {
+    return vtkStdString();
+  }
+  return vtksys::SystemTools::CollapseFullPath(fileName);
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimation* vtkSkeletonAnimationRegistry::GetAnimation(
+  const vtkStdString& sourceName, vtkIdType takeIndex, const vtkStdString& clipName)
+{
+  std::lock_guard<std::mutex> guard(this->Lock);
+
+  auto it = this->Animations.find(Key(sourceName, takeIndex, clipName));
+  if (it == this->Animations.end())
+  {
+    return nullptr;
+  }
+
+  // The source changed since the clip was decoded.
+  if (it->second.SourceTime != GetSourceTime(sourceName))
+  {
+    return nullptr;
+  }
+
+  return it->second.Animation;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationRegistry::RegisterAnimation(
+  const vtkStdString& sourceName, vtkIdType takeIndex, vtkSkeletonAnimation* animation)
+{
+  if (animation == nullptr)
+  {
+    return;
+  }
+
+  animation->SetImmutable();
+
+  std::lock_guard<std::mutex> guard(this->Lock);
+
+  Key key(sourceName, takeIndex, animation->GetAnimationName());
+  auto it = this->Animations.find(key);
+  if (it != this->Animations.end())
+  {
+    if (it->second.Animation == animation)
+    {
+      return;
+    }
+    // Replace the stale clip. Users still holding it keep it alive.
+    it->second.Animation->Delete();
+  }
+
+  animation->Register(this);
+  Entry entry = { animation, GetSourceTime(sourceName) };
+  this->Animations[key] = entry;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationRegistry::RemoveAnimation(
+  const vtkStdString& sourceName, vtkIdType takeIndex, const vtkStdString& clipName)
+{
+  std::lock_guard<std::mutex> guard(this->Lock);
+
+  auto it = this->Animations.find(Key(sourceName, takeIndex, clipName));
+  if (it == this->Animations.end())
+  {
+    return;
+  }
+
+  it->second.Animation->Delete();
+  this->Animations.erase(it);
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonAnimationRegistry::RemoveUnusedAnimations()
+{
+  std::lock_guard<std::mutex> guard(this->Lock);
+
+  vtkIdType nbRemoved = 0;
+  for (auto it = this->Animations.begin(); it != this->Animations.end();)
+  {
+    if (it->second.Animation->GetReferenceCount() > 1)
+    {
+      ++it;
+      continue;
+    }
+
+    it->second.Animation->Delete();
+    it = this->Animations.erase(it);
+    nbRemoved++;
+  }
+
+  if (nbRemoved > 0)
+  {
+    this->Modified();
+  }
+  return nbRemoved;
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonAnimationRegistry::GetNumberOfAnimations()
+{
+  std::lock_guard<std::mutex> guard(this->Lock);
+  return static_cast<vtkIdType>(this->Animations.size());
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationRegistry::Clear()
+{
+  std::lock_guard<std::mutex> guard(this->Lock);
+
+  for (auto it = this->Animations.begin(); it != this->Animations.end(); ++it)
+  {
+    it->second.Animation->Delete();
+  }
+  this->Animations.clear();
+}
@@ -0,0 +1,95 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkeletonAnimationRegistry
+* @brief   vtkSkeletonAnimationRegistry.
+*
+* Registry of immutable animation clips keyed by source file, take index and
+* clip name. The take index tells apart takes with the same name in one file.
+* Importers look up clips in the registry before decoding them, so that loading
+* the same asset several times shares the animation keys by reference instead
+* of duplicating them. Registered animations are made immutable.
+*
+* Per-instance playback state (current clip, frame) is held by the mappers.
+*
+* The registry keeps a reference on each clip. RemoveUnusedAnimations() releases
+* the clips that are not referenced anywhere else.
+*/
+
+#ifndef vtkSkeletonAnimationRegistry_h
+#define vtkSkeletonAnimationRegistry_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkObject.h>
+#include <vtkStdString.h>
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
+class vtkSkeletonAnimation;
+
+class VTKSKINNING_EXPORT vtkSkeletonAnimationRegistry : public vtkObject
+{
+public:
+  static vtkSkeletonAnimationRegistry* New();
+  vtkTypeMacro(vtkSkeletonAnimationRegistry, vtkObject)
+
+  /** Registry shared by the importers. */
+  static vtkSkeletonAnimationRegistry* GetInstance();
+
+  /** Return the clip registered for the given source, take and name, nullptr if none.
+  * Clips registered from a source file older than its current modification time
+  * are considered stale and are not returned. */
+  vtkSkeletonAnimation* GetAnimation(const vtkStdString& sourceName, vtkIdType takeIndex,
+    const vtkStdString& clipName);
+
+  /** Register a clip under the given source, take index and its animation name.
+  * The animation is made immutable. */
+  void RegisterAnimation(const vtkStdString& sourceName, vtkIdType takeIndex, vtkSkeletonAnimation* animation);
+
+  void RemoveAnimation(const vtkStdString& sourceName, vtkIdType takeIndex, const vtkStdString& clipName);
+
+  /** Release clips only referenced by the registry. Returns the number of removed clips. */
+  vtkIdType RemoveUnusedAnimations();
+
+  vtkIdType GetNumberOfAnimations();
+
+  /** Empty the structure */
+  void Clear();
+
+  /** Canonical key of a source file (full path). */
+  static vtkStdString GetSourceKey(const char* fileName);
+
+protected:
+  vtkSkeletonAnimationRegistry();
+  ~vtkSkeletonAnimationRegistry() override;
+
+private:
+  vtkSkeletonAnimationRegistry(const vtkSkeletonAnimationRegistry&) = delete;
+  void operator=(const vtkSkeletonAnimationRegistry&) = delete;
+
+  struct Entry
+  {
+    vtkSkeletonAnimation* Animation;
+    long SourceTime; // Modification time of the source when registered
+  };
+
+  typedef std::tuple<vtkStdString, vtkIdType, vtkStdString> Key;
+
+  std::map<Key, Entry> Animations;
+  std::mutex Lock;
+};
+
+#endif
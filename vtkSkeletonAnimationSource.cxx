@@ -0,0 +1,404 @@
+#include "vtkSkeletonAnimationSource.h"
+
+#include "vtkSkeletonAnimation.h"
+#include "vtkSkeletonAnimationStack.h"
+#include "vtkSkeletonHierarchy.h"
+#include "vtkSkeletonMorphTargets.h"
+#include "vtkSkeletonPose.h"
+
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkIntArray.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h> // For New macro
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Ticks per second of a clip, assimp leaves it to 0 when unknown
+double GetTicksPerSecond(double tickPerSecond)
+{
+  return tickPerSecond > 0.0 ? tickPerSecond : 1.0;
+}
+
+// Skinning and morph deltas do not keep the normals unit length
+void NormalizeVectors(vtkDataArray* vectors)
+{
+  for (vtkIdType i = 0; i < vectors->GetNumberOfTuples(); i++)
+  {
+    double vector[3];
+    vectors->GetTuple(i, vector);
+    vtkMath::Normalize(vector);
+    vectors->SetTuple(i, vector);
+  }
+}
+}
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSkeletonAnimationSource)
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationSource::vtkSkeletonAnimationSource()
+{
+  this->SetNumberOfOutputPorts(2);
+
+  this->SkeletonBindPose = nullptr;
+  this->SkeletonHierarchy = nullptr;
+  this->SkeletonAnimationStack = nullptr;
+  this->MorphTargets = nullptr;
+  this->AnimationIndex = 0;
+  this->TimeStepsPerSecond = 30.0;
+  this->ExtractBones = false;
+  this->CacheSize = 4;
+
+  this->LocalPose = vtkSkeletonPose::New();
+  this->GlobalPose = vtkSkeletonPose::New();
+  this->SkinningPose = vtkSkeletonPose::New();
+  this->CacheTime = 0;
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationSource::~vtkSkeletonAnimationSource()
+{
+  if (this->SkeletonBindPose != nullptr)
+  {
+    this->SkeletonBindPose->Delete();
+  }
+  if (this->SkeletonHierarchy != nullptr)
+  {
+    this->SkeletonHierarchy->Delete();
+  }
+  if (this->SkeletonAnimationStack != nullptr)
+  {
+    this->SkeletonAnimationStack->Delete();
+  }
+  if (this->MorphTargets != nullptr)
+  {
+    this->MorphTargets->Delete();
+  }
+
+  this->LocalPose->Delete();
+  this->GlobalPose->Delete();
+  this->SkinningPose->Delete();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationSource::SetSkeletonBindPose(vtkSkeletonPose* pose)
+{
+  if (this->SkeletonBindPose == pose)
+  {
+    return;
+  }
+
+  if (this->SkeletonBindPose != nullptr)
+  {
+    this->SkeletonBindPose->Delete();
+  }
+  if (pose != nullptr)
+  {
+    pose->Register(this);
+  }
+  this->SkeletonBindPose = pose;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationSource::SetSkeletonHierarchy(vtkSkeletonHierarchy* hierarchy)
+{
+  if (this->SkeletonHierarchy == hierarchy)
+  {
+    return;
+  }
+
+  if (this->SkeletonHierarchy != nullptr)
+  {
+    this->SkeletonHierarchy->Delete();
+  }
+  if (hierarchy != nullptr)
+  {
+    hierarchy->Register(this);
+  }
+  this->SkeletonHierarchy = hierarchy;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationSource::SetSkeletonAnimationStack(vtkSkeletonAnimationStack* animationStack)
+{
+  if (this->SkeletonAnimationStack == animationStack)
+  {
+    return;
+  }
+
+  if (this->SkeletonAnimationStack != nullptr)
+  {
+    this->SkeletonAnimationStack->Delete();
+  }
+  if (animationStack != nullptr)
+  {
+    animationStack->Register(this);
+  }
+  this->SkeletonAnimationStack = animationStack;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationSource::SetMorphTargets(vtkSkeletonMorphTargets* morphTargets)
+{
+  if (this->MorphTargets == morphTargets)
+  {
+    return;
+  }
+
+  if (this->MorphTargets != nullptr)
+  {
+    this->MorphTargets->Delete();
+  }
+  if (morphTargets != nullptr)
+  {
+    morphTargets->Register(this);
+  }
+  this->MorphTargets = morphTargets;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+vtkPolyData* vtkSkeletonAnimationSource::GetBonesOutput()
+{
+  return this->GetOutput(1);
+}
+
+//-----------------------------------------------------------------------------
+vtkMTimeType vtkSkeletonAnimationSource::GetMTime()
+{
+  // The stack is not included: it is modified when clips are decoded or
+  // evicted, which does not change the animation itself
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (this->SkeletonBindPose != nullptr)
+  {
+    mTime = std::max(mTime, this->SkeletonBindPose->GetMTime());
+  }
+  if (this->SkeletonHierarchy != nullptr)
+  {
+    mTime = std::max(mTime, this->SkeletonHierarchy->GetMTime());
+  }
+  if (this->MorphTargets != nullptr)
+  {
+    mTime = std::max(mTime, this->MorphTargets->GetMTime());
+  }
+  return mTime;
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkeletonAnimationSource::RequestInformation(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** vtkNotUsed(inputVector), vtkInformationVector* outputVector)
+{
+  vtkSkeletonAnimationStack* stack = this->SkeletonAnimationStack;
+  bool validClip = stack != nullptr && this->AnimationIndex >= 0 &&
+    this->AnimationIndex < stack->GetNumberOfAnimations();
+
+  // TimeStepsPerSecond steps (or one step per animation tick), from the clip
+  // metadata only: the clip itself is not decoded before the first RequestData
+  std::vector<double> timeSteps;
+  double timeRange[2] = { 0.0, 0.0 };
+  if (validClip)
+  {
+    double ticksPerSecond = GetTicksPerSecond(stack->GetAnimationTickPerSecond(this->AnimationIndex));
+    double duration = std::max(stack->GetAnimationDuration(this->AnimationIndex), 0.0);
+    timeRange[1] = duration / ticksPerSecond;
+
+    double stepsPerSecond = this->TimeStepsPerSecond > 0.0 ? this->TimeStepsPerSecond : ticksPerSecond;
+    int nbSteps = static_cast<int>(std::floor(timeRange[1] * stepsPerSecond + 1e-6)) + 1;
+    for (int step = 0; step < nbSteps; step++)
+    {
+      timeSteps.push_back(step / stepsPerSecond);
+    }
+  }
+
+  for (int port = 0; port < this->GetNumberOfOutputPorts(); port++)
+  {
+    vtkInformation* outInfo = outputVector->GetInformationObject(port);
+    outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+    outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_RANGE());
+    if (validClip)
+    {
+      outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_STEPS(),
+        timeSteps.data(), static_cast<int>(timeSteps.size()));
+      outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_RANGE(), timeRange, 2);
+    }
+  }
+
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkeletonAnimationSource::RequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkPolyData* input = vtkPolyData::GetData(inputVector[0]);
+  vtkPolyData* output = vtkPolyData::GetData(outputVector, 0);
+  vtkPolyData* bonesOutput = vtkPolyData::GetData(outputVector, 1);
+
+  if (input == nullptr || this->SkeletonBindPose == nullptr || this->SkeletonHierarchy == nullptr ||
+    this->SkeletonAnimationStack == nullptr)
+  {
+    vtkErrorMacro(<< "Missing input mesh, bind pose, hierarchy or animation stack.");
+    return 0;
+  }
+
+  vtkSkeletonAnimation* animation = nullptr;
+  if (this->AnimationIndex >= 0 && this->AnimationIndex < this->SkeletonAnimationStack->GetNumberOfAnimations())
+  {
+    animation = this->SkeletonAnimationStack->GetAnimation(this->AnimationIndex);
+  }
+  if (animation == nullptr)
+  {
+    vtkErrorMacro(<< "Invalid animation " << this->AnimationIndex);
+    return 0;
+  }
+
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  double time = 0.0;
+  if (outInfo->Has(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP()))
+  {
+    time = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP());
+  }
+  // The end of TIME_RANGE is the last pose of the clip, not the first one
+  double tick = time * GetTicksPerSecond(animation->GetTickPerSecond());
+  tick = std::min(std::max(tick, 0.0), std::max(animation->GetDuration(), 0.0));
+
+  // Cached results are only valid for the same inputs
+  vtkMTimeType inputsTime = std::max(this->GetMTime(), std::max(input->GetMTime(), animation->GetMTime()));
+  if (inputsTime != this->CacheTime)
+  {
+    this->Cache.clear();
+    this->CacheTime = inputsTime;
+  }
+
+  auto it = std::find_if(this->Cache.begin(), this->Cache.end(),
+    [tick](const CacheEntry& entry) { return entry.Tick == tick; });
+  if (it != this->Cache.end())
+  {
+    this->Cache.splice(this->Cache.begin(), this->Cache, it);
+  }
+  else
+  {
+    CacheEntry entry;
+    entry.Tick = tick;
+    entry.Mesh = vtkSmartPointer<vtkPolyData>::New();
+    entry.Bones = vtkSmartPointer<vtkPolyData>::New();
+    this->Evaluate(input, animation, tick, entry.Mesh, entry.Bones);
+
+    this->Cache.push_front(entry);
+    if (static_cast<int>(this->Cache.size()) > std::max(this->CacheSize, 1))
+    {
+      this->Cache.pop_back();
+    }
+  }
+
+  output->ShallowCopy(this->Cache.front().Mesh);
+  bonesOutput->ShallowCopy(this->Cache.front().Bones);
+  output->GetInformation()->Set(vtkDataObject::DATA_TIME_STEP(), time);
+  bonesOutput->GetInformation()->Set(vtkDataObject::DATA_TIME_STEP(), time);
+
+  if (this->CacheSize == 0)
+  {
+    this->Cache.clear();
+  }
+
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationSource::Evaluate(vtkPolyData* input, vtkSkeletonAnimation* animation,
+  double tick, vtkPolyData* mesh, vtkPolyData* bones)
+{
+  animation->ComputeInterpolatedPose(tick, this->LocalPose);
+  vtkSkeletonPose::ComputeGlobalPose(this->LocalPose, this->SkeletonHierarchy, this->GlobalPose);
+  vtkSkeletonPose::MultiplyToPalette(this->GlobalPose, this->SkeletonBindPose,
+    this->SkinningPose, this->SkinningPalette);
+
+  // Share everything with the input but the points and normals
+  mesh->ShallowCopy(input);
+
+  vtkDataArray* points = input->GetPoints() != nullptr ? input->GetPoints()->GetData() : nullptr;
+  vtkDataArray* normals = input->GetPointData()->GetNormals();
+  if (normals != nullptr && normals->GetNumberOfComponents() != 3)
+  {
+    normals = nullptr;
+  }
+
+  // Morph targets are applied in bind space, before skinning
+  vtkSmartPointer<vtkDataArray> morphedPoints;
+  vtkSmartPointer<vtkDataArray> morphedNormals;
+  if (points != nullptr && this->MorphTargets != nullptr && this->MorphTargets->GetNumberOfTargets() > 0)
+  {
+    size_t nbTargets = static_cast<size_t>(this->MorphTargets->GetNumberOfTargets());
+    std::vector<double> morphWeights(nbTargets, 0.0);
+    animation->ComputeMorphWeights(tick, morphWeights);
+    morphWeights.resize(nbTargets);
+
+    morphedPoints.TakeReference(vtkDataArray::CreateDataArray(points->GetDataType()));
+    if (normals != nullptr)
+    {
+      morphedNormals.TakeReference(vtkDataArray::CreateDataArray(normals->GetDataType()));
+      morphedNormals->SetName(normals->GetName());
+    }
+    if (this->MorphTargets->Apply(morphWeights, points, morphedPoints, normals, morphedNormals))
+    {
+      points = morphedPoints;
+      normals = morphedNormals;
+    }
+    else
+    {
+      vtkErrorMacro(<< "Morph targets cannot be applied to the input points.");
+    }
+  }
+
+  vtkDoubleArray* weights = vtkDoubleArray::SafeDownCast(input->GetPointData()->GetAbstractArray("Weights"));
+  vtkIntArray* boneIds = vtkIntArray::SafeDownCast(input->GetPointData()->GetAbstractArray("BoneIDs"));
+  if (points != nullptr && weights != nullptr && boneIds != nullptr)
+  {
+    vtkNew<vtkFloatArray> skinnedPointsData;
+    vtkSkeletonPose::SkinVectors(points, weights, boneIds, this->SkinningPalette, 1.0, skinnedPointsData);
+
+    vtkNew<vtkPoints> skinnedPoints;
+    skinnedPoints->SetData(skinnedPointsData);
+    mesh->SetPoints(skinnedPoints);
+
+    if (normals != nullptr)
+    {
+      vtkNew<vtkFloatArray> skinnedNormals;
+      skinnedNormals->SetName(normals->GetName());
+      vtkSkeletonPose::SkinVectors(normals, weights, boneIds, this->SkinningPalette, 0.0, skinnedNormals);
+      NormalizeVectors(skinnedNormals);
+      mesh->GetPointData()->SetNormals(skinnedNormals);
+    }
+  }
+  else if (morphedPoints != nullptr)
+  {
+    vtkNew<vtkPoints> meshPoints;
+    meshPoints->SetData(morphedPoints);
+    mesh->SetPoints(meshPoints);
+
+    if (morphedNormals != nullptr)
+    {
+      NormalizeVectors(morphedNormals);
+      mesh->GetPointData()->SetNormals(morphedNormals);
+    }
+  }
+
+  if (this->ExtractBones)
+  {
+    vtkSkeletonPose::ExtractBones(this->LocalPose, this->SkeletonHierarchy, bones);
+  }
+}
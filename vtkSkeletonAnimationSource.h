@@ -0,0 +1,139 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkeletonAnimationSource
+* @brief   vtkSkeletonAnimationSource.
+*
+* Time-aware pipeline algorithm producing a skinned mesh animated by a clip
+* of a vtkSkeletonAnimationStack, so that downstream filters can stream
+* through an animation like through any temporal dataset.
+*
+* The input is the bind mesh, with the "Weights" and "BoneIDs" point arrays
+* written by vtkAssimpImporter. The clip is advertised as TIME_STEPS
+* (TimeStepsPerSecond steps per second) and TIME_RANGE. Each request only
+* evaluates the requested UPDATE_TIME_STEP: morph targets (see
+* SetMorphTargets()), pose, palette and CPU skinning of the points and normals
+* (see vtkSkeletonPose::SkinVectors()). The output normals are normalized. The
+* last CacheSize results are kept, so that going back and forth between a few
+* times is free.
+*
+* Output port 0 is the skinned mesh. Output port 1 holds the bones as lines
+* (see vtkSkeletonPose::ExtractBones()) when ExtractBones is on.
+*/
+
+#ifndef vtkSkeletonAnimationSource_h
+#define vtkSkeletonAnimationSource_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkSmartPointer.h> // For the cache
+
+#include <list>
+#include <vector>
+
+class vtkSkeletonAnimation;
+class vtkSkeletonAnimationStack;
+class vtkSkeletonHierarchy;
+class vtkSkeletonMorphTargets;
+class vtkSkeletonPose;
+
+class VTKSKINNING_EXPORT vtkSkeletonAnimationSource : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkSkeletonAnimationSource* New();
+  vtkTypeMacro(vtkSkeletonAnimationSource, vtkPolyDataAlgorithm)
+
+  void SetSkeletonBindPose(vtkSkeletonPose* pose);
+  vtkGetMacro(SkeletonBindPose, vtkSkeletonPose*);
+
+  void SetSkeletonHierarchy(vtkSkeletonHierarchy* hierarchy);
+  vtkGetMacro(SkeletonHierarchy, vtkSkeletonHierarchy*);
+
+  void SetSkeletonAnimationStack(vtkSkeletonAnimationStack* animationStack);
+  vtkGetMacro(SkeletonAnimationStack, vtkSkeletonAnimationStack*);
+
+  /** Optional morph targets of the input, weighted by the morph channels of
+  * the clip and applied before skinning. */
+  void SetMorphTargets(vtkSkeletonMorphTargets* morphTargets);
+  vtkGetMacro(MorphTargets, vtkSkeletonMorphTargets*);
+
+  /** Clip of the stack played by the source (default 0). */
+  vtkGetMacro(AnimationIndex, int);
+  vtkSetMacro(AnimationIndex, int);
+
+  /** Number of advertised TIME_STEPS per second of the clip (default 30).
+  * 0 advertises one step per animation tick, which is a lot for clips with
+  * a high tick rate (glTF uses 1000 ticks per second). Any time in the
+  * TIME_RANGE can still be requested, times outside of it are clamped. */
+  vtkGetMacro(TimeStepsPerSecond, double);
+  vtkSetClampMacro(TimeStepsPerSecond, double, 0.0, VTK_DOUBLE_MAX);
+
+  /** Enable/Disable the bones output (port 1). Off by default. */
+  vtkGetMacro(ExtractBones, bool);
+  vtkSetMacro(ExtractBones, bool);
+  vtkBooleanMacro(ExtractBones, bool);
+
+  /** Number of evaluated times kept (default 4). 0 disables the cache. */
+  vtkGetMacro(CacheSize, int);
+  vtkSetClampMacro(CacheSize, int, 0, VTK_INT_MAX);
+
+  /** Bones output, port 1. */
+  vtkPolyData* GetBonesOutput();
+
+  /** Include the MTime of the bind pose, hierarchy and morph targets. */
+  vtkMTimeType GetMTime() override;
+
+protected:
+  vtkSkeletonAnimationSource();
+  ~vtkSkeletonAnimationSource() override;
+
+  int RequestInformation(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+  int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+
+  /** Skinned mesh and bones at the given animation tick. */
+  void Evaluate(vtkPolyData* input, vtkSkeletonAnimation* animation, double tick,
+    vtkPolyData* mesh, vtkPolyData* bones);
+
+private:
+  vtkSkeletonAnimationSource(const vtkSkeletonAnimationSource&) = delete;
+  void operator=(const vtkSkeletonAnimationSource&) = delete;
+
+  vtkSkeletonPose* SkeletonBindPose;
+  vtkSkeletonHierarchy* SkeletonHierarchy;
+  vtkSkeletonAnimationStack* SkeletonAnimationStack;
+  vtkSkeletonMorphTargets* MorphTargets;
+  int AnimationIndex;
+  double TimeStepsPerSecond;
+  bool ExtractBones;
+  int CacheSize;
+
+  // Evaluation buffers, kept between requests
+  vtkSkeletonPose* LocalPose;
+  vtkSkeletonPose* GlobalPose;
+  vtkSkeletonPose* SkinningPose;
+  std::vector<float> SkinningPalette;
+
+  struct CacheEntry
+  {
+    double Tick;
+    vtkSmartPointer<vtkPolyData> Mesh;
+    vtkSmartPointer<vtkPolyData> Bones;
+  };
+  std::list<CacheEntry> Cache; // Most recently used first
+  vtkMTimeType CacheTime; // Inputs time of the cached results
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include "vtkSkeletonAnimationStack.h"
 
 #include "vtkSkeletonAnimation.h"
+#include "vtkSkeletonAnimationLoader.h"
 
 #include <vtkObjectFactory.h> // For New macro
 
@@ -10,6 +11,9 @@ vtkStandardNewMacro(vtkSkeletonAnimationStack)
 //-----------------------------------------------------------------------------
 vtkSkeletonAnimationStack::vtkSkeletonAnimationStack()
 {
+  this->Loader = nullptr;
+  this->MemoryBudget = 0;
+  this->UseCounter = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -18,6 +22,12 @@ vtkSkeletonAnimationStack::~vtkSkeletonAnimationStack()
   this->Clear();
 }
 
+//-----------------------------------------------------------------------------
+bool vtkSkeletonAnimationStack::IsValidIndex(int index) const
+{
+  return index >= 0 && index < static_cast<int>(this->Animations.size());
+}
+
 vtkIdType vtkSkeletonAnimationStack::GetNumberOfAnimations() const
 {
   return static_cast<vtkIdType>(this->Animations.size());
@@ -25,21 +35,213 @@ vtkIdType vtkSkeletonAnimationStack::GetNumberOfAnimations() const
 
 vtkSkeletonAnimation* vtkSkeletonAnimationStack::GetAnimation(int const frame)
 {
-  return this->Animations[frame];
+  Entry& entry = this->Animations[frame];
+  entry.LastUse = ++this->UseCounter;
+
+  if (entry.Animation == nullptr)
+  {
+    if (this->Loader == nullptr)
+    {
+      vtkErrorMacro(<< "No loader to decode animation " << entry.Name);
+      return nullptr;
+    }
+
+    entry.Animation = this->Loader->LoadAnimation(frame);
+    if (entry.Animation == nullptr)
+    {
+      vtkErrorMacro(<< "Cannot decode animation " << entry.Name);
+      return nullptr;
+    }
+    entry.MemorySize = entry.Animation->GetActualMemorySize();
+
+    this->EnforceMemoryBudget(frame);
+  }
+
+  return entry.Animation;
 }
 
 void vtkSkeletonAnimationStack::InsertNextAnimation(vtkSkeletonAnimation* animation)
 {
   animation->Register(this);
 
-  this->Animations.push_back(animation);
+  Entry entry;
+  entry.Animation = animation;
+  entry.Name = animation->GetAnimationName();
+  entry.Duration = animation->GetDuration();
+  entry.TickPerSecond = animation->GetTickPerSecond();
+  entry.NumberOfKeys = animation->GetNumberOfKeys();
+  entry.Declared = false;
+  entry.MemorySize = 0;
+  entry.LastUse = 0;
+  this->Animations.push_back(entry);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationStack::InsertNextAnimationEntry(const vtkStdString& name,
+  double duration, double tickPerSecond, vtkIdType numberOfKeys)
+{
+  Entry entry;
+  entry.Animation = nullptr;
+  entry.Name = name;
+  entry.Duration = duration;
+  entry.TickPerSecond = tickPerSecond;
+  entry.NumberOfKeys = numberOfKeys;
+  entry.Declared = true;
+  entry.MemorySize = 0;
+  entry.LastUse = 0;
+  this->Animations.push_back(entry);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationStack::SetLoader(vtkSkeletonAnimationLoader* loader)
+{
+  if (this->Loader == loader)
+  {
+    return;
+  }
+
+  if (this->Loader != nullptr)
+  {
+    this->Loader->Delete();
+  }
+  if (loader != nullptr)
+  {
+    loader->Register(this);
+  }
+  this->Loader = loader;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+vtkStdString vtkSkeletonAnimationStack::GetAnimationName(int index) const
+{
+  return this->IsValidIndex(index) ? this->Animations[index].Name : vtkStdString();
+}
+
+//-----------------------------------------------------------------------------
+double vtkSkeletonAnimationStack::GetAnimationDuration(int index) const
+{
+  return this->IsValidIndex(index) ? this->Animations[index].Duration : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+double vtkSkeletonAnimationStack::GetAnimationTickPerSecond(int index) const
+{
+  return this->IsValidIndex(index) ? this->Animations[index].TickPerSecond : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonAnimationStack::GetAnimationNumberOfKeys(int index) const
+{
+  return this->IsValidIndex(index) ? this->Animations[index].NumberOfKeys : 0;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSkeletonAnimationStack::IsAnimationLoaded(int index) const
+{
+  return this->IsValidIndex(index) && this->Animations[index].Animation != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationStack::SetMemoryBudget(unsigned long budget)
+{
+  if (this->MemoryBudget == budget)
+  {
+    return;
+  }
+  this->MemoryBudget = budget;
+  this->EnforceMemoryBudget(-1);
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkSkeletonAnimationStack::GetLoadedMemorySize() const
+{
+  unsigned long size = 0;
+  for (size_t i = 0; i < this->Animations.size(); i++)
+  {
+    if (this->Animations[i].Declared && this->Animations[i].Animation != nullptr)
+    {
+      size += this->Animations[i].MemorySize;
+    }
+  }
+  return size;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationStack::EnforceMemoryBudget(int keptIndex)
+{
+  if (this->MemoryBudget == 0)
+  {
+    return;
+  }
+
+  unsigned long size = this->GetLoadedMemorySize();
+  while (size > this->MemoryBudget)
+  {
+    // Least recently used decoded clip, other than the one being accessed
+    // and the ones still referenced elsewhere
+    int lruIndex = -1;
+    for (int i = 0; i < static_cast<int>(this->Animations.size()); i++)
+    {
+      const Entry& entry = this->Animations[i];
+      if (i == keptIndex || !entry.Declared || entry.Animation == nullptr ||
+        (this->Loader != nullptr && this->Loader->IsAnimationInUse(i, entry.Animation)))
+      {
+        continue;
+      }
+      if (lruIndex == -1 || entry.LastUse < this->Animations[lruIndex].LastUse)
+      {
+        lruIndex = i;
+      }
+    }
+
+    if (lruIndex == -1)
+    {
+      return;
+    }
+
+    size -= this->Animations[lruIndex].MemorySize;
+    this->UnloadAnimation(lruIndex);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationStack::UnloadAnimation(int index)
+{
+  Entry& entry = this->Animations[index];
+  if (!entry.Declared || entry.Animation == nullptr)
+  {
+    return;
+  }
+
+  if (this->Loader != nullptr)
+  {
+    this->Loader->ReleaseAnimation(index, entry.Animation);
+  }
+  entry.Animation->Delete();
+  entry.Animation = nullptr;
+  entry.MemorySize = 0;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationStack::UnloadAnimations()
+{
+  for (int i = 0; i < static_cast<int>(this->Animations.size()); i++)
+  {
+    this->UnloadAnimation(i);
+  }
 }
 
 void vtkSkeletonAnimationStack::Clear()
 {
   for (int i = 0; i < this->Animations.size(); i++)
   {
-    this->Animations[i]->Delete();
+    if (this->Animations[i].Animation != nullptr)
+    {
+      this->Animations[i].Animation->Delete();
+    }
   }
   this->Animations.clear();
+  this->SetLoader(nullptr);
 }
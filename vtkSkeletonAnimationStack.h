@@ -17,19 +17,29 @@ PURPOSE.  See the above copyright notice for more information.
 *
 * Vector of vtkSkeletonAnimation.
 *
+* The stack is also a clip directory: clips can be declared with their name,
+* duration and key count only, and decoded by a vtkSkeletonAnimationLoader on
+* first access. Decoded declared clips are kept within a memory budget, the
+* least recently used ones being evicted (and decoded again when needed).
+* Clips inserted with InsertNextAnimation() are never evicted, nor are the
+* clips still referenced elsewhere (see
+* vtkSkeletonAnimationLoader::IsAnimationInUse()): the budget may then be
+* exceeded until they are released.
 */
 
 #ifndef vtkSkeletonAnimationStack_h
 #define vtkSkeletonAnimationStack_h
 
+#include "vtkSkinningModule.h" // For export macro
 #include <vtkObject.h>
 #include <vtkStdString.h>
 
 #include <vector>
 
 class vtkSkeletonAnimation;
+class vtkSkeletonAnimationLoader;
 
-class vtkSkeletonAnimationStack : public vtkObject
+class VTKSKINNING_EXPORT vtkSkeletonAnimationStack : public vtkObject
 {
 public:
   static vtkSkeletonAnimationStack* New();
@@ -38,10 +48,41 @@ public:
   /** The number of keyframes */
   vtkIdType GetNumberOfAnimations() const;
 
+  /** Return the clip at the given index, decoding it if needed.
+  * The stack keeps the reference: a decoded clip can be evicted by the next
+  * call, Register() it to hold it longer. */
   vtkSkeletonAnimation* GetAnimation(int index);
 
   void InsertNextAnimation(vtkSkeletonAnimation* animation);
 
+  /** Declare a clip decoded by the loader on first access. */
+  void InsertNextAnimationEntry(const vtkStdString& name, double duration,
+    double tickPerSecond, vtkIdType numberOfKeys);
+
+  /** Decoder of the declared clips. */
+  void SetLoader(vtkSkeletonAnimationLoader* loader);
+  vtkGetMacro(Loader, vtkSkeletonAnimationLoader*);
+
+  /** Directory information, available without decoding the clip. */
+  vtkStdString GetAnimationName(int index) const;
+  double GetAnimationDuration(int index) const;
+  double GetAnimationTickPerSecond(int index) const;
+  vtkIdType GetAnimationNumberOfKeys(int index) const;
+
+  /** Whether the clip is currently decoded. */
+  bool IsAnimationLoaded(int index) const;
+
+  /** Memory budget of the decoded declared clips, in kibibytes.
+  * 0 (default) means unlimited. */
+  vtkGetMacro(MemoryBudget, unsigned long);
+  void SetMemoryBudget(unsigned long budget);
+
+  /** Memory used by the decoded declared clips, in kibibytes. */
+  unsigned long GetLoadedMemorySize() const;
+
+  /** Release the decoded declared clips. */
+  void UnloadAnimations();
+
   /** Empty the structure */
   void Clear();
 
@@ -53,8 +94,28 @@ private:
   vtkSkeletonAnimationStack(const vtkSkeletonAnimationStack&) = delete;
   void operator=(const vtkSkeletonAnimationStack&) = delete;
 
+  struct Entry
+  {
+    vtkSkeletonAnimation* Animation; // nullptr while not decoded
+    vtkStdString Name;
+    double Duration;
+    double TickPerSecond;
+    vtkIdType NumberOfKeys;
+    bool Declared; // decoded by the loader, can be evicted
+    unsigned long MemorySize; // kibibytes, when decoded
+    unsigned long LastUse;
+  };
+
+  /** Evict least recently used declared clips until the budget is met. */
+  void EnforceMemoryBudget(int keptIndex);
+  void UnloadAnimation(int index);
+  bool IsValidIndex(int index) const;
+
   /** Internal data */
-  std::vector<vtkSkeletonAnimation*> Animations;
+  std::vector<Entry> Animations;
+  vtkSkeletonAnimationLoader* Loader;
+  unsigned long MemoryBudget;
+  unsigned long UseCounter;
 
 };
 
@@ -0,0 +1,111 @@
+#include "vtkSkeletonAnimationUpdater.h"
+
+#include "vtkSkeletonPolyDataMapper.h"
+
+#include <vtkActor.h>
+#include <vtkActorCollection.h>
+#include <vtkObjectFactory.h> // For New macro
+#include <vtkRenderer.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+
+namespace
+{
+// Evaluates the prepared poses of a range of mappers
+struct PoseEvaluator
+{
+  vtkSkeletonPolyDataMapper* const* Mappers;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      this->Mappers[i]->EvaluateSkinningPose();
+    }
+  }
+};
+}
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSkeletonAnimationUpdater)
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationUpdater::vtkSkeletonAnimationUpdater()
+{
+  this->Parallel = true;
+  this->NumberOfMappers = 0;
+  this->NumberOfEvaluatedMappers = 0;
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonAnimationUpdater::~vtkSkeletonAnimationUpdater()
+{
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationUpdater::Update(vtkRenderer* renderer)
+{
+  std::vector<vtkSkeletonPolyDataMapper*> mappers;
+
+  if (renderer != nullptr)
+  {
+    vtkActorCollection* actors = renderer->GetActors();
+    vtkCollectionSimpleIterator it;
+    actors->InitTraversal(it);
+    while (vtkActor* actor = actors->GetNextActor(it))
+    {
+      if (!actor->GetVisibility())
+      {
+        continue;
+      }
+
+      vtkSkeletonPolyDataMapper* mapper = vtkSkeletonPolyDataMapper::SafeDownCast(actor->GetMapper());
+      if (mapper != nullptr)
+      {
+        mappers.push_back(mapper);
+      }
+    }
+  }
+
+  this->Update(mappers);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonAnimationUpdater::Update(const std::vector<vtkSkeletonPolyDataMapper*>& mappers)
+{
+  // A mapper shared by several actors is evaluated once
+  std::vector<vtkSkeletonPolyDataMapper*> uniqueMappers(mappers);
+  std::sort(uniqueMappers.begin(), uniqueMappers.end());
+  uniqueMappers.erase(std::unique(uniqueMappers.begin(), uniqueMappers.end()), uniqueMappers.end());
+
+  // Serial part: clips and hierarchies may be shared between mappers
+  std::vector<vtkSkeletonPolyDataMapper*> pendingMappers;
+  for (size_t i = 0; i < uniqueMappers.size(); i++)
+  {
+    if (uniqueMappers[i] != nullptr && uniqueMappers[i]->PrepareSkinningPose())
+    {
+      pendingMappers.push_back(uniqueMappers[i]);
+    }
+  }
+
+  this->NumberOfMappers = static_cast<vtkIdType>(uniqueMappers.size());
+  this->NumberOfEvaluatedMappers = static_cast<vtkIdType>(pendingMappers.size());
+
+  if (pendingMappers.empty())
+  {
+    return;
+  }
+
+  PoseEvaluator evaluator;
+  evaluator.Mappers = pendingMappers.data();
+  if (this->Parallel && pendingMappers.size() > 1)
+  {
+    // One character per task, the backend balances the uneven rig sizes
+    vtkSMPTools::For(0, this->NumberOfEvaluatedMappers, 1, evaluator);
+  }
+  else
+  {
+    evaluator(0, this->NumberOfEvaluatedMappers);
+  }
+}
@@ -0,0 +1,79 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkeletonAnimationUpdater
+* @brief   vtkSkeletonAnimationUpdater.
+*
+* Animation update phase for scenes with many skinned characters.
+* Without it, each vtkSkeletonPolyDataMapper evaluates its pose inside its own
+* render call, one character after the other on the render thread.
+*
+* Update() gathers the vtkSkeletonPolyDataMapper of the visible actors of a
+* renderer, prepares their pose on the calling thread (clip decoding, shared
+* hierarchy caches), then evaluates all the poses in parallel with vtkSMPTools,
+* one task per character. Key lookups of large rigs are also split in bone
+* ranges (see vtkSkeletonPolyDataMapper::SetParallelBoneThreshold()).
+* The mappers then render with their palette already packed for upload.
+*
+* Should be called before each render, and before vtkSkeletonLODManager::Update()
+* so that the skinned bounds used for level selection are already evaluated.
+*/
+
+#ifndef vtkSkeletonAnimationUpdater_h
+#define vtkSkeletonAnimationUpdater_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkObject.h>
+
+#include <vector>
+
+class vtkRenderer;
+class vtkSkeletonPolyDataMapper;
+
+class VTKSKINNING_EXPORT vtkSkeletonAnimationUpdater : public vtkObject
+{
+public:
+  static vtkSkeletonAnimationUpdater* New();
+  vtkTypeMacro(vtkSkeletonAnimationUpdater, vtkObject)
+
+  /** Enable/Disable the parallel evaluation. When disabled, poses are still
+  * evaluated before rendering but one after the other. On by default. */
+  vtkGetMacro(Parallel, bool);
+  vtkSetMacro(Parallel, bool);
+  vtkBooleanMacro(Parallel, bool);
+
+  /** Evaluate the poses of the skinned mappers of the visible actors of the renderer. */
+  void Update(vtkRenderer* renderer);
+
+  /** Evaluate the poses of the given mappers. */
+  void Update(const std::vector<vtkSkeletonPolyDataMapper*>& mappers);
+
+  /** Statistics of the last Update(). */
+  vtkGetMacro(NumberOfMappers, vtkIdType);
+  vtkGetMacro(NumberOfEvaluatedMappers, vtkIdType);
+
+protected:
+  vtkSkeletonAnimationUpdater();
+  ~vtkSkeletonAnimationUpdater() override;
+
+private:
+  vtkSkeletonAnimationUpdater(const vtkSkeletonAnimationUpdater&) = delete;
+  void operator=(const vtkSkeletonAnimationUpdater&) = delete;
+
+  bool Parallel;
+  vtkIdType NumberOfMappers;
+  vtkIdType NumberOfEvaluatedMappers;
+};
+
+#endif
@@ -7,6 +7,8 @@
 #include <vtkIntArray.h>
 #include <vtkStringArray.h>
 
+#include <algorithm>
+
 //-----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSkeletonHierarchy)
 
@@ -23,6 +25,8 @@ vtkSkeletonHierarchy::vtkSkeletonHierarchy()
   this->NodeHierarchy->SetNumberOfComponents(1);
 
   this->NodeTransforms = vtkSkeletonPose::New();
+
+  this->CollapseStaticNodes = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -39,6 +43,7 @@ vtkSkeletonHierarchy::~vtkSkeletonHierarchy()
 void vtkSkeletonHierarchy::InsertNextParentId(int const parent_id)
 {
 	this->NodeHierarchy->InsertNextTuple1(parent_id);
+  this->Modified();
 }
 
 //-----------------------------------------------------------------------------
@@ -50,11 +55,224 @@ int vtkSkeletonHierarchy::GetNumberOfNodes() const
 //-----------------------------------------------------------------------------
 int vtkSkeletonHierarchy::GetParentId(int const index) const
 {
-	return this->NodeHierarchy->GetTuple1(index);
+	return this->NodeHierarchy->GetValue(index);
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonHierarchy::GetNodeBoneId(vtkIdType nodeId) const
+{
+  return this->NodeTypes->GetValue(nodeId);
 }
 
 //-----------------------------------------------------------------------------
 void vtkSkeletonHierarchy::SetParentId(vtkIdType index, vtkIdType parentId)
 {
   this->NodeHierarchy->SetTuple1(index, parentId);
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+vtkMTimeType vtkSkeletonHierarchy::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  mTime = std::max(mTime, this->NodeHierarchy->GetMTime());
+  mTime = std::max(mTime, this->NodeTypes->GetMTime());
+  mTime = std::max(mTime, this->NodeTransforms->GetMTime());
+  return mTime;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonHierarchy::SetCollapseStaticNodes(bool collapse)
+{
+  if (this->CollapseStaticNodes == collapse)
+  {
+    return;
+  }
+  this->CollapseStaticNodes = collapse;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+const std::vector<vtkSkeletonHierarchy::EvaluationNode>& vtkSkeletonHierarchy::GetEvaluationNodes()
+{
+  if (this->EvaluationNodesTime < this->GetMTime())
+  {
+    this->BuildEvaluationNodes();
+  }
+  return this->EvaluationNodes;
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonHierarchy::GetBoneEvaluationIndex(vtkIdType boneId)
+{
+  this->GetEvaluationNodes();
+  if (boneId < 0 || boneId >= static_cast<vtkIdType>(this->BoneEvaluationIndices.size()))
+  {
+    return -1;
+  }
+  return this->BoneEvaluationIndices[boneId];
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonHierarchy::BuildEvaluationNodes()
+{
+  vtkIdType nbNodes = this->GetNumberOfNodes();
+
+  this->EvaluationNodes.clear();
+  this->EvaluationNodes.reserve(nbNodes);
+
+  // Children lists, keeping the node order
+  std::vector<std::vector<vtkIdType> > children(nbNodes);
+  std::vector<vtkIdType> roots;
+  for (vtkIdType nodeId = 0; nodeId < nbNodes; nodeId++)
+  {
+    vtkIdType parentId = this->GetParentId(nodeId);
+    if (parentId < 0 || parentId >= nbNodes)
+    {
+      roots.push_back(nodeId);
+    }
+    else
+    {
+      children[parentId].push_back(nodeId);
+    }
+  }
+
+  // Depth-first traversal: (node, parent evaluation index)
+  std::vector<std::pair<vtkIdType, vtkIdType> > stack;
+  for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+  {
+    stack.push_back(std::make_pair(*it, static_cast<vtkIdType>(-1)));
+  }
+
+  while (!stack.empty())
+  {
+    vtkIdType nodeId = stack.back().first;
+    vtkIdType parentIndex = stack.back().second;
+    stack.pop_back();
+
+    vtkIdType boneId = this->NodeTypes->GetValue(nodeId);
+
+    EvaluationNode node;
+    node.NodeId = nodeId;
+    node.ParentIndex = parentIndex;
+    node.BoneId = boneId;
+    // Roots are global transforms: their node transform is used even for bones
+    node.LocalTransformId = parentIndex == -1 ? -1 : boneId;
+    node.SubtreeEnd = -1;
+    node.HasOffset = false;
+    vtkSkeletonPose::GetIdentityTransform(node.Offset);
+    node.OffsetScale[0] = node.OffsetScale[1] = node.OffsetScale[2] = 1.0;
+
+    vtkIdType index = static_cast<vtkIdType>(this->EvaluationNodes.size());
+    this->EvaluationNodes.push_back(node);
+
+    const std::vector<vtkIdType>& nodeChildren = children[nodeId];
+    for (auto it = nodeChildren.rbegin(); it != nodeChildren.rend(); ++it)
+    {
+      stack.push_back(std::make_pair(*it, index));
+    }
+  }
+
+  if (this->CollapseStaticNodes)
+  {
+    this->CollapseEvaluationNodes();
+  }
+
+  vtkIdType nbEvaluationNodes = static_cast<vtkIdType>(this->EvaluationNodes.size());
+
+  // Evaluation nodes receiving a local transform from the pose
+  this->BoneEvaluationIndices.clear();
+  for (vtkIdType index = 0; index < nbEvaluationNodes; index++)
+  {
+    const EvaluationNode& node = this->EvaluationNodes[index];
+    if (node.LocalTransformId < 0)
+    {
+      continue;
+    }
+    if (node.LocalTransformId >= static_cast<vtkIdType>(this->BoneEvaluationIndices.size()))
+    {
+      this->BoneEvaluationIndices.resize(node.LocalTransformId + 1, -1);
+    }
+    this->BoneEvaluationIndices[node.LocalTransformId] = index;
+  }
+
+  // Subtree ranges: a subtree ends where the parent subtree continues
+  for (vtkIdType index = nbEvaluationNodes - 1; index >= 0; index--)
+  {
+    EvaluationNode& node = this->EvaluationNodes[index];
+    if (node.SubtreeEnd == -1)
+    {
+      node.SubtreeEnd = index + 1;
+    }
+    if (node.ParentIndex != -1)
+    {
+      EvaluationNode& parent = this->EvaluationNodes[node.ParentIndex];
+      parent.SubtreeEnd = std::max(parent.SubtreeEnd, node.SubtreeEnd);
+    }
+  }
+
+  this->EvaluationNodesTime.Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonHierarchy::CollapseEvaluationNodes()
+{
+  std::vector<EvaluationNode> nodes;
+  nodes.swap(this->EvaluationNodes);
+
+  // For each node, the nearest kept ancestor (or itself) in the collapsed table
+  // and the static transform from that ancestor to the node. Without kept
+  // ancestor, the static transform is the node global transform.
+  std::vector<vtkIdType> anchors(nodes.size(), -1);
+  std::vector<double> anchorOffsets(7 * nodes.size());
+  std::vector<double> anchorOffsetScales(3 * nodes.size(), 1.0);
+
+  double identity[7];
+  vtkSkeletonPose::GetIdentityTransform(identity);
+  const double unitScale[3] = { 1.0, 1.0, 1.0 };
+
+  for (size_t index = 0; index < nodes.size(); index++)
+  {
+    const EvaluationNode& node = nodes[index];
+
+    vtkIdType parentAnchor = -1;
+    const double* parentOffset = identity;
+    const double* parentOffsetScale = unitScale;
+    bool hasParentOffset = false;
+    if (node.ParentIndex != -1)
+    {
+      parentAnchor = anchors[node.ParentIndex];
+      parentOffset = &anchorOffsets[7 * node.ParentIndex];
+      parentOffsetScale = &anchorOffsetScales[3 * node.ParentIndex];
+      hasParentOffset = nodes[node.ParentIndex].BoneId == -1;
+    }
+
+    double* offset = &anchorOffsets[7 * index];
+    double* offsetScale = &anchorOffsetScales[3 * index];
+    if (node.BoneId != -1)
+    {
+      EvaluationNode collapsedNode = node;
+      collapsedNode.ParentIndex = parentAnchor;
+      collapsedNode.SubtreeEnd = -1;
+      collapsedNode.HasOffset = hasParentOffset;
+      std::copy(parentOffset, parentOffset + 7, collapsedNode.Offset);
+      std::copy(parentOffsetScale, parentOffsetScale + 3, collapsedNode.OffsetScale);
+
+      anchors[index] = static_cast<vtkIdType>(this->EvaluationNodes.size());
+      this->EvaluationNodes.push_back(collapsedNode);
+      std::copy(identity, identity + 7, offset);
+      std::copy(unitScale, unitScale + 3, offsetScale);
+    }
+    else
+    {
+      double nodeTransform[7];
+      double nodeScale[3];
+      this->NodeTransforms->GetTransform(node.NodeId, nodeTransform);
+      this->NodeTransforms->GetScale(node.NodeId, nodeScale);
+
+      anchors[index] = parentAnchor;
+      vtkSkeletonPose::ComposeTransform(parentOffset, parentOffsetScale, nodeTransform, nodeScale,
+        offset, offsetScale);
+    }
+  }
 }
@@ -26,12 +26,25 @@ PURPOSE.  See the above copyright notice for more information.
 * of the bone in the skeleton poses.
 *
 * Node transforms are needed when computing the model global pose.
+*
+* Global poses are evaluated from a table of evaluation nodes (see
+* GetEvaluationNodes()), sorted depth-first so that parents come before their
+* children and each subtree is a contiguous range. This allows recomputing only
+* the subtrees of modified bones (see vtkSkeletonPose::UpdateGlobalPose).
+*
+* Non-bone nodes are not animated and only use their constant node transform.
+* When CollapseStaticNodes is on, chains of such nodes (e.g. $AssimpFbx$ pivot
+* helpers, static groups) are folded into a constant offset of their bone
+* descendants, so that the evaluation table only contains bones. The node
+* arrays are left untouched and keep describing the full hierarchy.
 */
 
 #ifndef vtkSkeletonHierarchy_h
 #define vtkSkeletonHierarchy_h
 
+#include "vtkSkinningModule.h" // For export macro
 #include "vtkObject.h"
+#include "vtkTimeStamp.h" // For EvaluationNodesTime
 
 #include <map>
 #include <vector>
@@ -42,7 +55,7 @@ class vtkStringArray;
 
 class vtkSkeletonPose;
 
-class vtkSkeletonHierarchy : public vtkObject
+class VTKSKINNING_EXPORT vtkSkeletonHierarchy : public vtkObject
 {
 public:
   static vtkSkeletonHierarchy* New();
@@ -60,6 +73,38 @@ public:
 	/** Number of bones in the structure */
 	int GetNumberOfNodes() const;
 
+  /** Bone of a node, -1 if the node is not a bone. */
+  vtkIdType GetNodeBoneId(vtkIdType nodeId) const;
+
+  /** Include the MTime of the internal arrays. */
+  vtkMTimeType GetMTime() override;
+
+  /** Entry of the global pose evaluation table. */
+  struct EvaluationNode
+  {
+    vtkIdType NodeId; // Node of the hierarchy
+    vtkIdType ParentIndex; // Index of the parent evaluation node, -1 for roots
+    vtkIdType LocalTransformId; // Bone providing the local transform, -1 to use the node transform
+    vtkIdType BoneId; // Bone receiving the global transform, -1 if none
+    vtkIdType SubtreeEnd; // Index past the last evaluation node of the subtree
+    bool HasOffset; // Whether Offset must be applied before the local transform
+    double Offset[7]; // Collapsed static transforms between the parent and the node
+    double OffsetScale[3]; // Scale of Offset, see vtkSkeletonPose
+  };
+
+  /** Fold chains of non-bone nodes in the evaluation table. Off by default. */
+  void SetCollapseStaticNodes(bool collapse);
+  vtkGetMacro(CollapseStaticNodes, bool);
+  vtkBooleanMacro(CollapseStaticNodes, bool);
+
+  /** Evaluation table, rebuilt when the hierarchy is modified.
+  * Not reentrant when a rebuild is needed: call it once from a single thread
+  * before sharing the hierarchy between threads. */
+  const std::vector<EvaluationNode>& GetEvaluationNodes();
+
+  /** Index of the evaluation node whose local transform is given by a bone, -1 if none. */
+  vtkIdType GetBoneEvaluationIndex(vtkIdType boneId);
+
   vtkGetMacro(NodeNames, vtkStringArray*);
   vtkGetMacro(NodeHierarchy, vtkIdTypeArray*);
   vtkGetMacro(NodeTypes, vtkIdTypeArray*);
@@ -73,12 +118,20 @@ private:
 	vtkSkeletonHierarchy(const vtkSkeletonHierarchy&) = delete;
 	void operator=(const vtkSkeletonHierarchy&) = delete;
 
+  void BuildEvaluationNodes();
+  void CollapseEvaluationNodes();
+
 	/** Internal storage of the parent id */
   vtkStringArray* NodeNames;
   vtkIdTypeArray* NodeTypes;
   vtkIdTypeArray* NodeHierarchy;
 
   vtkSkeletonPose* NodeTransforms;
+
+  bool CollapseStaticNodes;
+  std::vector<EvaluationNode> EvaluationNodes;
+  std::vector<vtkIdType> BoneEvaluationIndices;
+  vtkTimeStamp EvaluationNodesTime;
 };
 
 #endif
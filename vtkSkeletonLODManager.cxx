@@ -0,0 +1,631 @@
+#include "vtkSkeletonLODManager.h"
+
+#include "vtkSkeletonHierarchy.h"
+#include "vtkSkeletonMorphTargets.h"
+#include "vtkSkeletonPolyDataMapper.h"
+#include "vtkSkeletonPose.h"
+
+#include <vtkActor.h>
+#include <vtkCamera.h>
+#include <vtkDataArray.h>
+#include <vtkDecimatePro.h>
+#include <vtkIdTypeArray.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h> // For New macro
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+#include <vtkSmartPointer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+// Input point ids of the points of the decimated level meshes
+const char* ORIGINAL_POINT_IDS = "vtkOriginalPointIds";
+}
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSkeletonLODManager)
+
+//-----------------------------------------------------------------------------
+vtkSkeletonLODManager::vtkSkeletonLODManager()
+{
+  this->SelectionMode = SCREEN_SIZE;
+  this->FrustumCulling = true;
+  this->CulledPoseUpdateInterval = 8;
+  this->CulledCount = 0;
+
+  // Full detail level
+  Level level = { 0.0, 0.0, 0, 1 };
+  this->Levels.push_back(level);
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonLODManager::~vtkSkeletonLODManager()
+{
+  this->RemoveAllInstances();
+
+  for (auto it = this->LevelMeshes.begin(); it != this->LevelMeshes.end(); ++it)
+  {
+    this->ClearLevelMeshes(it->second);
+    it->first.first->Delete();
+    it->first.second->Delete();
+  }
+  this->LevelMeshes.clear();
+
+  for (auto it = this->LevelMorphTargets.begin(); it != this->LevelMorphTargets.end(); ++it)
+  {
+    it->second.first->Delete();
+    it->first.first->Delete();
+  }
+  this->LevelMorphTargets.clear();
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkeletonLODManager::AddLevel(double threshold, double targetReduction,
+  int numberOfDroppedBoneLevels, int poseUpdateInterval)
+{
+  if (!this->Instances.empty())
+  {
+    vtkErrorMacro(<< "Levels must be added before the instances.");
+    return -1;
+  }
+
+  Level level;
+  level.Threshold = threshold;
+  level.TargetReduction = std::min(std::max(targetReduction, 0.0), 1.0);
+  level.NumberOfDroppedBoneLevels = std::max(numberOfDroppedBoneLevels, 0);
+  level.PoseUpdateInterval = std::max(poseUpdateInterval, 1);
+  this->Levels.push_back(level);
+
+  this->Modified();
+  return static_cast<int>(this->Levels.size()) - 1;
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkeletonLODManager::GetNumberOfLevels() const
+{
+  return static_cast<int>(this->Levels.size());
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkeletonLODManager::GetNumberOfInstances() const
+{
+  return static_cast<int>(this->Instances.size());
+}
+
+//-----------------------------------------------------------------------------
+std::vector<vtkIdType> vtkSkeletonLODManager::ComputeBoneReplacements(
+  vtkSkeletonHierarchy* hierarchy, vtkIdType nbBones, int numberOfDroppedBoneLevels)
+{
+  std::vector<vtkIdType> replacements(nbBones);
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+  {
+    replacements[boneId] = boneId;
+  }
+
+  if (hierarchy == nullptr || numberOfDroppedBoneLevels <= 0)
+  {
+    return replacements;
+  }
+
+  vtkIdTypeArray* nodeTypes = hierarchy->GetNodeTypes();
+
+  // Node of each bone
+  std::vector<vtkIdType> boneNodes(nbBones, -1);
+  for (vtkIdType nodeId = 0; nodeId < hierarchy->GetNumberOfNodes(); nodeId++)
+  {
+    vtkIdType boneId = nodeTypes->GetValue(nodeId);
+    if (boneId >= 0 && boneId < nbBones)
+    {
+      boneNodes[boneId] = nodeId;
+    }
+  }
+
+  // Nearest bone ancestor of each bone
+  std::vector<vtkIdType> boneParents(nbBones, -1);
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+  {
+    if (boneNodes[boneId] == -1)
+    {
+      continue;
+    }
+
+    vtkIdType parentId = hierarchy->GetParentId(boneNodes[boneId]);
+    while (parentId != -1 && nodeTypes->GetValue(parentId) == -1)
+    {
+      parentId = hierarchy->GetParentId(parentId);
+    }
+
+    if (parentId != -1 && nodeTypes->GetValue(parentId) < nbBones)
+    {
+      boneParents[boneId] = nodeTypes->GetValue(parentId);
+    }
+  }
+
+  // Height of each bone above its deepest descendant, leaves being 0
+  std::vector<int> heights(nbBones, 0);
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+  {
+    int height = 1;
+    for (vtkIdType ancestorId = boneParents[boneId]; ancestorId != -1;
+         ancestorId = boneParents[ancestorId], height++)
+    {
+      heights[ancestorId] = std::max(heights[ancestorId], height);
+    }
+  }
+
+  // Dropped bones are replaced by their nearest kept ancestor. Root bones are always kept.
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+  {
+    vtkIdType replacementId = boneId;
+    while (heights[replacementId] < numberOfDroppedBoneLevels && boneParents[replacementId] != -1)
+    {
+      replacementId = boneParents[replacementId];
+    }
+    replacements[boneId] = replacementId;
+  }
+
+  return replacements;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonLODManager::ClearLevelMeshes(LevelMeshSet& meshSet)
+{
+  for (size_t level = 0; level < meshSet.Meshes.size(); level++)
+  {
+    vtkPolyData* mesh = meshSet.Meshes[level];
+    if (mesh == nullptr)
+    {
+      continue;
+    }
+
+    // A new mesh could be allocated at the same address
+    for (auto it = this->LevelMorphTargets.begin(); it != this->LevelMorphTargets.end();)
+    {
+      if (it->first.second == mesh)
+      {
+        it->second.first->Delete();
+        it->first.first->Delete();
+        it = this->LevelMorphTargets.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+    mesh->Delete();
+  }
+  meshSet.Meshes.clear();
+}
+
+//-----------------------------------------------------------------------------
+vtkPolyData* vtkSkeletonLODManager::GetLevelMesh(vtkPolyData* input,
+  vtkSkeletonHierarchy* hierarchy, vtkIdType nbBones, int level)
+{
+  MeshKey key(input, hierarchy);
+  auto it = this->LevelMeshes.find(key);
+  if (it == this->LevelMeshes.end())
+  {
+    input->Register(this);
+    hierarchy->Register(this);
+    LevelMeshSet meshSet;
+    meshSet.InputTime = input->GetMTime();
+    it = this->LevelMeshes.insert(std::make_pair(key, meshSet)).first;
+  }
+  else if (it->second.InputTime != input->GetMTime())
+  {
+    this->ClearLevelMeshes(it->second);
+    it->second.InputTime = input->GetMTime();
+  }
+
+  std::vector<vtkPolyData*>& meshes = it->second.Meshes;
+  if (meshes.size() < this->Levels.size())
+  {
+    meshes.resize(this->Levels.size(), nullptr);
+  }
+  if (meshes[level] != nullptr)
+  {
+    return meshes[level];
+  }
+
+  const Level& config = this->Levels[level];
+
+  vtkPolyData* mesh = vtkPolyData::New();
+  if (config.TargetReduction > 0.0)
+  {
+    // Decimation keeps a subset of the input points with their attributes,
+    // including their input ids, used to renumber the morph targets
+    vtkNew<vtkIdTypeArray> originalPointIds;
+    originalPointIds->SetName(ORIGINAL_POINT_IDS);
+    originalPointIds->SetNumberOfTuples(input->GetNumberOfPoints());
+    for (vtkIdType pointId = 0; pointId < input->GetNumberOfPoints(); pointId++)
+    {
+      originalPointIds->SetValue(pointId, pointId);
+    }
+
+    vtkNew<vtkPolyData> decimateInput;
+    decimateInput->ShallowCopy(input);
+    decimateInput->GetPointData()->AddArray(originalPointIds);
+
+    vtkNew<vtkDecimatePro> decimate;
+    decimate->SetInputData(decimateInput);
+    decimate->SetTargetReduction(config.TargetReduction);
+    decimate->PreserveTopologyOn();
+    decimate->Update();
+    mesh->ShallowCopy(decimate->GetOutput());
+  }
+  else
+  {
+    mesh->ShallowCopy(input);
+  }
+
+  // Bind the vertices of the dropped bones to their kept ancestors
+  vtkDataArray* boneIDs = mesh->GetPointData()->GetArray("BoneIDs");
+  if (config.NumberOfDroppedBoneLevels > 0 && boneIDs != nullptr)
+  {
+    std::vector<vtkIdType> replacements =
+      vtkSkeletonLODManager::ComputeBoneReplacements(hierarchy, nbBones, config.NumberOfDroppedBoneLevels);
+
+    vtkSmartPointer<vtkDataArray> levelBoneIDs = vtkSmartPointer<vtkDataArray>::Take(boneIDs->NewInstance());
+    levelBoneIDs->DeepCopy(boneIDs);
+
+    for (vtkIdType pointId = 0; pointId < levelBoneIDs->GetNumberOfTuples(); pointId++)
+    {
+      for (int k = 0; k < levelBoneIDs->GetNumberOfComponents(); k++)
+      {
+        vtkIdType boneId = static_cast<vtkIdType>(levelBoneIDs->GetComponent(pointId, k));
+        if (boneId >= 0 && boneId < nbBones)
+        {
+          levelBoneIDs->SetComponent(pointId, k, replacements[boneId]);
+        }
+      }
+    }
+    mesh->GetPointData()->AddArray(levelBoneIDs);
+  }
+
+  meshes[level] = mesh;
+  return mesh;
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonMorphTargets* vtkSkeletonLODManager::GetLevelMorphTargets(
+  vtkSkeletonMorphTargets* morphTargets, vtkPolyData* input, vtkPolyData* mesh)
+{
+  vtkIdTypeArray* originalPointIds =
+    vtkIdTypeArray::SafeDownCast(mesh->GetPointData()->GetArray(ORIGINAL_POINT_IDS));
+  if (originalPointIds == nullptr)
+  {
+    // Not decimated: same points as the input
+    return morphTargets;
+  }
+
+  MorphTargetsKey key(morphTargets, mesh);
+  auto it = this->LevelMorphTargets.find(key);
+  if (it == this->LevelMorphTargets.end())
+  {
+    morphTargets->Register(this);
+    it = this->LevelMorphTargets.insert(
+      std::make_pair(key, std::make_pair(vtkSkeletonMorphTargets::New(), vtkMTimeType(0)))).first;
+  }
+  if (it->second.second == morphTargets->GetMTime())
+  {
+    return it->second.first;
+  }
+
+  // Input points removed by the decimation are dropped from the targets
+  std::vector<vtkIdType> newPointIds(input->GetNumberOfPoints(), -1);
+  for (vtkIdType pointId = 0; pointId < originalPointIds->GetNumberOfTuples(); pointId++)
+  {
+    newPointIds[originalPointIds->GetValue(pointId)] = pointId;
+  }
+
+  vtkSkeletonMorphTargets* levelMorphTargets = it->second.first;
+  levelMorphTargets->DeepCopy(morphTargets);
+  levelMorphTargets->RenumberPoints(newPointIds);
+  it->second.second = morphTargets->GetMTime();
+
+  return levelMorphTargets;
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkeletonLODManager::AddInstance(vtkActor* actor)
+{
+  vtkSkeletonPolyDataMapper* mapper =
+    actor != nullptr ? vtkSkeletonPolyDataMapper::SafeDownCast(actor->GetMapper()) : nullptr;
+  if (mapper == nullptr || mapper->GetInput() == nullptr)
+  {
+    vtkErrorMacro(<< "Instances must be actors with an input vtkSkeletonPolyDataMapper.");
+    return -1;
+  }
+
+  Instance instance;
+  instance.Actor = actor;
+  instance.PoseUpdateInterval = mapper->GetPoseUpdateInterval();
+  instance.Level = 0;
+  instance.Culled = false;
+
+  actor->Register(this);
+  mapper->Register(this);
+  instance.Mappers.push_back(mapper);
+
+  vtkPolyData* input = mapper->GetInput();
+  vtkSkeletonHierarchy* hierarchy = mapper->GetSkeletonHierarchy();
+  vtkIdType nbBones = mapper->GetSkeletonBindPose()->GetNumberOfTransforms();
+
+  for (int level = 1; level < this->GetNumberOfLevels(); level++)
+  {
+    const Level& config = this->Levels[level];
+
+    vtkSkeletonPolyDataMapper* levelMapper = vtkSkeletonPolyDataMapper::New();
+    levelMapper->ShallowCopy(mapper);
+    levelMapper->SetInputData(this->GetLevelMesh(input, hierarchy, nbBones, level));
+    levelMapper->SetSkeletonHierarchy(hierarchy);
+    levelMapper->SetSkeletonBindPose(mapper->GetSkeletonBindPose());
+    levelMapper->SetSkeletonAnimationStack(mapper->GetSkeletonAnimationStack());
+    levelMapper->SetAnimationBlend(mapper->GetAnimationBlend());
+    levelMapper->SetProfiler(mapper->GetProfiler());
+    if (mapper->GetMorphTargets() != nullptr)
+    {
+      levelMapper->SetMorphTargets(this->GetLevelMorphTargets(mapper->GetMorphTargets(),
+        input, levelMapper->GetInput()));
+    }
+    for (vtkIdType materialId = 0; materialId < mapper->GetNumberOfMaterials(); materialId++)
+    {
+      levelMapper->InsertNextMaterial(mapper->GetMaterial(materialId));
+    }
+    levelMapper->SetPoseUpdateInterval(config.PoseUpdateInterval);
+
+    if (config.NumberOfDroppedBoneLevels > 0)
+    {
+      std::vector<vtkIdType> replacements =
+        vtkSkeletonLODManager::ComputeBoneReplacements(hierarchy, nbBones, config.NumberOfDroppedBoneLevels);
+
+      std::vector<unsigned char> activeBones(nbBones);
+      for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+      {
+        activeBones[boneId] = replacements[boneId] == boneId ? 1 : 0;
+      }
+      levelMapper->SetActiveBones(activeBones);
+    }
+
+    instance.Mappers.push_back(levelMapper);
+  }
+
+  this->Instances.push_back(instance);
+  this->Modified();
+  return static_cast<int>(this->Instances.size()) - 1;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonLODManager::UpdateLevelMapperInput(Instance& instance, int level)
+{
+  vtkSkeletonPolyDataMapper* mapper = instance.Mappers[0];
+  vtkSkeletonPolyDataMapper* levelMapper = instance.Mappers[level];
+  vtkPolyData* input = mapper->GetInput();
+  vtkSkeletonHierarchy* hierarchy = mapper->GetSkeletonHierarchy();
+  if (input == nullptr || hierarchy == nullptr)
+  {
+    return;
+  }
+
+  vtkPolyData* mesh = this->GetLevelMesh(input, hierarchy,
+    mapper->GetSkeletonBindPose()->GetNumberOfTransforms(), level);
+  if (levelMapper->GetInput() == mesh)
+  {
+    return;
+  }
+
+  levelMapper->SetInputData(mesh);
+  if (mapper->GetMorphTargets() != nullptr)
+  {
+    levelMapper->SetMorphTargets(this->GetLevelMorphTargets(mapper->GetMorphTargets(), input, mesh));
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonLODManager::RemoveAllInstances()
+{
+  if (this->Instances.empty())
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < this->Instances.size(); i++)
+  {
+    Instance& instance = this->Instances[i];
+    vtkSkeletonPolyDataMapper* mapper = instance.Mappers[0];
+
+    if (instance.Actor->GetMapper() != mapper)
+    {
+      instance.Actor->SetMapper(mapper);
+    }
+    if (instance.Culled)
+    {
+      instance.Actor->VisibilityOn();
+    }
+    mapper->SetPoseUpdateInterval(instance.PoseUpdateInterval);
+
+    for (size_t level = 0; level < instance.Mappers.size(); level++)
+    {
+      instance.Mappers[level]->Delete();
+    }
+    instance.Actor->Delete();
+  }
+  this->Instances.clear();
+  this->LevelCounts.clear();
+  this->CulledCount = 0;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonLODManager::Update(vtkRenderer* renderer)
+{
+  if (renderer == nullptr)
+  {
+    return;
+  }
+
+  vtkCamera* camera = renderer->GetActiveCamera();
+
+  double frustumPlanes[24];
+  camera->GetFrustumPlanes(renderer->GetTiledAspectRatio(), frustumPlanes);
+
+  double cameraPosition[3];
+  camera->GetPosition(cameraPosition);
+  double tanHalfViewAngle = std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2.0);
+
+  this->LevelCounts.assign(this->Levels.size(), 0);
+  this->CulledCount = 0;
+
+  for (size_t i = 0; i < this->Instances.size(); i++)
+  {
+    Instance& instance = this->Instances[i];
+    vtkSkeletonPolyDataMapper* mapper = instance.Mappers[0];
+
+    // Skinned bounds of the current level, evaluating its pose if needed
+    vtkSkeletonPolyDataMapper* currentMapper =
+      vtkSkeletonPolyDataMapper::SafeDownCast(instance.Actor->GetMapper());
+    if (currentMapper == nullptr)
+    {
+      currentMapper = mapper;
+    }
+    if (currentMapper != mapper)
+    {
+      currentMapper->CopyAnimationState(mapper);
+    }
+
+    double* bounds = instance.Actor->GetBounds();
+    if (bounds == nullptr || !vtkMath::AreBoundsInitialized(bounds))
+    {
+      continue;
+    }
+
+    double center[3];
+    double radius = 0.0;
+    for (int j = 0; j < 3; j++)
+    {
+      center[j] = 0.5 * (bounds[2 * j] + bounds[2 * j + 1]);
+      radius += 0.25 * (bounds[2 * j + 1] - bounds[2 * j]) * (bounds[2 * j + 1] - bounds[2 * j]);
+    }
+    radius = std::sqrt(radius);
+
+    // Bounding sphere against the inward facing frustum planes
+    bool culled = false;
+    for (int plane = 0; plane < 6 && this->FrustumCulling; plane++)
+    {
+      const double* p = frustumPlanes + 4 * plane;
+      if (p[0] * center[0] + p[1] * center[1] + p[2] * center[2] + p[3] < -radius)
+      {
+        culled = true;
+        break;
+      }
+    }
+
+    if (culled)
+    {
+      if (!instance.Culled)
+      {
+        instance.Actor->VisibilityOff();
+        instance.Culled = true;
+      }
+      currentMapper->SetPoseUpdateInterval(this->CulledPoseUpdateInterval);
+      instance.Level = -1;
+      this->CulledCount++;
+      continue;
+    }
+
+    if (instance.Culled)
+    {
+      instance.Actor->VisibilityOn();
+      instance.Culled = false;
+    }
+
+    // Level selection
+    double metric = 0.0;
+    if (this->SelectionMode == DISTANCE)
+    {
+      metric = std::sqrt(vtkMath::Distance2BetweenPoints(center, cameraPosition));
+    }
+    else if (camera->GetParallelProjection())
+    {
+      metric = radius / camera->GetParallelScale();
+    }
+    else
+    {
+      double distance = std::sqrt(vtkMath::Distance2BetweenPoints(center, cameraPosition));
+      metric = distance > radius ?
+        radius / (distance * tanHalfViewAngle) : std::numeric_limits<double>::max();
+    }
+
+    int level = 0;
+    for (int l = 1; l < this->GetNumberOfLevels(); l++)
+    {
+      bool coarser = this->SelectionMode == DISTANCE ?
+        metric > this->Levels[l].Threshold : metric < this->Levels[l].Threshold;
+      if (coarser)
+      {
+        level = l;
+      }
+    }
+
+    vtkSkeletonPolyDataMapper* levelMapper = instance.Mappers[level];
+    if (levelMapper != mapper)
+    {
+      this->UpdateLevelMapperInput(instance, level);
+      levelMapper->CopyAnimationState(mapper);
+    }
+    levelMapper->SetPoseUpdateInterval(
+      level == 0 ? instance.PoseUpdateInterval : this->Levels[level].PoseUpdateInterval);
+    if (instance.Actor->GetMapper() != levelMapper)
+    {
+      instance.Actor->SetMapper(levelMapper);
+    }
+
+    instance.Level = level;
+    this->LevelCounts[level]++;
+  }
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkeletonLODManager::GetInstanceLevel(int instance) const
+{
+  if (instance < 0 || instance >= static_cast<int>(this->Instances.size()))
+  {
+    return -1;
+  }
+  return this->Instances[instance].Level;
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonLODManager::GetNumberOfInstancesAtLevel(int level) const
+{
+  if (level < 0 || level >= static_cast<int>(this->LevelCounts.size()))
+  {
+    return 0;
+  }
+  return this->LevelCounts[level];
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonLODManager::GetNumberOfCulledInstances() const
+{
+  return this->CulledCount;
+}
+
+//-----------------------------------------------------------------------------
+std::string vtkSkeletonLODManager::GetSummary() const
+{
+  std::ostringstream summary;
+  for (int level = 0; level < this->GetNumberOfLevels(); level++)
+  {
+    summary << "Level " << level << ": " << this->GetNumberOfInstancesAtLevel(level) << " instances\n";
+  }
+  summary << "Culled: " << this->CulledCount << " instances\n";
+  return summary.str();
+}
@@ -0,0 +1,192 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkeletonLODManager
+* @brief   vtkSkeletonLODManager.
+*
+* Level of detail selection for many skinned instances (crowds).
+* Each instance is an actor rendered by a vtkSkeletonPolyDataMapper. Levels are
+* added coarser and coarser, level 0 being the full detail mapper. A level
+* combines:
+* - a mesh decimated once when the instance is added, and again when the input
+*   is modified (meshes are shared between instances of the same input). The
+*   morph targets of the mapper are renumbered to the points kept by the
+*   decimation,
+* - a number of dropped leaf bone levels: vertices of the dropped bones are
+*   bound to their nearest kept ancestor and the dropped bones are not sampled,
+* - a pose update interval (e.g. every 4th animation step). Level 0 keeps the
+*   interval of the original mapper, restored when the instances are removed.
+*
+* Update() selects the level of each instance from its projected size or its
+* distance to the camera, and swaps the actor mapper accordingly. Instances
+* whose skinned bounds are outside the view frustum are hidden and their pose
+* is only evaluated every CulledPoseUpdateInterval steps, to detect when they
+* come back into view.
+*/
+
+#ifndef vtkSkeletonLODManager_h
+#define vtkSkeletonLODManager_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkObject.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class vtkActor;
+class vtkPolyData;
+class vtkRenderer;
+class vtkSkeletonHierarchy;
+class vtkSkeletonMorphTargets;
+class vtkSkeletonPolyDataMapper;
+
+class VTKSKINNING_EXPORT vtkSkeletonLODManager : public vtkObject
+{
+public:
+  enum SelectionModes { SCREEN_SIZE = 0, DISTANCE };
+
+  static vtkSkeletonLODManager* New();
+  vtkTypeMacro(vtkSkeletonLODManager, vtkObject)
+
+  /** How level thresholds are interpreted (default SCREEN_SIZE).
+  * SCREEN_SIZE: a level is used when the instance bounding sphere covers less
+  * than threshold times the viewport height.
+  * DISTANCE: a level is used when the instance is further than threshold. */
+  vtkGetMacro(SelectionMode, int);
+  vtkSetClampMacro(SelectionMode, int, SCREEN_SIZE, DISTANCE);
+
+  /** Add a level coarser than the previous ones and return its index.
+  * targetReduction is the fraction of triangles removed from the mesh,
+  * numberOfDroppedBoneLevels the number of leaf bone levels dropped from the
+  * skeleton and poseUpdateInterval the number of animation steps between two
+  * pose evaluations. Levels must be added before the instances. */
+  int AddLevel(double threshold, double targetReduction,
+    int numberOfDroppedBoneLevels, int poseUpdateInterval);
+
+  /** Number of levels, including the full detail level 0. */
+  int GetNumberOfLevels() const;
+
+  /** Enable/Disable frustum culling of the instances. On by default. */
+  vtkGetMacro(FrustumCulling, bool);
+  vtkSetMacro(FrustumCulling, bool);
+  vtkBooleanMacro(FrustumCulling, bool);
+
+  /** Pose update interval of the culled instances (default 8). */
+  vtkGetMacro(CulledPoseUpdateInterval, int);
+  vtkSetClampMacro(CulledPoseUpdateInterval, int, 1, VTK_INT_MAX);
+
+  /** Add an actor whose mapper is a vtkSkeletonPolyDataMapper and build its
+  * level mappers. Returns the instance index, -1 on error. */
+  int AddInstance(vtkActor* actor);
+
+  /** Restore the original mappers and visibility of the instances and remove them. */
+  void RemoveAllInstances();
+
+  int GetNumberOfInstances() const;
+
+  /** Select the level of each instance for the active camera of the renderer.
+  * Should be called before each render. */
+  void Update(vtkRenderer* renderer);
+
+  /** Level of an instance at the last Update(), -1 if culled. */
+  int GetInstanceLevel(int instance) const;
+
+  /** Statistics of the last Update(). */
+  vtkIdType GetNumberOfInstancesAtLevel(int level) const;
+  vtkIdType GetNumberOfCulledInstances() const;
+
+  /** Human readable statistics of the last Update(). */
+  std::string GetSummary() const;
+
+protected:
+  vtkSkeletonLODManager();
+  ~vtkSkeletonLODManager() override;
+
+  /** Bone ids replacing each bone of the hierarchy when dropping the given
+  * number of leaf levels. Kept bones are mapped to themselves. */
+  static std::vector<vtkIdType> ComputeBoneReplacements(vtkSkeletonHierarchy* hierarchy,
+    vtkIdType nbBones, int numberOfDroppedBoneLevels);
+
+  /** Mesh of a level, built once per input and skeleton, and rebuilt when
+  * the input is modified. */
+  vtkPolyData* GetLevelMesh(vtkPolyData* input, vtkSkeletonHierarchy* hierarchy,
+    vtkIdType nbBones, int level);
+
+  /** Morph targets of a level mesh built from input, with its point ids.
+  * Built once per level mesh and morph targets modification. */
+  vtkSkeletonMorphTargets* GetLevelMorphTargets(vtkSkeletonMorphTargets* morphTargets,
+    vtkPolyData* input, vtkPolyData* mesh);
+
+private:
+  vtkSkeletonLODManager(const vtkSkeletonLODManager&) = delete;
+  void operator=(const vtkSkeletonLODManager&) = delete;
+
+  struct Level
+  {
+    double Threshold;
+    double TargetReduction;
+    int NumberOfDroppedBoneLevels;
+    int PoseUpdateInterval;
+  };
+
+  struct Instance
+  {
+    vtkActor* Actor;
+    // One mapper per level, the first one being the original mapper
+    std::vector<vtkSkeletonPolyDataMapper*> Mappers;
+    // Pose update interval of the original mapper, used at level 0 and
+    // restored when the instance is removed
+    int PoseUpdateInterval;
+    int Level; // -1 when culled
+    bool Culled;
+  };
+
+  // Level meshes of an input, with the input time they were built from
+  struct LevelMeshSet
+  {
+    std::vector<vtkPolyData*> Meshes;
+    vtkMTimeType InputTime;
+  };
+
+  typedef std::pair<vtkPolyData*, vtkSkeletonHierarchy*> MeshKey;
+  typedef std::pair<vtkSkeletonMorphTargets*, vtkPolyData*> MorphTargetsKey;
+
+  /** Release the level meshes of a set and the morph targets built for them. */
+  void ClearLevelMeshes(LevelMeshSet& meshSet);
+
+  /** Set the level mesh (and morph targets) of a level mapper of an instance,
+  * after the input of its original mapper was modified. */
+  void UpdateLevelMapperInput(Instance& instance, int level);
+
+  int SelectionMode;
+  bool FrustumCulling;
+  int CulledPoseUpdateInterval;
+
+  std::vector<Level> Levels;
+  std::vector<Instance> Instances;
+
+  // Level meshes (level 1 and above) shared between instances of the same input
+  std::map<MeshKey, LevelMeshSet> LevelMeshes;
+
+  // Morph targets renumbered for the decimated level meshes, with the time of
+  // the morph targets they were built from
+  std::map<MorphTargetsKey, std::pair<vtkSkeletonMorphTargets*, vtkMTimeType> > LevelMorphTargets;
+
+  std::vector<vtkIdType> LevelCounts;
+  vtkIdType CulledCount;
+};
+
+#endif
@@ -0,0 +1,266 @@
+#include "vtkSkeletonMorphTargets.h"
+
+#include <vtkDataArray.h>
+#include <vtkObjectFactory.h> // For New macro
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+// Below this weight, a target is considered inactive
+const double MinimumWeight = 1e-6;
+
+// Sparse accumulation of the deltas of a target into a 3 components buffer
+template <typename T>
+void AccumulateDeltas(T* values, const std::vector<vtkIdType>& pointIds,
+  const std::vector<float>& deltas, float weight)
+{
+  const vtkIdType* ids = pointIds.data();
+  const float* d = deltas.data();
+  size_t nbPoints = pointIds.size();
+  for (size_t i = 0; i < nbPoints; i++, d += 3)
+  {
+    T* value = values + 3 * ids[i];
+    value[0] += static_cast<T>(weight * d[0]);
+    value[1] += static_cast<T>(weight * d[1]);
+    value[2] += static_cast<T>(weight * d[2]);
+  }
+}
+
+// Copy base into output, with the same type and size
+void CopyBaseValues(vtkDataArray* base, vtkDataArray* output)
+{
+  if (output->GetDataType() != base->GetDataType())
+  {
+    output->DeepCopy(base);
+    return;
+  }
+
+  output->SetNumberOfComponents(base->GetNumberOfComponents());
+  output->SetNumberOfTuples(base->GetNumberOfTuples());
+  std::memcpy(output->GetVoidPointer(0), base->GetVoidPointer(0),
+    base->GetNumberOfValues() * base->GetDataTypeSize());
+}
+}
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSkeletonMorphTargets)
+
+//-----------------------------------------------------------------------------
+vtkSkeletonMorphTargets::vtkSkeletonMorphTargets()
+{
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonMorphTargets::~vtkSkeletonMorphTargets()
+{
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSkeletonMorphTargets::IsValidTarget(vtkIdType target) const
+{
+  return target >= 0 && target < static_cast<vtkIdType>(this->Targets.size());
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonMorphTargets::InsertNextTarget(const vtkStdString& name)
+{
+  Target target;
+  target.Name = name;
+  this->Targets.push_back(target);
+
+  this->Modified();
+  return static_cast<vtkIdType>(this->Targets.size()) - 1;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonMorphTargets::InsertNextTargetDelta(vtkIdType targetId, vtkIdType pointId,
+  const double delta[3], const double* normalDelta)
+{
+  if (!this->IsValidTarget(targetId))
+  {
+    vtkErrorMacro(<< "Invalid morph target " << targetId);
+    return;
+  }
+
+  Target& target = this->Targets[targetId];
+  target.PointIds.push_back(pointId);
+  for (int i = 0; i < 3; i++)
+  {
+    target.Deltas.push_back(static_cast<float>(delta[i]));
+  }
+
+  // Normal deltas are either empty or aligned with the position deltas
+  if (normalDelta != nullptr)
+  {
+    target.NormalDeltas.resize(target.Deltas.size() - 3, 0.0f);
+    for (int i = 0; i < 3; i++)
+    {
+      target.NormalDeltas.push_back(static_cast<float>(normalDelta[i]));
+    }
+  }
+  else if (!target.NormalDeltas.empty())
+  {
+    target.NormalDeltas.resize(target.Deltas.size(), 0.0f);
+  }
+
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonMorphTargets::GetNumberOfTargets() const
+{
+  return static_cast<vtkIdType>(this->Targets.size());
+}
+
+//-----------------------------------------------------------------------------
+vtkStdString vtkSkeletonMorphTargets::GetTargetName(vtkIdType target) const
+{
+  return this->IsValidTarget(target) ? this->Targets[target].Name : vtkStdString();
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonMorphTargets::FindTarget(const vtkStdString& name) const
+{
+  for (size_t i = 0; i < this->Targets.size(); i++)
+  {
+    if (this->Targets[i].Name == name)
+    {
+      return static_cast<vtkIdType>(i);
+    }
+  }
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonMorphTargets::GetNumberOfTargetPoints(vtkIdType target) const
+{
+  return this->IsValidTarget(target) ?
+    static_cast<vtkIdType>(this->Targets[target].PointIds.size()) : 0;
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonMorphTargets::GetNumberOfDeltas() const
+{
+  vtkIdType nbDeltas = 0;
+  for (size_t i = 0; i < this->Targets.size(); i++)
+  {
+    nbDeltas += static_cast<vtkIdType>(this->Targets[i].PointIds.size());
+  }
+  return nbDeltas;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonMorphTargets::RenumberPoints(const std::vector<vtkIdType>& newPointIds)
+{
+  for (size_t t = 0; t < this->Targets.size(); t++)
+  {
+    Target& target = this->Targets[t];
+    bool hasNormals = !target.NormalDeltas.empty();
+
+    // Compact the kept points in place
+    size_t nbKept = 0;
+    for (size_t i = 0; i < target.PointIds.size(); i++)
+    {
+      vtkIdType newPointId = newPointIds[target.PointIds[i]];
+      if (newPointId < 0)
+      {
+        continue;
+      }
+
+      target.PointIds[nbKept] = newPointId;
+      std::copy(&target.Deltas[3 * i], &target.Deltas[3 * i] + 3, &target.Deltas[3 * nbKept]);
+      if (hasNormals)
+      {
+        std::copy(&target.NormalDeltas[3 * i], &target.NormalDeltas[3 * i] + 3, &target.NormalDeltas[3 * nbKept]);
+      }
+      nbKept++;
+    }
+
+    target.PointIds.resize(nbKept);
+    target.Deltas.resize(3 * nbKept);
+    if (hasNormals)
+    {
+      target.NormalDeltas.resize(3 * nbKept);
+    }
+  }
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonMorphTargets::DeepCopy(vtkSkeletonMorphTargets* source)
+{
+  if (source == nullptr || source == this)
+  {
+    return;
+  }
+  this->Targets = source->Targets;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonMorphTargets::Clear()
+{
+  if (this->Targets.empty())
+  {
+    return;
+  }
+  this->Targets.clear();
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSkeletonMorphTargets::Apply(const std::vector<double>& weights,
+  vtkDataArray* basePoints, vtkDataArray* outputPoints,
+  vtkDataArray* baseNormals, vtkDataArray* outputNormals) const
+{
+  if (basePoints == nullptr || outputPoints == nullptr || basePoints->GetNumberOfComponents() != 3)
+  {
+    return false;
+  }
+
+  bool applyNormals = baseNormals != nullptr && outputNormals != nullptr &&
+    baseNormals->GetNumberOfComponents() == 3;
+
+  CopyBaseValues(basePoints, outputPoints);
+  if (applyNormals)
+  {
+    CopyBaseValues(baseNormals, outputNormals);
+  }
+
+  size_t nbTargets = std::min(weights.size(), this->Targets.size());
+  for (size_t t = 0; t < nbTargets; t++)
+  {
+    if (std::abs(weights[t]) < MinimumWeight)
+    {
+      continue;
+    }
+
+    const Target& target = this->Targets[t];
+    float weight = static_cast<float>(weights[t]);
+
+    switch (outputPoints->GetDataType())
+    {
+      vtkTemplateMacro(AccumulateDeltas(static_cast<VTK_TT*>(outputPoints->GetVoidPointer(0)),
+        target.PointIds, target.Deltas, weight));
+    }
+
+    if (applyNormals && !target.NormalDeltas.empty())
+    {
+      switch (outputNormals->GetDataType())
+      {
+        vtkTemplateMacro(AccumulateDeltas(static_cast<VTK_TT*>(outputNormals->GetVoidPointer(0)),
+          target.PointIds, target.NormalDeltas, weight));
+      }
+    }
+  }
+
+  outputPoints->Modified();
+  if (applyNormals)
+  {
+    outputNormals->Modified();
+  }
+  return true;
+}
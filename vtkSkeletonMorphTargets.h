@@ -0,0 +1,104 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkeletonMorphTargets
+* @brief   vtkSkeletonMorphTargets.
+*
+* Morph targets (blend shapes) of a mesh, stored as sparse vertex deltas:
+* each target only keeps the ids of the points it displaces, with their
+* position delta (and normal delta when available), so that a face rig with
+* hundreds of targets on a large mesh stays small.
+*
+* Apply() adds the weighted deltas of the targets with a non-zero weight to
+* the base points and normals. Targets are applied to the mesh in bind space,
+* before skinning.
+*/
+
+#ifndef vtkSkeletonMorphTargets_h
+#define vtkSkeletonMorphTargets_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkObject.h>
+#include <vtkStdString.h>
+
+#include <vector>
+
+class vtkDataArray;
+
+class VTKSKINNING_EXPORT vtkSkeletonMorphTargets : public vtkObject
+{
+public:
+  static vtkSkeletonMorphTargets* New();
+  vtkTypeMacro(vtkSkeletonMorphTargets, vtkObject)
+
+  /** Add an empty target and return its index. */
+  vtkIdType InsertNextTarget(const vtkStdString& name);
+
+  /** Add the displacement of a point to a target. normalDelta can be null. */
+  void InsertNextTargetDelta(vtkIdType target, vtkIdType pointId,
+    const double delta[3], const double* normalDelta = nullptr);
+
+  vtkIdType GetNumberOfTargets() const;
+  vtkStdString GetTargetName(vtkIdType target) const;
+
+  /** Index of the first target with the given name, -1 if not found. */
+  vtkIdType FindTarget(const vtkStdString& name) const;
+
+  /** Number of points displaced by a target. */
+  vtkIdType GetNumberOfTargetPoints(vtkIdType target) const;
+
+  /** Total number of stored deltas, over all targets. */
+  vtkIdType GetNumberOfDeltas() const;
+
+  /** Renumber the points of all targets: pointId becomes newPointIds[pointId].
+  * Points mapped to a negative id are removed from the targets. */
+  void RenumberPoints(const std::vector<vtkIdType>& newPointIds);
+
+  /** Copy the targets of another instance. */
+  void DeepCopy(vtkSkeletonMorphTargets* source);
+
+  /** Remove all the targets. */
+  void Clear();
+
+  /** Base points plus the weighted deltas of the targets. weights has one entry
+  * per target (missing entries are zero). outputPoints (and outputNormals) are
+  * resized and typed like basePoints (and baseNormals). Normal deltas are
+  * skipped if baseNormals or outputNormals is null. Returns false, without
+  * touching the outputs, if the base or output points are missing or the base
+  * points do not have 3 components. */
+  bool Apply(const std::vector<double>& weights, vtkDataArray* basePoints, vtkDataArray* outputPoints,
+    vtkDataArray* baseNormals = nullptr, vtkDataArray* outputNormals = nullptr) const;
+
+protected:
+  vtkSkeletonMorphTargets();
+  ~vtkSkeletonMorphTargets() override;
+
+  bool IsValidTarget(vtkIdType target) const;
+
+private:
+  vtkSkeletonMorphTargets(const vtkSkeletonMorphTargets&) = delete;
+  void operator=(const vtkSkeletonMorphTargets&) = delete;
+
+  struct Target
+  {
+    vtkStdString Name;
+    std::vector<vtkIdType> PointIds;
+    std::vector<float> Deltas; // 3 values per point
+    std::vector<float> NormalDeltas; // 3 values per point, empty if no normals
+  };
+
+  std::vector<Target> Targets;
+};
+
+#endif
@@ -0,0 +1,164 @@
+#include "vtkSkeletonOverlay.h"
+
+#include "vtkSkeletonHierarchy.h"
+#include "vtkSkeletonPolyDataMapper.h"
+#include "vtkSkeletonPose.h"
+
+#include <vtkActor.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h> // For New macro
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSkeletonOverlay)
+
+//-----------------------------------------------------------------------------
+vtkSkeletonOverlay::vtkSkeletonOverlay()
+{
+  this->Mapper = nullptr;
+  this->Output = vtkPolyData::New();
+  this->TopologyTime = 0;
+  this->PointsTime = 0;
+
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputData(this->Output);
+  mapper->ScalarVisibilityOff();
+
+  this->Actor = vtkActor::New();
+  this->Actor->SetMapper(mapper);
+  this->Actor->PickableOff();
+  this->Actor->GetProperty()->SetColor(1.0, 0.8, 0.2);
+  this->Actor->GetProperty()->SetLineWidth(2.0);
+  this->Actor->GetProperty()->SetPointSize(4.0);
+  this->Actor->GetProperty()->LightingOff();
+}
+
+//-----------------------------------------------------------------------------
+vtkSkeletonOverlay::~vtkSkeletonOverlay()
+{
+  this->SetMapper(nullptr);
+  this->Actor->Delete();
+  this->Output->Delete();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonOverlay::SetMapper(vtkSkeletonPolyDataMapper* mapper)
+{
+  if (this->Mapper == mapper)
+  {
+    return;
+  }
+
+  if (this->Mapper != nullptr)
+  {
+    this->Mapper->Delete();
+  }
+  if (mapper != nullptr)
+  {
+    mapper->Register(this);
+  }
+  this->Mapper = mapper;
+  this->TopologyTime = 0;
+  this->PointsTime = 0;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonOverlay::Update()
+{
+  if (this->Mapper == nullptr || this->Mapper->GetSkeletonHierarchy() == nullptr ||
+    this->Mapper->GetSkeletonBindPose() == nullptr)
+  {
+    return;
+  }
+
+  // Does nothing when the render already evaluated the current pose
+  this->Mapper->UpdateSkinningPose();
+
+  vtkSkeletonHierarchy* hierarchy = this->Mapper->GetSkeletonHierarchy();
+  vtkIdType nbBones = this->Mapper->GetSkeletonBindPose()->GetNumberOfTransforms();
+  if (this->TopologyTime != hierarchy->GetMTime() || this->Output->GetPoints() == nullptr ||
+    this->Output->GetNumberOfPoints() != nbBones)
+  {
+    this->BuildTopology();
+    this->TopologyTime = hierarchy->GetMTime();
+    this->PointsTime = 0;
+  }
+
+  vtkSkeletonPose* globalPose = this->Mapper->GetGlobalPose();
+  if (globalPose->GetNumberOfTransforms() < nbBones || this->PointsTime == globalPose->GetMTime())
+  {
+    return;
+  }
+
+  vtkFloatArray* points = vtkFloatArray::SafeDownCast(this->Output->GetPoints()->GetData());
+  float* coordinates = points->GetPointer(0);
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+  {
+    double position[3];
+    globalPose->GetPosition(boneId, position);
+    coordinates[3 * boneId] = static_cast<float>(position[0]);
+    coordinates[3 * boneId + 1] = static_cast<float>(position[1]);
+    coordinates[3 * boneId + 2] = static_cast<float>(position[2]);
+  }
+  points->Modified();
+  this->Output->GetPoints()->Modified();
+
+  this->PointsTime = globalPose->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonOverlay::BuildTopology()
+{
+  vtkSkeletonHierarchy* hierarchy = this->Mapper->GetSkeletonHierarchy();
+  vtkIdType nbBones = this->Mapper->GetSkeletonBindPose()->GetNumberOfTransforms();
+
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToFloat();
+  points->SetNumberOfPoints(nbBones);
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+  {
+    points->SetPoint(boneId, 0.0, 0.0, 0.0);
+  }
+
+  vtkNew<vtkCellArray> lines;
+  vtkNew<vtkCellArray> verts;
+  for (vtkIdType nodeId = 0; nodeId < hierarchy->GetNumberOfNodes(); nodeId++)
+  {
+    vtkIdType boneId = hierarchy->GetNodeBoneId(nodeId);
+    if (boneId < 0 || boneId >= nbBones)
+    {
+      continue;
+    }
+
+    // Closest bone ancestor, skipping the non-bone nodes in between
+    vtkIdType parentBoneId = -1;
+    for (vtkIdType parent = hierarchy->GetParentId(nodeId); parent != -1 && parentBoneId == -1;
+      parent = hierarchy->GetParentId(parent))
+    {
+      parentBoneId = hierarchy->GetNodeBoneId(parent);
+    }
+
+    if (parentBoneId >= 0 && parentBoneId < nbBones)
+    {
+      lines->InsertNextCell(2);
+      lines->InsertCellPoint(parentBoneId);
+      lines->InsertCellPoint(boneId);
+    }
+    else
+    {
+      verts->InsertNextCell(1);
+      verts->InsertCellPoint(boneId);
+    }
+  }
+
+  this->Output->Initialize();
+  this->Output->SetPoints(points);
+  this->Output->SetLines(lines);
+  this->Output->SetVerts(verts);
+}
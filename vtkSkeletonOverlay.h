@@ -0,0 +1,79 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkeletonOverlay
+* @brief   vtkSkeletonOverlay.
+*
+* Lines showing the bones of the pose rendered by a vtkSkeletonPolyDataMapper.
+*
+* The output has one point per bone and one line between each bone and its
+* closest bone ancestor in the hierarchy. The lines are only built when the
+* hierarchy or the number of bones change. Update() then only rewrites the
+* point coordinates from the global pose of the mapper (see
+* vtkSkeletonPolyDataMapper::GetGlobalPose()), when it changed: the pose is
+* the one evaluated for the rendering, it is not recomputed.
+*
+* Call Update() before each render, e.g. from a renderer StartEvent observer.
+* The output is drawn by GetActor().
+*/
+
+#ifndef vtkSkeletonOverlay_h
+#define vtkSkeletonOverlay_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkObject.h>
+
+class vtkActor;
+class vtkPolyData;
+class vtkSkeletonPolyDataMapper;
+
+class VTKSKINNING_EXPORT vtkSkeletonOverlay : public vtkObject
+{
+public:
+  static vtkSkeletonOverlay* New();
+  vtkTypeMacro(vtkSkeletonOverlay, vtkObject)
+
+  /** Mapper providing the hierarchy and the global pose. */
+  void SetMapper(vtkSkeletonPolyDataMapper* mapper);
+  vtkGetMacro(Mapper, vtkSkeletonPolyDataMapper*);
+
+  /** Bring the output up to date with the current pose of the mapper. */
+  void Update();
+
+  /** Bones as lines. */
+  vtkGetMacro(Output, vtkPolyData*);
+
+  /** Actor drawing the output. */
+  vtkGetMacro(Actor, vtkActor*);
+
+protected:
+  vtkSkeletonOverlay();
+  ~vtkSkeletonOverlay() override;
+
+  /** Build the points and lines of the bones. */
+  void BuildTopology();
+
+private:
+  vtkSkeletonOverlay(const vtkSkeletonOverlay&) = delete;
+  void operator=(const vtkSkeletonOverlay&) = delete;
+
+  vtkSkeletonPolyDataMapper* Mapper;
+  vtkPolyData* Output;
+  vtkActor* Actor;
+
+  vtkMTimeType TopologyTime; // Hierarchy time of the lines
+  vtkMTimeType PointsTime; // Global pose time of the points
+};
+
+#endif
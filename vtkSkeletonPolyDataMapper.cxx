@@ -1,7 +1,12 @@
 #include "vtkSkeletonPolyDataMapper.h"
 
+#include "vtkBoundingBox.h"
+#include "vtkCellArray.h"
 #include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkMath.h"
 #include "vtkMatrix4x4.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h" // For New macro
 #include "vtkOpenGLTexture.h"
 #include "vtkOpenGLVertexArrayObject.h"
@@ -9,10 +14,14 @@
 #include "vtkOpenGLVertexBufferObjectGroup.h"
 #include "vtkOpenGLIndexBufferObject.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
 #include "vtkPolyData.h"
 #include "vtkProperty.h"
 #include "vtkRenderer.h"
 #include "vtkShaderProgram.h"
+#include "vtkSMPTools.h"
+
+#include "vtk_glew.h"
 
 #include "vtkCallbackCommand.h"
 #include "vtkRenderWindowInteractor.h"
@@ -20,13 +29,85 @@
 
 #include "vtkMaterial.h"
 #include "vtkSkeletonAnimation.h"
+#include "vtkSkeletonAnimationBlend.h"
 #include "vtkSkeletonAnimationStack.h"
 #include "vtkSkeletonHierarchy.h"
+#include "vtkSkeletonMorphTargets.h"
 #include "vtkSkeletonPose.h"
+#include "vtkSkinningProfiler.h"
 
+#include <algorithm>
+#include <cmath>
+#include <map>
 #include <set>
 #include <sstream>
 
+namespace
+{
+// Samples the local transform of the bones of a range, into 7 values per bone,
+// and 3 scale values per bone when Scales is not null.
+// Only reads the (immutable) animation, so ranges can be sampled concurrently.
+struct BoneSampler
+{
+  const vtkSkeletonAnimation* Animation;
+  double Time;
+  const std::vector<unsigned char>* ActiveBones; // null means all bones
+  double* Transforms;
+  double* Scales;
+
+  bool AnimatedOnly; // Bones without keys keep their previous (rest) transform
+
+  bool IsSampled(vtkIdType boneId) const
+  {
+    if (this->AnimatedOnly && !this->Animation->IsNodeAnimated(boneId))
+    {
+      return false;
+    }
+    return this->ActiveBones == nullptr ||
+      boneId >= static_cast<vtkIdType>(this->ActiveBones->size()) || (*this->ActiveBones)[boneId];
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType boneId = begin; boneId < end; boneId++)
+    {
+      if (this->IsSampled(boneId))
+      {
+        double* transform = this->Transforms + 7 * boneId;
+        if (this->Scales != nullptr)
+        {
+          this->Animation->SampleNodeTransform(boneId, this->Time, transform, transform + 3,
+            this->Scales + 3 * boneId);
+        }
+        else
+        {
+          this->Animation->SampleNodeTransform(boneId, this->Time, transform, transform + 3);
+        }
+      }
+    }
+  }
+};
+
+// Size of a uniform array holding count elements. Sizes are rounded up to a few
+// buckets so that mappers with slightly different bone or material counts
+// generate the same shader source and share the compiled program.
+size_t GetShaderArraySize(size_t count)
+{
+  if (count > 64)
+  {
+    // Multiples of 32 above 64 to stay within the uniform limits
+    return (count + 31) / 32 * 32;
+  }
+
+  size_t size = 1;
+  while (size < count)
+  {
+    size *= 2;
+  }
+  return size;
+}
+}
+
 ////-----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSkeletonPolyDataMapper)
 
@@ -39,12 +120,47 @@ vtkSkeletonPolyDataMapper::vtkSkeletonPolyDataMapper()
 
   this->Frame = 0;
   this->CurrentAnimationIndex = 0;
+  this->AnimationBlend = nullptr;
 
   this->AnimationCallbackCommand = vtkCallbackCommand::New();
   this->AnimationCallbackCommand->SetCallback(vtkSkeletonPolyDataMapper::UpdateAnimationCallback);
   this->AnimationCallbackCommand->SetClientData(this);
 
+  this->Profiler = vtkSkinningProfiler::New();
+
+  this->AnimationPose = vtkSkeletonPose::New();
+  this->NodeGlobalPose = vtkSkeletonPose::New();
+  this->GlobalPose = vtkSkeletonPose::New();
+  this->SkinningPose = vtkSkeletonPose::New();
+
+  this->SkinningPoseAnimation = nullptr;
+  this->SkinningPoseAnimationTime = 0;
+  this->SampledAnimationTime = 0;
+  this->SkinningPoseFrame = 0;
+  this->SkinningPoseBlendTime = 0;
+  this->SkinningPoseInputsTime = 0;
+  this->PoseUpdateInterval = 1;
+  this->PoseUpdateCounter = 0;
+  this->PendingSkinningPose = false;
+  this->ParallelBoneThreshold = 256;
+
   this->IsSkinnable = true;
+  this->SortByMaterial = false;
+  this->MaterialSortedPolys = nullptr;
+  this->MaterialSortedPolysSourceTime = 0;
+
+  this->VBOTCoords = nullptr;
+  this->HaveTexturedMaterials = false;
+  this->UploadedBytes = 0;
+
+  this->MorphTargets = nullptr;
+  this->MorphedInput = nullptr;
+  this->MorphedInputSourceTime = 0;
+
+  this->SkinningMode = VERTEX_SHADER;
+  this->SkinnedInput = nullptr;
+  this->SkinnedInputSourceTime = 0;
+  this->SkinnedInputPoseTime = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -54,6 +170,22 @@ vtkSkeletonPolyDataMapper::~vtkSkeletonPolyDataMapper()
   this->SkeletonBindPose->Delete();
   this->SkeletonHierarchy->Delete();
   this->AnimationCallbackCommand->Delete();
+  if (this->SkinningPoseAnimation != nullptr)
+  {
+    this->SkinningPoseAnimation->Delete();
+  }
+  if (this->AnimationBlend != nullptr)
+  {
+    this->AnimationBlend->Delete();
+  }
+  if (this->Profiler != nullptr)
+  {
+    this->Profiler->Delete();
+  }
+  this->AnimationPose->Delete();
+  this->NodeGlobalPose->Delete();
+  this->GlobalPose->Delete();
+  this->SkinningPose->Delete();
 
   for (size_t i = 0; i < this->Materials.size(); i++)
   {
@@ -65,6 +197,23 @@ vtkSkeletonPolyDataMapper::~vtkSkeletonPolyDataMapper()
   {
     this->VBOTCoords->Delete();
   }
+  if (this->MaterialSortedPolys != nullptr)
+  {
+    this->MaterialSortedPolys->Delete();
+  }
+
+  if (this->MorphTargets != nullptr)
+  {
+    this->MorphTargets->Delete();
+  }
+  if (this->MorphedInput != nullptr)
+  {
+    this->MorphedInput->Delete();
+  }
+  if (this->SkinnedInput != nullptr)
+  {
+    this->SkinnedInput->Delete();
+  }
 }
 
 //-------------------------------------------------------------------------
@@ -112,12 +261,323 @@ void vtkSkeletonPolyDataMapper::SetSkeletonHierarchy(vtkSkeletonHierarchy* hiera
   }
   hierarchy->Register(this);
   this->SkeletonHierarchy = hierarchy;
+
+  // Force a full evaluation of the new hierarchy
+  this->NodeGlobalPose->SetNumberOfTransforms(0);
+}
+
+//-------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::SetAnimationBlend(vtkSkeletonAnimationBlend* blend)
+{
+  if (this->AnimationBlend == blend)
+  {
+    return;
+  }
+
+  if (this->AnimationBlend != nullptr)
+  {
+    this->AnimationBlend->Delete();
+  }
+  if (blend != nullptr)
+  {
+    blend->Register(this);
+  }
+  this->AnimationBlend = blend;
+  this->Modified();
+}
+
+//-------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::SetProfiler(vtkSkinningProfiler* profiler)
+{
+  if (this->Profiler == profiler)
+  {
+    return;
+  }
+
+  if (this->Profiler != nullptr)
+  {
+    this->Profiler->Delete();
+  }
+  if (profiler != nullptr)
+  {
+    profiler->Register(this);
+  }
+  this->Profiler = profiler;
+}
+
+//-------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::SetMorphTargets(vtkSkeletonMorphTargets* morphTargets)
+{
+  if (this->MorphTargets == morphTargets)
+  {
+    return;
+  }
+
+  if (this->MorphTargets != nullptr)
+  {
+    this->MorphTargets->Delete();
+  }
+  if (morphTargets != nullptr)
+  {
+    morphTargets->Register(this);
+  }
+  this->MorphTargets = morphTargets;
+  this->Modified();
+}
+
+//-------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::SetMorphTargetWeight(vtkIdType target, double weight)
+{
+  if (target < 0)
+  {
+    return;
+  }
+  if (target >= static_cast<vtkIdType>(this->MorphTargetWeights.size()))
+  {
+    this->MorphTargetWeights.resize(target + 1, 0.0);
+  }
+  this->MorphTargetWeights[target] = weight;
+}
+
+//-------------------------------------------------------------------------
+double vtkSkeletonPolyDataMapper::GetMorphTargetWeight(vtkIdType target) const
+{
+  if (target < 0 || target >= static_cast<vtkIdType>(this->MorphTargetWeights.size()))
+  {
+    return 0.0;
+  }
+  return this->MorphTargetWeights[target];
+}
+
+//-------------------------------------------------------------------------
+const std::vector<double>& vtkSkeletonPolyDataMapper::GetMorphWeights() const
+{
+  return this->MorphWeights;
+}
+
+//-------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::UpdateMorphedInput()
+{
+  vtkPolyData* input = this->CurrentInput;
+  if (input == nullptr || input->GetPoints() == nullptr ||
+    this->MorphTargets == nullptr || this->MorphTargets->GetNumberOfTargets() == 0)
+  {
+    if (this->MorphedInput != nullptr)
+    {
+      this->MorphedInput->Delete();
+      this->MorphedInput = nullptr;
+    }
+    this->MorphWeights.clear();
+    return;
+  }
+
+  // Static weights, overridden by the channels of the current clip
+  size_t nbTargets = static_cast<size_t>(this->MorphTargets->GetNumberOfTargets());
+  std::vector<double> weights = this->MorphTargetWeights;
+  weights.resize(nbTargets, 0.0);
+
+  bool useBlend = this->AnimationBlend != nullptr && this->AnimationBlend->GetNumberOfLayers() > 0;
+  if (!useBlend && this->CurrentAnimationIndex >= 0 &&
+    this->CurrentAnimationIndex < this->SkeletonAnimationStack->GetNumberOfAnimations())
+  {
+    // Clips are decoded lazily and may fail to load: zero weights then
+    vtkSkeletonAnimation* animation = this->SkeletonAnimationStack->GetAnimation(this->CurrentAnimationIndex);
+    if (animation != nullptr)
+    {
+      double animationTime = animation->GetDuration() > 0.0 ?
+        std::fmod(static_cast<double>(this->Frame), animation->GetDuration()) : 0.0;
+      animation->ComputeMorphWeights(animationTime, weights);
+      weights.resize(nbTargets);
+    }
+    else
+    {
+      weights.assign(nbTargets, 0.0);
+    }
+  }
+
+  vtkMTimeType sourceTime = std::max(input->GetMTime(), this->MorphTargets->GetMTime());
+  if (this->MorphedInput != nullptr && this->MorphedInputSourceTime == sourceTime &&
+    this->MorphWeights == weights)
+  {
+    return;
+  }
+
+  vtkDataArray* normals = input->GetPointData()->GetNormals();
+  if (this->MorphedInput == nullptr || this->MorphedInputSourceTime != sourceTime)
+  {
+    // Share everything with the input but the points and normals
+    if (this->MorphedInput == nullptr)
+    {
+      this->MorphedInput = vtkPolyData::New();
+    }
+    this->MorphedInput->ShallowCopy(input);
+    this->MorphedInputBuildTime.Modified();
+
+    vtkNew<vtkPoints> morphedPoints;
+    morphedPoints->SetDataType(input->GetPoints()->GetDataType());
+    this->MorphedInput->SetPoints(morphedPoints);
+
+    if (normals != nullptr)
+    {
+      vtkDataArray* morphedNormals = vtkDataArray::CreateDataArray(normals->GetDataType());
+      morphedNormals->SetName(normals->GetName());
+      this->MorphedInput->GetPointData()->SetNormals(morphedNormals);
+      morphedNormals->Delete();
+    }
+  }
+
+  if (!this->MorphTargets->Apply(weights, input->GetPoints()->GetData(),
+        this->MorphedInput->GetPoints()->GetData(), normals,
+        this->MorphedInput->GetPointData()->GetNormals()))
+  {
+    vtkErrorMacro(<< "Morph targets cannot be applied to the input points.");
+  }
+  this->MorphedInput->GetPoints()->Modified();
+
+  this->MorphWeights = weights;
+  this->MorphedInputSourceTime = sourceTime;
+}
+
+//-------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::UpdateSkinnedInput()
+{
+  vtkPolyData* input = this->MorphedInput != nullptr ? this->MorphedInput : this->CurrentInput;
+
+  vtkDoubleArray* weights = nullptr;
+  vtkIntArray* boneIds = nullptr;
+  if (this->SkinningMode == PRE_SKINNED && this->IsSkinnable &&
+    input != nullptr && input->GetPoints() != nullptr)
+  {
+    weights = vtkDoubleArray::SafeDownCast(input->GetPointData()->GetAbstractArray("Weights"));
+    boneIds = vtkIntArray::SafeDownCast(input->GetPointData()->GetAbstractArray("BoneIDs"));
+    this->UpdateSkinningPose();
+  }
+
+  if (weights == nullptr || boneIds == nullptr ||
+    weights->GetNumberOfComponents() != 4 || boneIds->GetNumberOfComponents() != 4 ||
+    this->SkinningPalette.empty())
+  {
+    if (this->SkinnedInput != nullptr)
+    {
+      this->SkinnedInput->Delete();
+      this->SkinnedInput = nullptr;
+    }
+    return;
+  }
+
+  // Skin once per pose, all the render passes share the result
+  vtkMTimeType sourceTime = input->GetMTime();
+  vtkMTimeType poseTime = this->SkinningPose->GetMTime();
+  if (this->SkinnedInput != nullptr && this->SkinnedInputSourceTime == sourceTime &&
+    this->SkinnedInputPoseTime == poseTime)
+  {
+    return;
+  }
+
+  vtkDataArray* normals = input->GetPointData()->GetNormals();
+  if (this->SkinnedInput == nullptr || this->SkinnedInputSourceTime != sourceTime)
+  {
+    // Share everything with the input but the points and normals
+    if (this->SkinnedInput == nullptr)
+    {
+      this->SkinnedInput = vtkPolyData::New();
+    }
+    this->SkinnedInput->ShallowCopy(input);
+
+    vtkNew<vtkPoints> skinnedPoints;
+    skinnedPoints->SetDataTypeToFloat();
+    skinnedPoints->SetNumberOfPoints(input->GetNumberOfPoints());
+    this->SkinnedInput->SetPoints(skinnedPoints);
+
+    if (normals != nullptr)
+    {
+      vtkNew<vtkFloatArray> skinnedNormals;
+      skinnedNormals->SetName(normals->GetName());
+      skinnedNormals->SetNumberOfComponents(3);
+      skinnedNormals->SetNumberOfTuples(normals->GetNumberOfTuples());
+      this->SkinnedInput->GetPointData()->SetNormals(skinnedNormals);
+    }
+  }
+
+  vtkFloatArray* skinnedPoints = vtkFloatArray::SafeDownCast(this->SkinnedInput->GetPoints()->GetData());
+  vtkSkeletonPose::SkinVectors(input->GetPoints()->GetData(), weights, boneIds,
+    this->SkinningPalette, 1.0, skinnedPoints);
+  this->SkinnedInput->GetPoints()->Modified();
+
+  vtkFloatArray* skinnedNormals =
+    vtkFloatArray::SafeDownCast(this->SkinnedInput->GetPointData()->GetNormals());
+  if (normals != nullptr && skinnedNormals != nullptr)
+  {
+    vtkSkeletonPose::SkinVectors(normals, weights, boneIds, this->SkinningPalette, 0.0, skinnedNormals);
+  }
+
+  this->SkinnedInputSourceTime = sourceTime;
+  this->SkinnedInputPoseTime = poseTime;
+}
+
+//-------------------------------------------------------------------------
+bool vtkSkeletonPolyDataMapper::GetNeedToRebuildBufferObjects(vtkRenderer* ren, vtkActor* act)
+{
+  this->UpdateMorphedInput();
+  this->UpdateSkinnedInput();
+
+  // Weight changes alone are uploaded by UpdateBufferObjects()
+  if (this->MorphedInput != nullptr && this->VBOBuildTime < this->MorphedInputBuildTime)
+  {
+    return true;
+  }
+  if (this->MorphedInput != nullptr && this->SkinnedInput == nullptr &&
+    this->VBOs->GetVBO("vertexMC") == nullptr)
+  {
+    return true;
+  }
+  if (this->SkinnedInput != nullptr && this->VBOBuildTime < this->SkinnedInput->GetMTime())
+  {
+    return true;
+  }
+  return Superclass::GetNeedToRebuildBufferObjects(ren, act);
+}
+
+//-------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::UpdateBufferObjects(vtkRenderer* ren, vtkActor* act)
+{
+  Superclass::UpdateBufferObjects(ren, act);
+
+  // Pre-skinned points are rebuilt by the skinning, which includes the morph
+  if (this->MorphedInput == nullptr || this->SkinnedInput != nullptr)
+  {
+    return;
+  }
+
+  vtkDataArray* points = this->MorphedInput->GetPoints()->GetData();
+  vtkDataArray* normals = this->MorphedInput->GetPointData()->GetNormals();
+  if (points->GetMTime() < this->VBOBuildTime || points->GetMTime() < this->MorphedBuffersTime)
+  {
+    return;
+  }
+
+  vtkSkinningProfiler::ScopedTimer timer(this->Profiler, vtkSkinningProfiler::BUFFER_BUILD);
+
+  // Same buffers as the last build: they hold these arrays, only the values changed
+  this->VBOs->GetVBO("vertexMC")->UploadDataArray(points);
+  this->CountArrayUpload("vertexMC", points, VTK_FLOAT);
+
+  vtkOpenGLVertexBufferObject* normalsVBO = this->VBOs->GetVBO("normalMC");
+  if (normals != nullptr && normalsVBO != nullptr)
+  {
+    normalsVBO->UploadDataArray(normals);
+    this->CountArrayUpload("normalMC", normals, VTK_FLOAT);
+  }
+
+  this->MorphedBuffersTime.Modified();
 }
 
 //-------------------------------------------------------------------------
 void vtkSkeletonPolyDataMapper::BuildBufferObjects(
   vtkRenderer *ren, vtkActor *act)
 {
+  vtkSkinningProfiler::ScopedTimer timer(this->Profiler, vtkSkinningProfiler::BUFFER_BUILD);
+
   vtkPolyData *poly = this->CurrentInput;
 
   if (poly == nullptr)
@@ -134,9 +594,10 @@ void vtkSkeletonPolyDataMapper::BuildBufferObjects(
       "Skinning won't be performed.");
     this->IsSkinnable = false;
   }
-  else
+  else if (this->SkinnedInput == nullptr)
   {
     this->VBOs->CacheDataArray("weights", weights, ren, VTK_FLOAT);
+    this->CountArrayUpload("weights", weights, VTK_FLOAT);
   }
 
   // Look for bone IDs attribute
@@ -148,9 +609,10 @@ void vtkSkeletonPolyDataMapper::BuildBufferObjects(
       "Skinning won't be performed.");
     this->IsSkinnable = false;
   }
-  else
+  else if (this->SkinnedInput == nullptr)
   {
     this->VBOs->CacheDataArray("boneIDs", boneIDs, ren, VTK_INT);
+    this->CountArrayUpload("boneIDs", boneIDs, VTK_INT);
   }
 
   // Look for the animation
@@ -180,6 +642,7 @@ void vtkSkeletonPolyDataMapper::BuildBufferObjects(
   else
   {
     this->VBOs->CacheDataArray("materialId", materialIds, ren, VTK_INT);
+    this->CountArrayUpload("materialId", materialIds, VTK_INT);
   }
 
   // Handle multiple TCoords arrays indexed by material id
@@ -195,30 +658,63 @@ void vtkSkeletonPolyDataMapper::BuildBufferObjects(
     tCoordsIds.insert(tCoordsId);
   }
 
-  // Append TCoords arrays in VBO
-  if (tCoordsIds.size() > 0)
+  // Arrays to append in the TCoords VBO
+  std::vector<std::pair<vtkDataArray*, vtkMTimeType> > tCoordsArrays;
+  for (auto it = tCoordsIds.begin(); it != tCoordsIds.end(); it++)
   {
-    this->VBOTCoords = vtkOpenGLVertexBufferObject::New();
-    this->VBOTCoords->SetDataType(VTK_FLOAT);
+    vtkStdString tCoordsName = "TCoords_" + std::to_string(*it);
+    vtkDataArray* tCoords = poly->GetPointData()->GetArray(tCoordsName);
 
-    for (auto it = tCoordsIds.begin(); it != tCoordsIds.end(); it++)
+    if (tCoords == nullptr)
     {
-      vtkStdString tCoordsName = "TCoords_" + std::to_string(*it);
-      vtkDataArray* tCoords = poly->GetPointData()->GetArray(tCoordsName);
+      continue;
+    }
 
-      if (tCoords == nullptr)
-      {
-        continue;
-      }
+    tCoordsArrays.push_back(std::make_pair(tCoords, tCoords->GetMTime()));
+  }
 
+  // Append TCoords arrays in VBO, only when they changed since the last upload
+  if (tCoordsArrays != this->VBOTCoordsArrays)
+  {
+    if (this->VBOTCoords != nullptr)
+    {
+      this->VBOTCoords->Delete();
+      this->VBOTCoords = nullptr;
+    }
+    this->VBOTCoordsArrays = tCoordsArrays;
+  }
+
+  if (this->VBOTCoords == nullptr && !tCoordsArrays.empty())
+  {
+    this->VBOTCoords = vtkOpenGLVertexBufferObject::New();
+    this->VBOTCoords->SetDataType(VTK_FLOAT);
+
+    for (size_t i = 0; i < tCoordsArrays.size(); i++)
+    {
+      vtkDataArray* tCoords = tCoordsArrays[i].first;
       this->VBOTCoords->AppendDataArray(tCoords);
+      this->UploadedBytes += tCoords->GetNumberOfTuples() * tCoords->GetNumberOfComponents() *
+        static_cast<vtkIdType>(sizeof(float));
     }
 
     this->VBOTCoords->UploadVBO();
   }
 
+  // Points and normals with the morph targets and the skinning applied
+  if (this->SkinnedInput != nullptr)
+  {
+    this->CurrentInput = this->SkinnedInput;
+    this->CountArrayUpload("vertexMC", this->SkinnedInput->GetPoints()->GetData(), VTK_FLOAT);
+  }
+  else if (this->MorphedInput != nullptr)
+  {
+    this->CurrentInput = this->MorphedInput;
+  }
+
   // WARNING: TODO Prevent Superclass to bind tcoords if already done here
   Superclass::BuildBufferObjects(ren, act);
+
+  this->CurrentInput = poly;
 }
 
 //-----------------------------------------------------------------------------
@@ -226,12 +722,21 @@ void vtkSkeletonPolyDataMapper::BuildShaders(
   std::map<vtkShader::Type, vtkShader *> shaders,
   vtkRenderer *ren, vtkActor *actor)
 {
+  vtkSkinningProfiler::ScopedTimer timer(this->Profiler, vtkSkinningProfiler::SHADER_BUILD);
+
   // Perform shader replacement
-  if (this->IsSkinnable)
+  if (this->IsSkinnable && this->SkinnedInput == nullptr)
   {
     this->AddShaderPositionVCReplacement();
     this->AddShaderNormalReplacement();
   }
+  else
+  {
+    // Pre-skinned points and normals are drawn as is
+    this->ClearShaderReplacement(vtkShader::Vertex, "//VTK::PositionVC::Dec", true);
+    this->ClearShaderReplacement(vtkShader::Vertex, "//VTK::PositionVC::Impl", true);
+    this->ClearShaderReplacement(vtkShader::Vertex, "//VTK::Normal::Impl", true);
+  }
   this->AddShaderTCoordReplacement(actor);
 
   Superclass::BuildShaders(shaders, ren, actor);
@@ -276,8 +781,11 @@ void vtkSkeletonPolyDataMapper::SetMapperShaderParameters(vtkOpenGLHelper &cellB
       }
 
       int tunit = vtkOpenGLTexture::SafeDownCast(albedoTexture)->GetTextureUnit();
-      std::string textureShaderName = "albedoSampler2D[" + std::to_string(tunit) + "]";
-      cellBO.Program->SetUniformi(textureShaderName.c_str(), tunit);
+      if (this->MaterialRanges.empty())
+      {
+        std::string textureShaderName = "albedoSampler2D[" + std::to_string(tunit) + "]";
+        cellBO.Program->SetUniformi(textureShaderName.c_str(), tunit);
+      }
 
       materialAlbedoSampler2DIds[materialId] = tunit;
 
@@ -286,10 +794,14 @@ void vtkSkeletonPolyDataMapper::SetMapperShaderParameters(vtkOpenGLHelper &cellB
       this->HaveTexturedMaterials = true;
     }
 
-    cellBO.Program->SetUniform1iv("materialAlbedoSampler2DId",
-      static_cast<int>(this->Materials.size()), &materialAlbedoSampler2DIds[0]);
-    cellBO.Program->SetUniform1iv("materialTCoordsId",
-      static_cast<int>(this->Materials.size()), &materialTCoordsIds[0]);
+    // When sorting by material, material uniforms are set per draw (see RenderPieceDraw)
+    if (this->MaterialRanges.empty())
+    {
+      cellBO.Program->SetUniform1iv("materialAlbedoSampler2DId",
+        static_cast<int>(this->Materials.size()), &materialAlbedoSampler2DIds[0]);
+      cellBO.Program->SetUniform1iv("materialTCoordsId",
+        static_cast<int>(this->Materials.size()), &materialTCoordsIds[0]);
+    }
   }
 
   // Superclass call to SetMapperShaderParameters.
@@ -342,75 +854,388 @@ void vtkSkeletonPolyDataMapper::SetMapperShaderParameters(vtkOpenGLHelper &cellB
 void vtkSkeletonPolyDataMapper::SetSkinningShaderParameters(vtkOpenGLHelper &cellBO,
   vtkRenderer* ren, vtkActor *actor)
 {
-  if (!this->IsSkinnable)
+  if (!this->IsSkinnable || this->SkinnedInput != nullptr)
   {
     return;
   }
 
-  vtkSkeletonAnimation* currentAnimation = this->SkeletonAnimationStack->GetAnimation(this->CurrentAnimationIndex);
+  this->UpdateSkinningPose();
+
+  vtkSkinningProfiler::ScopedTimer timer(this->Profiler, vtkSkinningProfiler::PALETTE_UPLOAD);
+
+  if (this->SkinningPalette.empty())
+  {
+    return;
+  }
+
+  cellBO.Program->SetUniform4fv("SkeletonPalette",
+    static_cast<int>(this->SkinningPalette.size()) / 4,
+    reinterpret_cast<const float(*)[4]>(&this->SkinningPalette[0]));
+  this->UploadedBytes += static_cast<vtkIdType>(this->SkinningPalette.size() * sizeof(float));
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::UpdateSkinningPose()
+{
+  if (this->PrepareSkinningPose())
+  {
+    this->EvaluateSkinningPose();
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSkeletonPolyDataMapper::PrepareSkinningPose()
+{
+  this->PendingSkinningPose = false;
+
+  bool useBlend = this->AnimationBlend != nullptr && this->AnimationBlend->GetNumberOfLayers() > 0;
+
+  vtkSkeletonAnimation* currentAnimation = nullptr;
+  if (!useBlend)
+  {
+    if (this->CurrentAnimationIndex < 0 ||
+      this->CurrentAnimationIndex >= this->SkeletonAnimationStack->GetNumberOfAnimations())
+    {
+      return false;
+    }
+    currentAnimation = this->SkeletonAnimationStack->GetAnimation(this->CurrentAnimationIndex);
+    if (currentAnimation == nullptr)
+    {
+      return false;
+    }
+  }
+
+  if (this->SkeletonBindPose->GetNumberOfTransforms() <= 0)
+  {
+    return false;
+  }
+
+  // Layer setup changes invalidate the pose, layer time changes are animation
+  // steps, like frame changes
+  vtkMTimeType inputsTime = std::max(this->SkeletonHierarchy->GetMTime(), this->SkeletonBindPose->GetMTime());
+  vtkMTimeType blendTime = 0;
+  if (useBlend)
+  {
+    inputsTime = std::max(inputsTime, this->AnimationBlend->GetLayersMTime());
+    blendTime = this->AnimationBlend->GetLayerTimesMTime();
+  }
+
+  // Clips are told apart by their MTime: a clip decoded again after an
+  // eviction may reuse the address of the previous one
+  vtkMTimeType animationTime = currentAnimation != nullptr ? currentAnimation->GetMTime() : 0;
 
-  vtkNew<vtkSkeletonPose> animationPose;
-  currentAnimation->ComputeInterpolatedPose(this->Frame, animationPose);
+  // Already evaluated for this state
+  if (this->SkinningPose->GetNumberOfTransforms() > 0 &&
+    this->SkinningPoseAnimationTime == animationTime &&
+    this->SkinningPoseFrame == this->Frame &&
+    this->SkinningPoseBlendTime == blendTime &&
+    this->SkinningPoseInputsTime == inputsTime)
+  {
+    return false;
+  }
 
-  vtkNew<vtkSkeletonPose> globalPose;
-  vtkSkeletonPose::ComputeGlobalPose(animationPose, this->SkeletonHierarchy, globalPose);
+  bool skipUpdate = this->SkinningPose->GetNumberOfTransforms() > 0 &&
+    this->SkinningPoseAnimationTime == animationTime &&
+    this->SkinningPoseInputsTime == inputsTime &&
+    (++this->PoseUpdateCounter % this->PoseUpdateInterval) != 0;
 
-  vtkNew<vtkSkeletonPose> pose;
-  vtkSkeletonPose::Multiply(globalPose, this->SkeletonBindPose, pose);
+  // Hold the clip for EvaluateSkinningPose() and the next frames: the stack
+  // does not evict it meanwhile
+  if (this->SkinningPoseAnimation != currentAnimation)
+  {
+    if (currentAnimation != nullptr)
+    {
+      currentAnimation->Register(this);
+    }
+    if (this->SkinningPoseAnimation != nullptr)
+    {
+      this->SkinningPoseAnimation->Delete();
+    }
+    this->SkinningPoseAnimation = currentAnimation;
+  }
+  this->SkinningPoseAnimationTime = animationTime;
+  this->SkinningPoseFrame = this->Frame;
+  this->SkinningPoseBlendTime = blendTime;
+  this->SkinningPoseInputsTime = inputsTime;
 
-  std::vector<float> boneTransforms;
-  boneTransforms.resize(16 * pose->GetNumberOfTransforms());
+  if (skipUpdate)
+  {
+    return false;
+  }
 
-  for (unsigned int k = 0; k < pose->GetNumberOfTransforms(); k++)
+  // The hierarchy and the blend may be shared: build the evaluation order and
+  // the additive references now
+  this->SkeletonHierarchy->GetEvaluationNodes();
+  if (useBlend)
   {
-    double boneMatrix[16];
-    pose->GetTransformMatrix(k, boneMatrix);
+    this->AnimationBlend->Prepare();
+  }
+
+  this->PendingSkinningPose = true;
+  return true;
+}
 
-    for (int i = 0; i < 4; i++)
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::EvaluateSkinningPose()
+{
+  if (!this->PendingSkinningPose)
+  {
+    return;
+  }
+  this->PendingSkinningPose = false;
+
+  vtkSkeletonAnimation* currentAnimation = this->SkinningPoseAnimation;
+
+  {
+    vtkSkinningProfiler::ScopedTimer timer(this->Profiler, vtkSkinningProfiler::KEY_LOOKUP);
+    if (currentAnimation == nullptr)
+    {
+      this->AnimationBlend->ComputePose(this->AnimationPose);
+      this->SampledAnimationTime = 0;
+    }
+    else if (this->ActiveBones.empty() && currentAnimation->GetNumberOfNodes() < this->ParallelBoneThreshold)
+    {
+      currentAnimation->ComputeInterpolatedPose(this->Frame, this->AnimationPose);
+      this->SampledAnimationTime = 0;
+    }
+    else
     {
-      for (int j = 0; j < 4; j++)
+      // Sample all the bones once after a resize or a clip change, then only
+      // the animated ones
+      vtkIdType nbBones = currentAnimation->GetNumberOfNodes();
+      bool sampleAll = this->AnimationPose->GetNumberOfTransforms() != nbBones ||
+        this->AnimationPose->GetScaleMode() != currentAnimation->GetScaleMode() ||
+        this->SampledAnimationTime != currentAnimation->GetMTime();
+      this->SampledAnimationTime = currentAnimation->GetMTime();
+      this->AnimationPose->SetScaleMode(currentAnimation->GetScaleMode());
+      if (sampleAll)
+      {
+        this->AnimationPose->SetNumberOfTransforms(nbBones);
+      }
+      // Rest transforms are tracked by SampledAnimationTime on this path
+      this->AnimationPose->SetRestTransformsAnimationTime(0);
+
+      BoneSampler sampler;
+      sampler.Animation = currentAnimation;
+      sampler.Time = currentAnimation->GetDuration() > 0.0 ?
+        std::fmod(static_cast<double>(this->Frame), currentAnimation->GetDuration()) : 0.0;
+      sampler.ActiveBones = sampleAll ? nullptr : &this->ActiveBones;
+      sampler.AnimatedOnly = !sampleAll;
+      this->SampledTransforms.resize(7 * nbBones);
+      sampler.Transforms = this->SampledTransforms.data();
+      sampler.Scales = nullptr;
+      if (currentAnimation->GetScaleMode() != vtkSkeletonPose::NO_SCALE)
+      {
+        this->SampledScales.resize(3 * nbBones);
+        sampler.Scales = this->SampledScales.data();
+      }
+
+      // Key lookups of large rigs are split in bone ranges
+      if (nbBones >= this->ParallelBoneThreshold)
       {
-        boneTransforms[k * 16 + 4 * i + j] = boneMatrix[4 * j + i];
+        vtkSMPTools::For(0, nbBones, sampler);
+      }
+      else
+      {
+        sampler(0, nbBones);
+      }
+
+      for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+      {
+        if (sampler.IsSampled(boneId))
+        {
+          this->AnimationPose->SetTransform(boneId, &this->SampledTransforms[7 * boneId]);
+          if (sampler.Scales != nullptr)
+          {
+            this->AnimationPose->SetScale(boneId, &this->SampledScales[3 * boneId]);
+          }
+        }
       }
     }
   }
 
-  cellBO.Program->SetUniformMatrix4x4v("SkeletonPose",
-    static_cast<int>(boneTransforms.size()) / 16,
-    &boneTransforms[0]);
+  {
+    vtkSkinningProfiler::ScopedTimer timer(this->Profiler, vtkSkinningProfiler::GLOBAL_POSE);
+    vtkSkeletonPose::UpdateGlobalPose(this->AnimationPose, this->SkeletonHierarchy,
+      this->NodeGlobalPose, this->GlobalPose);
+    vtkSkeletonPose::MultiplyToPalette(this->GlobalPose, this->SkeletonBindPose,
+      this->SkinningPose, this->SkinningPalette);
+  }
 }
 
 //-----------------------------------------------------------------------------
-void vtkSkeletonPolyDataMapper::UpdateAnimationCallback(vtkObject* caller,
-  long unsigned int vtkNotUsed(eventId), void* clientData, void* vtkNotUsed(callData))
+const std::vector<float>& vtkSkeletonPolyDataMapper::GetSkinningPalette() const
 {
-  vtkSkeletonPolyDataMapper *mapper =
-    static_cast<vtkSkeletonPolyDataMapper*>(clientData);
+  return this->SkinningPalette;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::UpdateBoneBounds()
+{
+  // Points displaced by the morph targets of the last render, if any
+  vtkPolyData* input = this->MorphedInput != nullptr ? this->MorphedInput : this->GetInput();
+  if (input == nullptr)
+  {
+    this->BoneBounds.clear();
+    return;
+  }
+
+  if (this->BoneBoundsTime > input->GetMTime() && this->BoneBoundsTime > this->SkeletonBindPose->GetMTime())
+  {
+    return;
+  }
+
+  this->BoneBounds.clear();
+  this->BoneBoundsTime.Modified();
 
-  if (mapper->GetSkeletonAnimationStack()->GetNumberOfAnimations() == 0)
+  vtkDataArray* weights = input->GetPointData()->GetArray("Weights");
+  vtkDataArray* boneIDs = input->GetPointData()->GetArray("BoneIDs");
+  vtkPoints* points = input->GetPoints();
+  if (weights == nullptr || boneIDs == nullptr || points == nullptr)
   {
     return;
   }
 
-  vtkSkeletonAnimation* currentAnimation = mapper->GetSkeletonAnimationStack()->GetAnimation(mapper->GetCurrentAnimationIndex());
+  vtkIdType nbBones = this->SkeletonBindPose->GetNumberOfTransforms();
+  this->BoneBounds.resize(6 * nbBones);
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+  {
+    vtkMath::UninitializeBounds(&this->BoneBounds[6 * boneId]);
+  }
+
+  for (vtkIdType pointId = 0; pointId < points->GetNumberOfPoints(); pointId++)
+  {
+    double point[3];
+    double pointWeights[4];
+    double pointBoneIDs[4];
+    points->GetPoint(pointId, point);
+    weights->GetTuple(pointId, pointWeights);
+    boneIDs->GetTuple(pointId, pointBoneIDs);
+
+    for (int k = 0; k < 4; k++)
+    {
+      vtkIdType boneId = static_cast<vtkIdType>(pointBoneIDs[k]);
+      if (pointWeights[k] <= 0.0 || boneId < 0 || boneId >= nbBones)
+      {
+        continue;
+      }
+
+      double* bounds = &this->BoneBounds[6 * boneId];
+      if (!vtkMath::AreBoundsInitialized(bounds))
+      {
+        bounds[0] = bounds[1] = point[0];
+        bounds[2] = bounds[3] = point[1];
+        bounds[4] = bounds[5] = point[2];
+        continue;
+      }
+      for (int i = 0; i < 3; i++)
+      {
+        bounds[2 * i] = std::min(bounds[2 * i], point[i]);
+        bounds[2 * i + 1] = std::max(bounds[2 * i + 1], point[i]);
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::ComputeBounds()
+{
+  this->Superclass::ComputeBounds();
 
-  if (currentAnimation == nullptr)
+  if (!this->IsSkinnable || !vtkMath::AreBoundsInitialized(this->Bounds))
   {
     return;
   }
 
-  // Update animation frame
-  double dA = 15 / (1.0e3 / currentAnimation->GetTickPerSecond());
-  mapper->Alpha += dA;
-  if (mapper->Alpha > 1.0)
+  this->UpdateBoneBounds();
+  this->UpdateSkinningPose();
+
+  vtkIdType nbBones = std::min(static_cast<vtkIdType>(this->SkinningPalette.size() / 12),
+    static_cast<vtkIdType>(this->BoneBounds.size() / 6));
+
+  // Union of the bone boxes transformed by the palette. Each skinned point is
+  // a convex combination of its bones transforms, so it lies in this union.
+  vtkBoundingBox skinnedBounds;
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
   {
-    mapper->Alpha = 0.0;
-    mapper->Frame = (mapper->Frame + 1) % ((int)currentAnimation->GetDuration());
+    double* bounds = &this->BoneBounds[6 * boneId];
+    if (!vtkMath::AreBoundsInitialized(bounds))
+    {
+      continue;
+    }
+
+    const float* boneMatrix = &this->SkinningPalette[12 * boneId];
+
+    double center[3];
+    double extent[3];
+    for (int i = 0; i < 3; i++)
+    {
+      center[i] = 0.5 * (bounds[2 * i] + bounds[2 * i + 1]);
+      extent[i] = 0.5 * (bounds[2 * i + 1] - bounds[2 * i]);
+    }
+
+    double transformedBounds[6];
+    for (int i = 0; i < 3; i++)
+    {
+      double transformedCenter = boneMatrix[4 * i + 3];
+      double transformedExtent = 0.0;
+      for (int j = 0; j < 3; j++)
+      {
+        transformedCenter += boneMatrix[4 * i + j] * center[j];
+        transformedExtent += std::abs(boneMatrix[4 * i + j]) * extent[j];
+      }
+      transformedBounds[2 * i] = transformedCenter - transformedExtent;
+      transformedBounds[2 * i + 1] = transformedCenter + transformedExtent;
+    }
+    skinnedBounds.AddBounds(transformedBounds);
+  }
+
+  if (skinnedBounds.IsValid())
+  {
+    skinnedBounds.GetBounds(this->Bounds);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::UpdateAnimationCallback(vtkObject* caller,
+  long unsigned int vtkNotUsed(eventId), void* clientData, void* vtkNotUsed(callData))
+{
+  vtkSkeletonPolyDataMapper *mapper =
+    static_cast<vtkSkeletonPolyDataMapper*>(clientData);
+
+  if (mapper->AnimationBlend != nullptr && mapper->AnimationBlend->GetNumberOfLayers() > 0)
+  {
+    // Update blended layers time
+    mapper->AnimationBlend->AdvanceTime(15.0e-3);
+  }
+  else
+  {
+    if (mapper->GetSkeletonAnimationStack()->GetNumberOfAnimations() == 0)
+    {
+      return;
+    }
+
+    vtkSkeletonAnimation* currentAnimation = mapper->GetSkeletonAnimationStack()->GetAnimation(mapper->GetCurrentAnimationIndex());
+
+    if (currentAnimation == nullptr)
+    {
+      return;
+    }
+
+    // Update animation frame
+    double dA = 15 / (1.0e3 / currentAnimation->GetTickPerSecond());
+    mapper->Alpha += dA;
+    if (mapper->Alpha > 1.0)
+    {
+      mapper->Alpha = 0.0;
+      mapper->Frame = (mapper->Frame + 1) % ((int)currentAnimation->GetDuration());
+    }
   }
 
   vtkRenderWindowInteractor *iren =
     static_cast<vtkRenderWindowInteractor*>(caller);
 
+  vtkSkinningProfiler::ScopedTimer timer(mapper->GetProfiler(), vtkSkinningProfiler::RENDER);
   iren->GetRenderWindow()->Render();
 }
 
@@ -422,7 +1247,15 @@ void vtkSkeletonPolyDataMapper::AddShaderPositionVCReplacement()
     "//VTK::PositionVC::Dec\n" // we still want the default
     "attribute vec4 weights;\n"
     "attribute vec4 boneIDs;\n"
-    "uniform mat4 SkeletonPose[" << this->SkeletonBindPose->GetNumberOfTransforms() << "];\n";
+    "uniform vec4 SkeletonPalette[" <<
+      3 * GetShaderArraySize(this->SkeletonBindPose->GetNumberOfTransforms()) << "];\n"
+    // Rows of the 3x4 palette matrix of a bone applied to v
+    "vec3 skinVector(float boneId, vec4 v)\n"
+    "{\n"
+    "  int row = 3 * int(boneId);\n"
+    "  return vec3(dot(SkeletonPalette[row], v), dot(SkeletonPalette[row + 1], v),\n"
+    "    dot(SkeletonPalette[row + 2], v));\n"
+    "}\n";
 
   this->AddShaderReplacement(
     vtkShader::Vertex,
@@ -436,11 +1269,10 @@ void vtkSkeletonPolyDataMapper::AddShaderPositionVCReplacement()
     vtkShader::Vertex,
     "//VTK::PositionVC::Impl", // Override vertex output position.
     true,
-    "vec4 p = vec4(0,0,0,0);\n"
-    "p = p + weights.x * (SkeletonPose[int(boneIDs.x)] * vertexMC);\n"
-    "p = p + weights.y * (SkeletonPose[int(boneIDs.y)] * vertexMC);\n"
-    "p = p + weights.z * (SkeletonPose[int(boneIDs.z)] * vertexMC);\n"
-    "p = p + weights.w * (SkeletonPose[int(boneIDs.w)] * vertexMC);\n"
+    "vec4 p = vec4(weights.x * skinVector(boneIDs.x, vertexMC) +\n"
+    "  weights.y * skinVector(boneIDs.y, vertexMC) +\n"
+    "  weights.z * skinVector(boneIDs.z, vertexMC) +\n"
+    "  weights.w * skinVector(boneIDs.w, vertexMC), dot(weights, vec4(1.0)));\n"
     "vertexVCVSOutput = MCVCMatrix * p;\n"
     "gl_Position =  MCDCMatrix * p;\n",
     false
@@ -456,12 +1288,11 @@ void vtkSkeletonPolyDataMapper::AddShaderNormalReplacement()
     "//VTK::Normal::Impl",
     true,
     "//VTK::Normal::Impl" // We still want the default.
-    "vec4 n = vec4(0,0,0,0);\n"
-    "n = n + weights.x * (SkeletonPose[int(boneIDs.x)] * vec4(normalMC, 0));\n"
-    "n = n + weights.y * (SkeletonPose[int(boneIDs.y)] * vec4(normalMC, 0));\n"
-    "n = n + weights.z * (SkeletonPose[int(boneIDs.z)] * vec4(normalMC, 0));\n"
-    "n = n + weights.w * (SkeletonPose[int(boneIDs.w)] * vec4(normalMC, 0));\n"
-    "normalVCVSOutput = normalMatrix * n.xyz;",
+    "vec3 n = weights.x * skinVector(boneIDs.x, vec4(normalMC, 0.0)) +\n"
+    "  weights.y * skinVector(boneIDs.y, vec4(normalMC, 0.0)) +\n"
+    "  weights.z * skinVector(boneIDs.z, vec4(normalMC, 0.0)) +\n"
+    "  weights.w * skinVector(boneIDs.w, vec4(normalMC, 0.0));\n"
+    "normalVCVSOutput = normalMatrix * n;",
     false
   );
 }
@@ -501,19 +1332,38 @@ void vtkSkeletonPolyDataMapper::AddShaderTCoordReplacement(vtkActor* actor)
   // Add TCoords array declaration
   // WARNING: This will not prevent superclass to add its own declarations.
   //   TODO Prevent superclass from adding declarations if not needed
+  // TCoords attributes, varyings and samplers keep their exact count: each
+  // entry takes an attribute location, interpolators or a texture unit. Only
+  // the material uniform arrays are bucketed (see GetShaderArraySize()), their
+  // extra entries are never indexed.
   std::string tCoordsIdsSizeStr = std::to_string(tCoordsIds.size());
+  std::string materialsSizeStr = std::to_string(GetShaderArraySize(this->Materials.size()));
 
-  this->AddShaderReplacement(vtkShader::Vertex, "//VTK::TCoord::Dec\n", true,
-    "//VTK::TCoord::Dec\n"
+  // When sorting by material, the material is uniform per draw: no material id varying
+  bool perDrawMaterial = !this->MaterialRanges.empty();
+  std::string materialIdVSDec = perDrawMaterial ? "" :
     "in float materialId;\n"
+    "flat out float materialIdVCVSOutput;\n";
+  std::string materialIdVSImpl = perDrawMaterial ? "" :
+    "materialIdVCVSOutput = materialId;\n";
+  std::string materialIdGSDec = perDrawMaterial ? "" :
+    "in float materialIdVCVSOutput[];\n"
+    "out float materialIdVCGSOutput;\n";
+  std::string materialIdGSImpl = perDrawMaterial ? "" :
+    "materialIdVCGSOutput = materialIdVCVSOutput[i];\n";
+  std::string materialIdFSDec = perDrawMaterial ? "" :
+    "flat in float materialIdVCVSOutput;\n";
+
+  this->AddShaderReplacement(vtkShader::Vertex, "//VTK::TCoord::Dec\n", true,
+    "//VTK::TCoord::Dec\n" +
+    materialIdVSDec +
     "in vec2 TCoords[" + tCoordsIdsSizeStr + "];\n"
-    "flat out float materialIdVCVSOutput;\n"
     "out vec2 TCoordsVCVSOutput[" + tCoordsIdsSizeStr + "];\n",
     false);
 
   this->AddShaderReplacement(vtkShader::Vertex, "//VTK::TCoord::Impl\n", true,
-    "//VTK::TCoord::Impl\n"
-    "materialIdVCVSOutput = materialId;\n"
+    "//VTK::TCoord::Impl\n" +
+    materialIdVSImpl +
     "for(int k = 0; k < " + tCoordsIdsSizeStr + "; k++)\n"
     "{\n"
     "  TCoordsVCVSOutput[k] = TCoords[k];\n"
@@ -521,16 +1371,15 @@ void vtkSkeletonPolyDataMapper::AddShaderTCoordReplacement(vtkActor* actor)
     false);
 
   this->AddShaderReplacement(vtkShader::Geometry, "//VTK::TCoord::Dec\n", true,
-    "//VTK::TCoord::Dec\n"
-    "in float materialIdVCVSOutput[];\n"
+    "//VTK::TCoord::Dec\n" +
+    materialIdGSDec +
     "in vec2 TCoordsVCVSOutput[" + tCoordsIdsSizeStr + "][];\n " //WARNING: Untested
-    "out float materialIdVCGSOutput;\n"
     "out vec2 TCoordsVCGSOutput[" + tCoordsIdsSizeStr + "];\n",
     false);
 
   this->AddShaderReplacement(vtkShader::Geometry, "//VTK::TCoord::Impl\n", true,
-    "//VTK::TCoord::Impl\n"
-    "materialIdVCGSOutput = materialIdVCVSOutput[i];\n"
+    "//VTK::TCoord::Impl\n" +
+    materialIdGSImpl +
     "for(int k = 0; k < " + tCoordsIdsSizeStr + "; k++)\n"
     "{\n"
     "  TCoordsVCGSOutput[k] =  TCoordsVCVSOutput[k][i];\n" //WARNING: Untested
@@ -538,24 +1387,46 @@ void vtkSkeletonPolyDataMapper::AddShaderTCoordReplacement(vtkActor* actor)
     false);
 
   this->AddShaderReplacement(vtkShader::Fragment, "//VTK::TCoord::Dec", true,
-    "//VTK::TCoord::Dec\n"
-    "flat in float materialIdVCVSOutput;\n"
+    "//VTK::TCoord::Dec\n" +
+    materialIdFSDec +
     "in vec2 TCoordsVCVSOutput[" + tCoordsIdsSizeStr + "];\n",
     false);
 
   // Override texture mapping declaration.
   //   TODO : handle cube maps
   std::string tMapDecFS;
+  std::string tCoordImpFS;
 
-  // Add albedo sampler declaration
-  std::string albedoNamesSizeStr = std::to_string(tCoordsIds.size());
-  tMapDecFS += "uniform sampler2D albedoSampler2D["+ albedoNamesSizeStr +"];\n";
+  if (perDrawMaterial)
+  {
+    // Albedo sampler and TCoords array of the material being drawn (set in RenderPieceDraw())
+    tMapDecFS +=
+      "uniform sampler2D currentMaterialAlbedoSampler2D;\n"
+      "uniform int currentMaterialTCoordsId;\n"
+      "uniform int currentMaterialHasAlbedo;\n";
+
+    tCoordImpFS +=
+      "vec4 tcolor = vec4(1.0);\n"
+      "if (currentMaterialHasAlbedo != 0)\n"
+      "{\n"
+      "  tcolor = texture(currentMaterialAlbedoSampler2D, TCoordsVCVSOutput[currentMaterialTCoordsId]);\n"
+      "}\n";
+  }
+  else
+  {
+    // Add albedo sampler declaration
+    tMapDecFS += "uniform sampler2D albedoSampler2D["+ tCoordsIdsSizeStr +"];\n";
 
-  // Add declaration to map material id to albedo sampler id (filled in SetMapperShaderParameters())
-  tMapDecFS += "uniform int materialAlbedoSampler2DId[" + std::to_string(this->Materials.size()) + "];";
+    // Add declaration to map material id to albedo sampler id (filled in SetMapperShaderParameters())
+    tMapDecFS += "uniform int materialAlbedoSampler2DId[" + materialsSizeStr + "];";
 
-  // Add declaration to map material id to albedo sampler id (filled in SetMapperShaderParameters())
-  tMapDecFS += "uniform int materialTCoordsId[" + std::to_string(this->Materials.size()) + "];";
+    // Add declaration to map material id to albedo sampler id (filled in SetMapperShaderParameters())
+    tMapDecFS += "uniform int materialTCoordsId[" + materialsSizeStr + "];";
+
+    tCoordImpFS +=
+      "vec4 tcolor = texture(albedoSampler2D[materialAlbedoSampler2DId[int(materialIdVCVSOutput)]],"
+        "TCoordsVCVSOutput[materialTCoordsId[int(materialIdVCVSOutput)]]);\n";
+  }
 
   this->AddShaderReplacement(
     vtkShader::Fragment,
@@ -566,11 +1437,6 @@ void vtkSkeletonPolyDataMapper::AddShaderTCoordReplacement(vtkActor* actor)
   );
 
   // Override texture mapping.
-  std::string tCoordImpFS;
-  tCoordImpFS +=
-    "vec4 tcolor = texture(albedoSampler2D[materialAlbedoSampler2DId[int(materialIdVCVSOutput)]],"
-      "TCoordsVCVSOutput[materialTCoordsId[int(materialIdVCVSOutput)]]);\n";
-
   this->AddShaderReplacement(
     vtkShader::Fragment,
     "//VTK::TCoord::Impl",
@@ -580,9 +1446,255 @@ void vtkSkeletonPolyDataMapper::AddShaderTCoordReplacement(vtkActor* actor)
   );
 }
 
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::CountArrayUpload(const std::string& attribute,
+  vtkDataArray* array, int destType)
+{
+  std::pair<vtkDataArray*, vtkMTimeType> state(array, array->GetMTime());
+
+  // The VBO cache only uploads arrays that were modified since their last upload
+  auto it = this->UploadedArrays.find(attribute);
+  if (it != this->UploadedArrays.end() && it->second == state)
+  {
+    return;
+  }
+  this->UploadedArrays[attribute] = state;
+
+  this->UploadedBytes += array->GetNumberOfTuples() * array->GetNumberOfComponents() *
+    vtkDataArray::GetDataTypeSize(destType);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::RenderPiece(vtkRenderer* ren, vtkActor* actor)
+{
+  this->UploadedBytes = 0;
+  Superclass::RenderPiece(ren, actor);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::ReleaseGraphicsResources(vtkWindow* win)
+{
+  if (this->VBOTCoords != nullptr)
+  {
+    this->VBOTCoords->ReleaseGraphicsResources();
+    this->VBOTCoords->Delete();
+    this->VBOTCoords = nullptr;
+  }
+  this->VBOTCoordsArrays.clear();
+  this->UploadedArrays.clear();
+
+  Superclass::ReleaseGraphicsResources(win);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::UpdateMaterialSortedPolys(vtkPolyData* poly, vtkDataArray* materialIds)
+{
+  vtkCellArray* polys = poly->GetPolys();
+  vtkMTimeType sourceTime = std::max(polys->GetMTime(), materialIds->GetMTime());
+  if (this->MaterialSortedPolys != nullptr && this->MaterialSortedPolysSourceTime == sourceTime)
+  {
+    return;
+  }
+
+  // Polygons of each material. Assimp meshes have a single material, so the
+  // material of a polygon is the material of its first point.
+  std::map<int, std::vector<vtkIdType> > materialPolys; // Point count then point ids of each polygon
+  vtkIdType npts;
+  vtkIdType* pts;
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts);)
+  {
+    int materialId = npts > 0 ? static_cast<int>(materialIds->GetComponent(pts[0], 0)) : 0;
+    std::vector<vtkIdType>& cells = materialPolys[materialId];
+    cells.push_back(npts);
+    cells.insert(cells.end(), pts, pts + npts);
+  }
+
+  if (this->MaterialSortedPolys == nullptr)
+  {
+    this->MaterialSortedPolys = vtkCellArray::New();
+  }
+  this->MaterialSortedPolys->Reset();
+  this->MaterialSortedRanges.clear();
+
+  // A polygon of n points gives n - 2 triangles in the index buffer
+  size_t firstIndex = 0;
+  for (auto it = materialPolys.begin(); it != materialPolys.end(); ++it)
+  {
+    MaterialRange range;
+    range.MaterialId = it->first;
+    range.FirstIndex = firstIndex;
+    range.IndexCount = 0;
+
+    const std::vector<vtkIdType>& cells = it->second;
+    for (size_t i = 0; i < cells.size(); i += cells[i] + 1)
+    {
+      this->MaterialSortedPolys->InsertNextCell(cells[i], &cells[i + 1]);
+      range.IndexCount += cells[i] >= 3 ? 3 * static_cast<size_t>(cells[i] - 2) : 0;
+    }
+
+    this->MaterialSortedRanges.push_back(range);
+    firstIndex += range.IndexCount;
+  }
+  this->MaterialSortedPolys->Modified();
+
+  this->MaterialSortedPolysSourceTime = sourceTime;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::BuildIBO(vtkRenderer* ren, vtkActor* act, vtkPolyData* poly)
+{
+  this->MaterialRanges.clear();
+
+  // Primitive ids of hardware selection must match the input cell order
+  vtkDataArray* materialIds = poly->GetPointData()->GetArray("MaterialIds");
+  if (!this->SortByMaterial || this->Materials.empty() || materialIds == nullptr ||
+    act->GetProperty()->GetRepresentation() != VTK_SURFACE || ren->GetSelector() != nullptr)
+  {
+    Superclass::BuildIBO(ren, act, poly);
+    return;
+  }
+
+  this->UpdateMaterialSortedPolys(poly, materialIds);
+
+  // Let the superclass build all the index buffers, the triangle one from the
+  // sorted polygons. It is only rebuilt when the sorted polygons change.
+  vtkNew<vtkPolyData> sortedPoly;
+  sortedPoly->ShallowCopy(poly);
+  sortedPoly->SetPolys(this->MaterialSortedPolys);
+  Superclass::BuildIBO(ren, act, sortedPoly);
+
+  // Polygons that could not be triangulated shift the ranges: draw the
+  // triangles at once with the per fragment materials in that case
+  size_t indexCount = 0;
+  for (size_t i = 0; i < this->MaterialSortedRanges.size(); i++)
+  {
+    indexCount += this->MaterialSortedRanges[i].IndexCount;
+  }
+  if (indexCount == this->Primitives[PrimitiveTris].IBO->IndexCount)
+  {
+    this->MaterialRanges = this->MaterialSortedRanges;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::RenderPieceDraw(vtkRenderer* ren, vtkActor* actor)
+{
+  if (this->MaterialRanges.empty() || ren->GetSelector() != nullptr)
+  {
+    Superclass::RenderPieceDraw(ren, actor);
+    return;
+  }
+
+  // Same as the superclass, except that the triangles are drawn in one call
+  // per material range of the index buffer
+  int representation = actor->GetProperty()->GetRepresentation();
+  bool drawSurfaceWithEdges = actor->GetProperty()->GetEdgeVisibility() && representation == VTK_SURFACE;
+  int numVerts = this->VBOs->GetNumberOfTuples("vertexMC");
+  for (int i = PrimitiveStart; i < (drawSurfaceWithEdges ? PrimitiveEnd : PrimitiveTriStrips + 1); i++)
+  {
+    vtkOpenGLHelper& cellBO = this->Primitives[i];
+    this->DrawingEdgesOrVertices = i > PrimitiveTriStrips;
+    if (cellBO.IBO->IndexCount == 0)
+    {
+      continue;
+    }
+
+    GLenum mode = this->GetOpenGLMode(representation, i);
+    this->UpdateShaders(cellBO, ren, actor);
+    if (mode == GL_LINES && !this->HaveWideLines(ren, actor))
+    {
+      glLineWidth(actor->GetProperty()->GetLineWidth());
+    }
+
+    cellBO.IBO->Bind();
+    if (i != PrimitiveTris)
+    {
+      glDrawRangeElements(mode, 0, static_cast<GLuint>(numVerts - 1),
+        static_cast<GLsizei>(cellBO.IBO->IndexCount), GL_UNSIGNED_INT, nullptr);
+    }
+    else
+    {
+      for (size_t r = 0; r < this->MaterialRanges.size(); r++)
+      {
+        const MaterialRange& range = this->MaterialRanges[r];
+        if (range.IndexCount == 0)
+        {
+          continue;
+        }
+
+        vtkMaterial* material = this->GetMaterial(range.MaterialId);
+        vtkOpenGLTexture* albedoTexture = material == nullptr ? nullptr :
+          vtkOpenGLTexture::SafeDownCast(actor->GetProperty()->GetTexture(material->GetAlbedoTextureName()));
+
+        // Set every uniform, so that nothing is left from the previous material
+        cellBO.Program->SetUniformi("currentMaterialHasAlbedo", albedoTexture != nullptr ? 1 : 0);
+        cellBO.Program->SetUniformi("currentMaterialAlbedoSampler2D",
+          albedoTexture != nullptr ? albedoTexture->GetTextureUnit() : 0);
+        cellBO.Program->SetUniformi("currentMaterialTCoordsId", material != nullptr ? material->GetTCoordsId() : 0);
+
+        glDrawRangeElements(mode, 0, static_cast<GLuint>(numVerts - 1),
+          static_cast<GLsizei>(range.IndexCount), GL_UNSIGNED_INT,
+          reinterpret_cast<const GLvoid*>(range.FirstIndex * sizeof(GLuint)));
+      }
+    }
+    cellBO.IBO->Release();
+
+    int stride = mode == GL_POINTS ? 1 : (mode == GL_LINES ? 2 : 3);
+    this->PrimitiveIDOffset += static_cast<int>(cellBO.IBO->IndexCount / stride);
+  }
+}
+
 //-----------------------------------------------------------------------------
 void vtkSkeletonPolyDataMapper::InsertNextMaterial(vtkMaterial* material)
 {
   material->Register(this);
   this->Materials.push_back(material);
 }
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonPolyDataMapper::GetNumberOfMaterials() const
+{
+  return static_cast<vtkIdType>(this->Materials.size());
+}
+
+//-----------------------------------------------------------------------------
+vtkMaterial* vtkSkeletonPolyDataMapper::GetMaterial(vtkIdType index)
+{
+  if (index < 0 || index >= static_cast<vtkIdType>(this->Materials.size()))
+  {
+    return nullptr;
+  }
+  return this->Materials[index];
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::CopyAnimationState(vtkSkeletonPolyDataMapper* mapper)
+{
+  this->CurrentAnimationIndex = mapper->CurrentAnimationIndex;
+  this->Frame = mapper->Frame;
+  this->Alpha = mapper->Alpha;
+  this->MorphTargetWeights = mapper->MorphTargetWeights;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::SetPoseUpdateInterval(int interval)
+{
+  this->PoseUpdateInterval = std::max(interval, 1);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPolyDataMapper::SetActiveBones(const std::vector<unsigned char>& activeBones)
+{
+  this->ActiveBones = activeBones;
+
+  // Inactive bones keep their last transform: start from a complete pose
+  this->AnimationPose->SetNumberOfTransforms(0);
+  this->SkinningPose->SetNumberOfTransforms(0);
+  this->SkinningPalette.clear();
+}
+
+//-----------------------------------------------------------------------------
+const std::vector<unsigned char>& vtkSkeletonPolyDataMapper::GetActiveBones() const
+{
+  return this->ActiveBones;
+}
@@ -21,18 +21,26 @@ PURPOSE.  See the above copyright notice for more information.
 #ifndef vtkSkeletonPolyDataMapper_h
 #define vtkSkeletonPolyDataMapper_h
 
+#include "vtkSkinningModule.h" // For export macro
 #include "vtkOpenGLPolyDataMapper.h"
 
 class vtkCallbackCommand;
+class vtkCellArray;
+class vtkDataArray;
 
 class vtkMaterial;
+class vtkSkeletonAnimation;
+class vtkSkeletonAnimationBlend;
 class vtkSkeletonAnimationStack;
 class vtkSkeletonHierarchy;
+class vtkSkeletonMorphTargets;
 class vtkSkeletonPose;
+class vtkSkinningProfiler;
 
-class vtkSkeletonPolyDataMapper : public vtkOpenGLPolyDataMapper
+class VTKSKINNING_EXPORT vtkSkeletonPolyDataMapper : public vtkOpenGLPolyDataMapper
 {
 public:
+  enum SkinningModes { VERTEX_SHADER = 0, PRE_SKINNED };
 
   static vtkSkeletonPolyDataMapper* New();
   vtkTypeMacro(vtkSkeletonPolyDataMapper, vtkOpenGLPolyDataMapper)
@@ -52,18 +60,145 @@ public:
   vtkGetMacro(CurrentAnimationIndex, vtkIdType);
   vtkSetMacro(CurrentAnimationIndex, vtkIdType);
 
+  /** When set with at least one layer, the blend node drives the pose instead of
+  * CurrentAnimationIndex/Frame. */
+  void SetAnimationBlend(vtkSkeletonAnimationBlend* blend);
+  vtkGetMacro(AnimationBlend, vtkSkeletonAnimationBlend*);
+
   vtkGetMacro(Frame, int);
   vtkSetMacro(Frame, int);
 
   vtkGetMacro(Alpha, double);
   vtkSetMacro(Alpha, double);
 
+  /** Per-stage timings of the animation/render loop. Can be shared between mappers. */
+  void SetProfiler(vtkSkinningProfiler* profiler);
+  vtkGetMacro(Profiler, vtkSkinningProfiler*);
+
   void InsertNextMaterial(vtkMaterial*);
+  vtkIdType GetNumberOfMaterials() const;
+  vtkMaterial* GetMaterial(vtkIdType index);
+
+  /** Group the triangles by material (MaterialIds point array) and issue one draw
+  * per material with its albedo texture bound, instead of resolving the material
+  * per fragment. Off by default. Only applies to the surface representation.
+  * Triangles are reordered, so cell scalars are not supported in this mode.
+  * Hardware selection passes draw the triangles in input order, so that picked
+  * cell ids stay valid. */
+  vtkGetMacro(SortByMaterial, bool);
+  vtkSetMacro(SortByMaterial, bool);
+  vtkBooleanMacro(SortByMaterial, bool);
+
+  /** Where the vertices are deformed (default VERTEX_SHADER).
+  * VERTEX_SHADER: in the vertex shader of every pass drawing the actor (depth
+  * peeling, hardware selection...), from the bone palette uniform.
+  * PRE_SKINNED: once per pose on the CPU, into the point and normal buffers.
+  * All the passes then draw the pre-deformed vertices with the default shaders,
+  * and the bone attributes and palette are not uploaded. Suited to many passes
+  * or software GL. */
+  vtkGetMacro(SkinningMode, int);
+  vtkSetClampMacro(SkinningMode, int, VERTEX_SHADER, PRE_SKINNED);
+
+  /** Copy the playback state (animation index, frame, morph target weights)
+  * of another mapper.
+  * Unlike the setters, this does not modify the mapper, so that buffer objects
+  * are not rebuilt. Used to keep the LOD mappers of an instance in sync. */
+  void CopyAnimationState(vtkSkeletonPolyDataMapper* mapper);
+
+  /** Evaluate the pose only every PoseUpdateInterval animation steps (default 1).
+  * In between, the last skinning palette is reused. Like CopyAnimationState(),
+  * the setter does not modify the mapper. */
+  vtkGetMacro(PoseUpdateInterval, int);
+  void SetPoseUpdateInterval(int interval);
+
+  /** Per-bone flags of the bones sampled from the current animation clip.
+  * The other bones keep their last local transform and are not re-evaluated.
+  * Empty (default) means all bones. */
+  void SetActiveBones(const std::vector<unsigned char>& activeBones);
+  const std::vector<unsigned char>& GetActiveBones() const;
+
+  /** Evaluate the skinning palette (global bone transforms times bind pose) for
+  * the current animation state. Does nothing when the palette is up to date, so
+  * it can be called several times per frame (bounds, rendering). */
+  void UpdateSkinningPose();
+
+  /** First half of UpdateSkinningPose(), to be called from the render thread:
+  * resolves what cannot be resolved concurrently (the current clip, which the
+  * animation stack may decode, and the evaluation order of the hierarchy).
+  * Returns true if EvaluateSkinningPose() has a pose to evaluate. */
+  bool PrepareSkinningPose();
+
+  /** Second half of UpdateSkinningPose(): evaluate the prepared pose and pack
+  * the skinning palette for upload. Only writes the poses of this mapper, so
+  * that several mappers can be evaluated in parallel (see
+  * vtkSkeletonAnimationUpdater). */
+  void EvaluateSkinningPose();
+
+  /** Number of bones from which the key lookups of a pose evaluation are split
+  * in bone ranges evaluated in parallel (default 256). */
+  vtkGetMacro(ParallelBoneThreshold, vtkIdType);
+  vtkSetMacro(ParallelBoneThreshold, vtkIdType);
+
+  /** Skinning palette of the last UpdateSkinningPose() call. */
+  vtkGetMacro(SkinningPose, vtkSkeletonPose*);
+
+  /** Skinning palette packed as row-major 3x4 float matrices (3 rows of 4 floats
+  * per bone), ready to upload to the SkeletonPalette vec4 uniform array. */
+  const std::vector<float>& GetSkinningPalette() const;
+
+  /** Global bone transforms of the last UpdateSkinningPose() call. */
+  vtkGetMacro(GlobalPose, vtkSkeletonPose*);
+
+  /** Morph targets applied to the input points and normals before skinning.
+  * Weights come from the morph weight channels of the current animation clip,
+  * and from SetMorphTargetWeight() for the targets without channel (or when an
+  * animation blend is used). Targets are applied on the CPU, only the sparse
+  * deltas of the targets with a non-zero weight are accumulated, and points
+  * and normals are uploaded again when the weights change. */
+  void SetMorphTargets(vtkSkeletonMorphTargets* morphTargets);
+  vtkGetMacro(MorphTargets, vtkSkeletonMorphTargets*);
+  void SetMorphTargetWeight(vtkIdType target, double weight);
+  double GetMorphTargetWeight(vtkIdType target) const;
+
+  /** Morph target weights applied by the last render. */
+  const std::vector<double>& GetMorphWeights() const;
+
+  /** Number of bytes sent to the GPU by the last render: skinning and texture
+  * coordinates buffers (only when their arrays were modified) and bone palette. */
+  vtkGetMacro(UploadedBytes, vtkIdType);
+
+  /** Also release the texture coordinates buffer, and forget the uploaded
+  * arrays so that they are counted again by the next render. */
+  void ReleaseGraphicsResources(vtkWindow *win) override;
 
 protected:
   vtkSkeletonPolyDataMapper();
   ~vtkSkeletonPolyDataMapper() override;
 
+  /** Bounds of the input morphed and deformed by the current pose.
+  * Computed from the per-bone bind-space bounds of the weighted points (see
+  * UpdateBoneBounds()) transformed by the skinning palette, without skinning
+  * every point. Used by frustum culling and camera reset. */
+  void ComputeBounds() override;
+
+  /** Compute the bind-space bounds of the points influenced by each bone,
+  * morph targets applied. Done once per input or morph weights modification. */
+  void UpdateBoneBounds();
+
+  /** Apply the morph targets to the input when their weights changed. */
+  void UpdateMorphedInput();
+
+  /** In PRE_SKINNED mode, skin the (morphed) input when the pose changed. */
+  void UpdateSkinnedInput();
+
+  /** Also rebuild buffer objects when the morphed input was rebuilt or the
+  * skinned points changed. */
+  bool GetNeedToRebuildBufferObjects(vtkRenderer *ren, vtkActor *act) override;
+
+  /** When only the morph target weights changed, upload the morphed points
+  * and normals to their buffers instead of rebuilding all the buffer objects. */
+  void UpdateBufferObjects(vtkRenderer *ren, vtkActor *act) override;
+
   /** Build vertex attributes before calling the superclass. */
   void BuildBufferObjects(vtkRenderer *ren, vtkActor *act) override;
 
@@ -73,6 +208,18 @@ protected:
   /** Override vtkOpenGLPolyDataMapper::SetMapperShaderParameters to handle multi material */
   void SetMapperShaderParameters(vtkOpenGLHelper &cellBO, vtkRenderer *ren, vtkActor *act) override;
 
+  /** Override vtkOpenGLPolyDataMapper::RenderPiece to reset the uploaded bytes counter */
+  void RenderPiece(vtkRenderer *ren, vtkActor *act) override;
+
+  /** Override vtkOpenGLPolyDataMapper::BuildIBO to group triangles by material */
+  void BuildIBO(vtkRenderer *ren, vtkActor *act, vtkPolyData *poly) override;
+
+  /** Group the input polygons by material into MaterialSortedPolys. */
+  void UpdateMaterialSortedPolys(vtkPolyData* poly, vtkDataArray* materialIds);
+
+  /** Override vtkOpenGLPolyDataMapper::RenderPieceDraw to draw triangles per material */
+  void RenderPieceDraw(vtkRenderer *ren, vtkActor *act) override;
+
   /** Override vtkOpenGLPolyDataMapper::HaveTextures to prevent the upload of actor texture */
   bool HaveTextures(vtkActor *actor) override;
 
@@ -88,6 +235,10 @@ protected:
   /** Handle normal skinning */
   virtual void AddShaderNormalReplacement();
 
+  /** Add the size of an array to the uploaded bytes if it was modified since the
+  * last call for the same attribute. */
+  void CountArrayUpload(const std::string& attribute, vtkDataArray* array, int destType);
+
 private:
  vtkSkeletonPolyDataMapper(const vtkSkeletonPolyDataMapper&) = delete;
   void operator=(const vtkSkeletonPolyDataMapper&) = delete;
@@ -99,7 +250,47 @@ private:
   double Alpha; //interpolation between current and next frames [0.0; 1.0]
   int Frame; // current frame pose
   vtkIdType CurrentAnimationIndex;
+  vtkSkeletonAnimationBlend* AnimationBlend;
   vtkCallbackCommand* AnimationCallbackCommand;
+  vtkSkinningProfiler* Profiler;
+
+  // Poses kept between frames so that only modified bones are re-evaluated
+  vtkSkeletonPose* AnimationPose; // Local bone transforms
+  vtkSkeletonPose* NodeGlobalPose; // Global transforms of the hierarchy nodes
+  vtkSkeletonPose* GlobalPose; // Global bone transforms
+  vtkSkeletonPose* SkinningPose; // Global bone transforms times bind pose
+
+  // State of the last skinning pose evaluation
+  vtkSkeletonAnimation* SkinningPoseAnimation; // Registered until the clip changes
+  vtkMTimeType SkinningPoseAnimationTime; // MTime of the clip, 0 when blending
+  int SkinningPoseFrame;
+  vtkMTimeType SkinningPoseBlendTime; // Layer times MTime of the blend, 0 without blend
+  vtkMTimeType SkinningPoseInputsTime;
+  int PoseUpdateInterval;
+  int PoseUpdateCounter;
+  bool PendingSkinningPose; // Prepared but not evaluated yet
+  vtkIdType ParallelBoneThreshold;
+  std::vector<unsigned char> ActiveBones;
+  vtkMTimeType SampledAnimationTime; // MTime of the clip of SampledTransforms
+  std::vector<double> SampledTransforms; // Local transforms sampled from the clip, 7 values per bone
+  std::vector<double> SampledScales; // Local scales sampled from the clip, 3 values per bone
+  std::vector<float> SkinningPalette;
+
+  std::vector<double> BoneBounds; // Bind-space bounds, 6 values per bone
+  vtkTimeStamp BoneBoundsTime;
+
+  vtkSkeletonMorphTargets* MorphTargets;
+  std::vector<double> MorphTargetWeights; // Set by SetMorphTargetWeight()
+  std::vector<double> MorphWeights; // Applied to MorphedInput
+  vtkPolyData* MorphedInput; // Input with morphed points and normals, null without morph targets
+  vtkMTimeType MorphedInputSourceTime;
+  vtkTimeStamp MorphedInputBuildTime; // Last time MorphedInput was rebuilt from the input
+  vtkTimeStamp MorphedBuffersTime; // Last upload of the morphed points and normals alone
+
+  int SkinningMode;
+  vtkPolyData* SkinnedInput; // (Morphed) input with skinned points and normals, null unless PRE_SKINNED
+  vtkMTimeType SkinnedInputSourceTime;
+  vtkMTimeType SkinnedInputPoseTime;
 
   bool IsSkinnable; // Indicates wether or not the required parameters are set to perform skinning.
 
@@ -107,7 +298,25 @@ private:
   // Textures and TCoords arays are indexed by material ids
   std::vector<vtkMaterial*> Materials;
   vtkOpenGLVertexBufferObject* VBOTCoords;
+  std::vector<std::pair<vtkDataArray*, vtkMTimeType> > VBOTCoordsArrays; // Content of VBOTCoords
   bool HaveTexturedMaterials;
+
+  // Arrays already sent to the GPU and their modification time, by attribute
+  std::map<std::string, std::pair<vtkDataArray*, vtkMTimeType> > UploadedArrays;
+  vtkIdType UploadedBytes;
+
+  // Triangle index ranges of each material when sorting by material
+  struct MaterialRange
+  {
+    int MaterialId;
+    size_t FirstIndex;
+    size_t IndexCount;
+  };
+  bool SortByMaterial;
+  std::vector<MaterialRange> MaterialRanges; // Ranges of the triangle IBO, empty when not sorted
+  vtkCellArray* MaterialSortedPolys; // Input polygons grouped by material
+  std::vector<MaterialRange> MaterialSortedRanges; // Ranges of the triangles of MaterialSortedPolys
+  vtkMTimeType MaterialSortedPolysSourceTime;
 };
 
 #endif
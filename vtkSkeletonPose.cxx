@@ -2,14 +2,299 @@
 
 #include "vtkSkeletonHierarchy.h"
 
+#include <vtkCellArray.h> // For ExtractBones
+#include <vtkDoubleArray.h>
 #include <vtkFloatArray.h>
-#include <vtkLine.h>     // For ExtractBones
+#include <vtkIntArray.h>
 #include <vtkMatrix4x4.h>
 #include <vtkMatrix3x3.h>
 #include <vtkObjectFactory.h> // For New macro
 #include <vtkPoints.h>
 #include <vtkPolyData.h> // For ExtractBones
 #include <vtkQuaternion.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Relative tolerance under which scale components are considered equal
+const double SCALE_TOLERANCE = 1e-5;
+
+// Skins the 3 components vectors of a range with the 4 weighted bones of each
+// point. Palette holds row-major 3x4 matrices. W is 1 for points and 0 for
+// directions (normals).
+template <typename T>
+struct VectorSkinner
+{
+  const T* Input;
+  const double* Weights;
+  const int* BoneIds;
+  const float* Palette;
+  const unsigned char* MovedBones; // nullptr to skin all the vectors
+  int NumberOfBones;
+  float W;
+  float* Output;
+
+  // Whether a vector is influenced by a moved bone
+  bool IsMoved(vtkIdType i) const
+  {
+    for (int b = 0; b < 4; b++)
+    {
+      int boneId = this->BoneIds[4 * i + b];
+      if (this->Weights[4 * i + b] != 0.0 && boneId >= 0 && boneId < this->NumberOfBones &&
+        this->MovedBones[boneId])
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      if (this->MovedBones != nullptr && !this->IsMoved(i))
+      {
+        continue;
+      }
+
+      const T* v = this->Input + 3 * i;
+      float x = static_cast<float>(v[0]);
+      float y = static_cast<float>(v[1]);
+      float z = static_cast<float>(v[2]);
+
+      float* out = this->Output + 3 * i;
+      out[0] = out[1] = out[2] = 0.0f;
+      for (int b = 0; b < 4; b++)
+      {
+        float weight = static_cast<float>(this->Weights[4 * i + b]);
+        int boneId = this->BoneIds[4 * i + b];
+        if (weight == 0.0f || boneId < 0 || boneId >= this->NumberOfBones)
+        {
+          continue;
+        }
+
+        const float* m = this->Palette + 12 * boneId;
+        for (int r = 0; r < 3; r++)
+        {
+          out[r] += weight * (m[4 * r] * x + m[4 * r + 1] * y + m[4 * r + 2] * z + m[4 * r + 3] * this->W);
+        }
+      }
+    }
+  }
+};
+
+template <typename T>
+void SkinTypedVectors(const T* input, vtkIdType nbPoints, vtkDoubleArray* weights, vtkIntArray* boneIds,
+  const std::vector<float>& palette, const unsigned char* movedBones, float w, float* output)
+{
+  VectorSkinner<T> skinner;
+  skinner.Input = input;
+  skinner.Weights = weights->GetPointer(0);
+  skinner.BoneIds = boneIds->GetPointer(0);
+  skinner.Palette = palette.data();
+  skinner.MovedBones = movedBones;
+  skinner.NumberOfBones = static_cast<int>(palette.size() / 12);
+  skinner.W = w;
+  skinner.Output = output;
+  vtkSMPTools::For(0, nbPoints, skinner);
+}
+
+// Scaled composition specialized on the scale mode of the operands
+template <int ScaleMode>
+void ComposeScaledTransform(const double parent[7], const double parentScale[3],
+  const double local[7], const double localScale[3], double output[7], double outputScale[3])
+{
+  if (ScaleMode == vtkSkeletonPose::NO_SCALE)
+  {
+    vtkSkeletonPose::ComposeTransform(parent, local, output);
+    return;
+  }
+
+  // The parent scale applies to the local translation
+  double scaledLocal[7];
+  std::copy(local, local + 7, scaledLocal);
+  for (int i = 0; i < 3; i++)
+  {
+    scaledLocal[i] *= parentScale[ScaleMode == vtkSkeletonPose::UNIFORM_SCALE ? 0 : i];
+    outputScale[i] = parentScale[i] * localScale[i];
+  }
+  vtkSkeletonPose::ComposeTransform(parent, scaledLocal, output);
+}
+
+// Compose the local transform of an evaluation node with its parent global
+// transform, and store the result in the node and bone global poses.
+template <int ScaleMode>
+void ComputeNodeGlobalTransform(const std::vector<vtkSkeletonHierarchy::EvaluationNode>& nodes,
+  vtkIdType index, vtkSkeletonPose* localPose, vtkSkeletonHierarchy* hierarchy,
+  vtkSkeletonPose* nodeGlobalPose, vtkSkeletonPose* globalPose)
+{
+  const bool scaled = ScaleMode != vtkSkeletonPose::NO_SCALE;
+  const vtkSkeletonHierarchy::EvaluationNode& node = nodes[index];
+
+  double localTransform[7];
+  double localScale[3] = { 1.0, 1.0, 1.0 };
+  if (node.LocalTransformId != -1 && node.LocalTransformId < localPose->GetNumberOfTransforms())
+  {
+    localPose->GetTransform(node.LocalTransformId, localTransform);
+    if (scaled)
+    {
+      localPose->GetScale(node.LocalTransformId, localScale);
+    }
+  }
+  else
+  {
+    hierarchy->GetNodeTransforms()->GetTransform(node.NodeId, localTransform);
+    if (scaled)
+    {
+      hierarchy->GetNodeTransforms()->GetScale(node.NodeId, localScale);
+    }
+  }
+
+  // Static transforms collapsed between the parent and the node
+  if (node.HasOffset)
+  {
+    double offsetTransform[7];
+    double offsetScale[3];
+    ComposeScaledTransform<ScaleMode>(node.Offset, node.OffsetScale, localTransform, localScale,
+      offsetTransform, offsetScale);
+    std::copy(offsetTransform, offsetTransform + 7, localTransform);
+    std::copy(offsetScale, offsetScale + 3, localScale);
+  }
+
+  double globalTransform[7];
+  double globalScale[3] = { 1.0, 1.0, 1.0 };
+  if (node.ParentIndex == -1)
+  {
+    // No parent, this is a global transform
+    std::copy(localTransform, localTransform + 7, globalTransform);
+    std::copy(localScale, localScale + 3, globalScale);
+  }
+  else
+  {
+    double parentTransform[7];
+    double parentScale[3] = { 1.0, 1.0, 1.0 };
+    nodeGlobalPose->GetTransform(node.ParentIndex, parentTransform);
+    if (scaled)
+    {
+      nodeGlobalPose->GetScale(node.ParentIndex, parentScale);
+    }
+    ComposeScaledTransform<ScaleMode>(parentTransform, parentScale, localTransform, localScale,
+      globalTransform, globalScale);
+  }
+
+  nodeGlobalPose->SetTransform(index, globalTransform);
+  if (scaled)
+  {
+    nodeGlobalPose->SetScale(index, globalScale);
+  }
+
+  if (node.BoneId != -1 && node.BoneId < globalPose->GetNumberOfTransforms())
+  {
+    globalPose->SetTransform(node.BoneId, globalTransform);
+    if (scaled)
+    {
+      globalPose->SetScale(node.BoneId, globalScale);
+    }
+  }
+}
+
+// Evaluate a range of evaluation nodes with the kernel of the scale mode
+void ComputeNodeGlobalTransforms(int scaleMode, const std::vector<vtkSkeletonHierarchy::EvaluationNode>& nodes,
+  vtkIdType begin, vtkIdType end, vtkSkeletonPose* localPose, vtkSkeletonHierarchy* hierarchy,
+  vtkSkeletonPose* nodeGlobalPose, vtkSkeletonPose* globalPose)
+{
+  for (vtkIdType index = begin; index < end; index++)
+  {
+    switch (scaleMode)
+    {
+      case vtkSkeletonPose::NO_SCALE:
+        ComputeNodeGlobalTransform<vtkSkeletonPose::NO_SCALE>(
+          nodes, index, localPose, hierarchy, nodeGlobalPose, globalPose);
+        break;
+      case vtkSkeletonPose::UNIFORM_SCALE:
+        ComputeNodeGlobalTransform<vtkSkeletonPose::UNIFORM_SCALE>(
+          nodes, index, localPose, hierarchy, nodeGlobalPose, globalPose);
+        break;
+      default:
+        ComputeNodeGlobalTransform<vtkSkeletonPose::NON_UNIFORM_SCALE>(
+          nodes, index, localPose, hierarchy, nodeGlobalPose, globalPose);
+        break;
+    }
+  }
+}
+
+// Products of two poses packed as row-major 3x4 float matrices
+template <int ScaleMode>
+void MultiplyToPaletteKernel(vtkSkeletonPose* skeleton_1, vtkSkeletonPose* skeleton_2,
+  vtkSkeletonPose* outputPose, float* palette)
+{
+  const bool scaled = ScaleMode != vtkSkeletonPose::NO_SCALE;
+  vtkIdType nbTransforms = skeleton_1->GetNumberOfTransforms();
+
+  for (vtkIdType k = 0; k < nbTransforms; ++k)
+  {
+    double transform_1[7];
+    double transform_2[7];
+    skeleton_1->GetTransform(k, transform_1);
+    skeleton_2->GetTransform(k, transform_2);
+
+    double scale_1[3] = { 1.0, 1.0, 1.0 };
+    double scale_2[3] = { 1.0, 1.0, 1.0 };
+    if (scaled)
+    {
+      skeleton_1->GetScale(k, scale_1);
+      skeleton_2->GetScale(k, scale_2);
+    }
+
+    double transform[7];
+    double scale[3] = { 1.0, 1.0, 1.0 };
+    ComposeScaledTransform<ScaleMode>(transform_1, scale_1, transform_2, scale_2, transform, scale);
+    outputPose->SetTransform(k, transform);
+    if (scaled)
+    {
+      outputPose->SetScale(k, scale);
+    }
+
+    // Rotation of the (possibly not normalized) wxyz quaternion
+    double w = transform[3];
+    double x = transform[4];
+    double y = transform[5];
+    double z = transform[6];
+    double norm2 = w * w + x * x + y * y + z * z;
+    double s = norm2 > 0.0 ? 2.0 / norm2 : 0.0;
+
+    double rows[3][3] = {
+      { 1.0 - s * (y * y + z * z), s * (x * y - w * z), s * (x * z + w * y) },
+      { s * (x * y + w * z), 1.0 - s * (x * x + z * z), s * (y * z - w * x) },
+      { s * (x * z - w * y), s * (y * z + w * x), 1.0 - s * (x * x + y * y) }
+    };
+
+    float* matrix = palette + 12 * k;
+    for (int i = 0; i < 3; i++)
+    {
+      for (int j = 0; j < 3; j++)
+      {
+        // Rotation times the scale matrix: column j is scaled by scale[j]
+        double value = rows[i][j];
+        if (ScaleMode == vtkSkeletonPose::UNIFORM_SCALE)
+        {
+          value *= scale[0];
+        }
+        else if (ScaleMode == vtkSkeletonPose::NON_UNIFORM_SCALE)
+        {
+          value *= scale[j];
+        }
+        matrix[4 * i + j] = static_cast<float>(value);
+      }
+      matrix[4 * i + 3] = static_cast<float>(transform[i]);
+    }
+  }
+}
+}
 
 //-----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSkeletonPose)
@@ -19,12 +304,17 @@ vtkSkeletonPose::vtkSkeletonPose()
 {
   this->Transforms = vtkFloatArray::New();
   this->Transforms->SetNumberOfComponents(7);
+  this->Scales = vtkFloatArray::New();
+  this->Scales->SetNumberOfComponents(3);
+  this->ScaleMode = NO_SCALE;
+  this->RestTransformsAnimationTime = 0;
 }
 
 //-----------------------------------------------------------------------------
 vtkSkeletonPose::~vtkSkeletonPose()
 {
   this->Transforms->Delete();
+  this->Scales->Delete();
 }
 
 //-----------------------------------------------------------------------------
@@ -33,6 +323,24 @@ void vtkSkeletonPose::SetNumberOfTransforms(vtkIdType nbBones)
   this->Transforms->Initialize();
   this->Transforms->SetNumberOfComponents(7);
   this->Transforms->SetNumberOfTuples(nbBones);
+  this->RestTransformsAnimationTime = 0;
+
+  if (this->ScaleMode != NO_SCALE)
+  {
+    this->Scales->SetNumberOfTuples(nbBones);
+    this->Scales->FillComponent(0, 1.0);
+    this->Scales->FillComponent(1, 1.0);
+    this->Scales->FillComponent(2, 1.0);
+  }
+
+  this->TransformModified.assign(nbBones, 1);
+  this->ModifiedTransformIds.resize(nbBones);
+  for (vtkIdType i = 0; i < nbBones; i++)
+  {
+    this->ModifiedTransformIds[i] = i;
+  }
+
+  this->Modified();
 }
 
 //-----------------------------------------------------------------------------
@@ -42,15 +350,120 @@ vtkIdType vtkSkeletonPose::GetNumberOfTransforms() const
 }
 
 //-----------------------------------------------------------------------------
-double* vtkSkeletonPose::GetTransform(vtkIdType index)
+vtkMTimeType vtkSkeletonPose::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  mTime = std::max(mTime, this->Transforms->GetMTime());
+  return std::max(mTime, this->Scales->GetMTime());
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::SetScaleMode(int mode)
+{
+  mode = std::max(static_cast<int>(NO_SCALE), std::min(mode, static_cast<int>(NON_UNIFORM_SCALE)));
+  if (this->ScaleMode == mode)
+  {
+    return;
+  }
+
+  if (mode == NO_SCALE)
+  {
+    this->Scales->SetNumberOfTuples(0);
+  }
+  else if (this->ScaleMode == NO_SCALE)
+  {
+    vtkIdType nbTransforms = this->GetNumberOfTransforms();
+    this->Scales->SetNumberOfTuples(nbTransforms);
+    this->Scales->FillComponent(0, 1.0);
+    this->Scales->FillComponent(1, 1.0);
+    this->Scales->FillComponent(2, 1.0);
+  }
+
+  this->ScaleMode = mode;
+  this->RestTransformsAnimationTime = 0;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::GetScale(vtkIdType index, double scale[3]) const
+{
+  if (this->ScaleMode == NO_SCALE)
+  {
+    scale[0] = scale[1] = scale[2] = 1.0;
+    return;
+  }
+  this->Scales->GetTuple(index, scale);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::SetScale(vtkIdType index, const double scale[3])
+{
+  if (this->ScaleMode == NO_SCALE)
+  {
+    return;
+  }
+
+  float* current = this->Scales->GetPointer(3 * index);
+  for (int i = 0; i < 3; i++)
+  {
+    if (current[i] != static_cast<float>(scale[i]))
+    {
+      current[0] = static_cast<float>(scale[0]);
+      current[1] = static_cast<float>(scale[1]);
+      current[2] = static_cast<float>(scale[2]);
+      this->Scales->Modified();
+      this->MarkTransformModified(index);
+      return;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkeletonPose::ClassifyScale(const double scale[3])
 {
-  return this->Transforms->GetTuple(index);
+  double maxScale = std::max(std::abs(scale[0]), std::max(std::abs(scale[1]), std::abs(scale[2])));
+  double tolerance = SCALE_TOLERANCE * std::max(maxScale, 1.0);
+
+  if (std::abs(scale[0] - scale[1]) > tolerance || std::abs(scale[0] - scale[2]) > tolerance)
+  {
+    return NON_UNIFORM_SCALE;
+  }
+  if (std::abs(scale[0] - 1.0) > tolerance)
+  {
+    return UNIFORM_SCALE;
+  }
+  return NO_SCALE;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::GetTransform(vtkIdType index, double transform[7]) const
+{
+  this->Transforms->GetTuple(index, transform);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::GetPosition(vtkIdType index, double position[3]) const
+{
+  const float* transform = this->Transforms->GetPointer(7 * index);
+  position[0] = transform[0];
+  position[1] = transform[1];
+  position[2] = transform[2];
 }
 
 //-----------------------------------------------------------------------------
 void vtkSkeletonPose::SetTransform(vtkIdType index, double* transform)
 {
-  this->Transforms->SetTuple(index, transform);
+  float* current = this->Transforms->GetPointer(7 * index);
+  for (int i = 0; i < 7; i++)
+  {
+    if (current[i] != static_cast<float>(transform[i]))
+    {
+      this->Transforms->SetTuple(index, transform);
+      this->Transforms->Modified();
+      this->MarkTransformModified(index);
+      return;
+    }
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -59,13 +472,20 @@ void vtkSkeletonPose::SetTransform(vtkIdType index, double* position, double* or
   double transform[7] = { position[0], position[1], position[2],
     orientation[0], orientation[1], orientation[2], orientation[3] };
 
-  this->Transforms->SetTuple(index, transform);
+  this->SetTransform(index, transform);
 }
 
 //-----------------------------------------------------------------------------
 void vtkSkeletonPose::InsertNextTransform(double* transform)
 {
-  this->Transforms->InsertNextTuple(transform);
+  vtkIdType index = this->Transforms->InsertNextTuple(transform);
+  if (this->ScaleMode != NO_SCALE)
+  {
+    this->Scales->InsertNextTuple3(1.0, 1.0, 1.0);
+  }
+  this->TransformModified.resize(index + 1, 0);
+  this->MarkTransformModified(index);
+  this->Modified();
 }
 
 //-----------------------------------------------------------------------------
@@ -74,13 +494,53 @@ void vtkSkeletonPose::InsertNextTransform(double* position, double* orientation)
   double transform[7] = { position[0], position[1], position[2],
     orientation[0], orientation[1], orientation[2], orientation[3] };
 
-  this->Transforms->InsertNextTuple(transform);
+  this->InsertNextTransform(transform);
 }
 
 //-----------------------------------------------------------------------------
-void vtkSkeletonPose::GetTransformMatrix(vtkIdType index, double* transformMatrix)
+bool vtkSkeletonPose::IsTransformModified(vtkIdType index) const
 {
-  double* boneTransform = this->Transforms->GetTuple(index);
+  return this->TransformModified[index] != 0;
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonPose::GetNumberOfModifiedTransforms() const
+{
+  return static_cast<vtkIdType>(this->ModifiedTransformIds.size());
+}
+
+//-----------------------------------------------------------------------------
+const std::vector<vtkIdType>& vtkSkeletonPose::GetModifiedTransformIds() const
+{
+  return this->ModifiedTransformIds;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::MarkTransformModified(vtkIdType index)
+{
+  if (this->TransformModified[index])
+  {
+    return;
+  }
+  this->TransformModified[index] = 1;
+  this->ModifiedTransformIds.push_back(index);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::ClearModifiedTransforms()
+{
+  for (size_t i = 0; i < this->ModifiedTransformIds.size(); i++)
+  {
+    this->TransformModified[this->ModifiedTransformIds[i]] = 0;
+  }
+  this->ModifiedTransformIds.clear();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::GetTransformMatrix(vtkIdType index, double* transformMatrix) const
+{
+  double boneTransform[7];
+  this->Transforms->GetTuple(index, boneTransform);
 
   vtkQuaternion<double> boneTransformQ;
   boneTransformQ.Set(boneTransform[3], boneTransform[4], boneTransform[5], boneTransform[6]);
@@ -106,6 +566,46 @@ void vtkSkeletonPose::GetTransformMatrix(vtkIdType index, double* transformMatri
   transformMatrix[15] = 1.0;
 }
 
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::ComposeTransform(const double parent[7], const double local[7], double output[7])
+{
+  double parentOrientation[4] = { parent[3], parent[4], parent[5], parent[6] };
+  double localOrientation[4] = { local[3], local[4], local[5], local[6] };
+
+  // Compute global position
+  double position[3];
+  vtkMath::RotateVectorByNormalizedQuaternion(local,
+    vtkQuaternion<double>(parentOrientation).Normalized().GetData(), position);
+
+  // Compute global orientation
+  double orientation[4];
+  vtkMath::MultiplyQuaternion(parentOrientation, localOrientation, orientation);
+
+  for (int i = 0; i < 3; i++)
+  {
+    output[i] = position[i] + parent[i];
+  }
+  for (int i = 0; i < 4; i++)
+  {
+    output[3 + i] = orientation[i];
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::ComposeTransform(const double parent[7], const double parentScale[3],
+  const double local[7], const double localScale[3], double output[7], double outputScale[3])
+{
+  ComposeScaledTransform<NON_UNIFORM_SCALE>(parent, parentScale, local, localScale, output, outputScale);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::GetIdentityTransform(double transform[7])
+{
+  transform[0] = transform[1] = transform[2] = 0.0;
+  transform[3] = 1.0;
+  transform[4] = transform[5] = transform[6] = 0.0;
+}
+
 //-----------------------------------------------------------------------------
 void vtkSkeletonPose::ComputeGlobalPose(vtkSkeletonPose* localPose, vtkSkeletonHierarchy* hierarchy, vtkSkeletonPose* globalPose)
 {
@@ -114,61 +614,106 @@ void vtkSkeletonPose::ComputeGlobalPose(vtkSkeletonPose* localPose, vtkSkeletonH
     return;
   }
 
-  globalPose->SetNumberOfTransforms(localPose->GetNumberOfTransforms());
-
-  vtkNew<vtkSkeletonPose> hierarchyPoseGC;
-
-  for (int i = 0; i < hierarchy->GetNumberOfNodes(); i++)
+  if (globalPose->GetNumberOfTransforms() != localPose->GetNumberOfTransforms())
   {
-    double nodeGlobalPosition[3] = { 0, 0, 0 };
-    double nodeGlobalOrientation[4] = { 1.0, 0, 0, 0 };
+    globalPose->SetNumberOfTransforms(localPose->GetNumberOfTransforms());
+  }
 
-    int parentId = hierarchy->GetParentId(i);
-    vtkIdType boneId = hierarchy->GetNodeTypes()->GetTuple1(i);
+  const std::vector<vtkSkeletonHierarchy::EvaluationNode>& nodes = hierarchy->GetEvaluationNodes();
+  vtkIdType nbNodes = static_cast<vtkIdType>(nodes.size());
 
-    if (parentId == -1)
-    {
-      // No parent, this is a global transform
-      hierarchyPoseGC->InsertNextTransform(hierarchy->GetNodeTransforms()->GetTransform(i));
+  int scaleMode = std::max(localPose->GetScaleMode(), hierarchy->GetNodeTransforms()->GetScaleMode());
+  globalPose->SetScaleMode(scaleMode);
 
-      if (boneId != -1)
-      {
-        globalPose->SetTransform(boneId, hierarchy->GetNodeTransforms()->GetTransform(i));
-      }
-      continue;
-    }
+  vtkNew<vtkSkeletonPose> nodeGlobalPose;
+  nodeGlobalPose->SetScaleMode(scaleMode);
+  nodeGlobalPose->SetNumberOfTransforms(nbNodes);
 
-    double* nodeLocalTransform = hierarchy->GetNodeTransforms()->GetTransform(i);
+  ComputeNodeGlobalTransforms(scaleMode, nodes, 0, nbNodes, localPose, hierarchy, nodeGlobalPose, globalPose);
+}
 
-    if (boneId != -1)
-    {
-      nodeLocalTransform = localPose->GetTransform(boneId);
-    }
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkeletonPose::UpdateGlobalPose(vtkSkeletonPose* localPose, vtkSkeletonHierarchy* hierarchy,
+  vtkSkeletonPose* nodeGlobalPose, vtkSkeletonPose* globalPose)
+{
+  if (hierarchy->GetNumberOfNodes() <= 0 || localPose->GetNumberOfTransforms() <= 0)
+  {
+    return 0;
+  }
 
-    double nodeLocalOrientation[4] = { nodeLocalTransform[3], nodeLocalTransform[4], nodeLocalTransform[5], nodeLocalTransform[6] };
-    double nodeLocalPosition[3] = { nodeLocalTransform[0], nodeLocalTransform[1], nodeLocalTransform[2] };
+  // A resized (or rescaled) global pose has entries that no modified
+  // transform would recompute
+  bool globalPoseReset = false;
+  if (globalPose->GetNumberOfTransforms() != localPose->GetNumberOfTransforms())
+  {
+    globalPose->SetNumberOfTransforms(localPose->GetNumberOfTransforms());
+    globalPoseReset = true;
+  }
 
-    double* nodeGlobalParentTransform = hierarchyPoseGC->GetTransform(parentId);
-    double nodeGlobalParentOrientation[4] = { nodeGlobalParentTransform[3], nodeGlobalParentTransform[4], nodeGlobalParentTransform[5], nodeGlobalParentTransform[6] };
-    double nodeGlobalParentPosition[3] = { nodeGlobalParentTransform[0], nodeGlobalParentTransform[1], nodeGlobalParentTransform[2] };
+  const std::vector<vtkSkeletonHierarchy::EvaluationNode>& nodes = hierarchy->GetEvaluationNodes();
+  vtkIdType nbNodes = static_cast<vtkIdType>(nodes.size());
+  vtkIdType nbComputedNodes = 0;
 
-    // Compute node global position
-    vtkMath::RotateVectorByNormalizedQuaternion(nodeLocalPosition, vtkQuaternion<double>(nodeGlobalParentOrientation).Normalized().GetData(), nodeGlobalPosition);
-    nodeGlobalPosition[0] += nodeGlobalParentPosition[0];
-    nodeGlobalPosition[1] += nodeGlobalParentPosition[1];
-    nodeGlobalPosition[2] += nodeGlobalParentPosition[2];
+  int scaleMode = std::max(localPose->GetScaleMode(), hierarchy->GetNodeTransforms()->GetScaleMode());
+  if (globalPose->GetScaleMode() != scaleMode)
+  {
+    globalPose->SetScaleMode(scaleMode);
+    globalPoseReset = true;
+  }
 
-    // Compute node global orientation
-    vtkMath::MultiplyQuaternion(nodeGlobalParentOrientation, nodeLocalOrientation, nodeGlobalOrientation);
+  // Full evaluation when the caches do not match the hierarchy anymore
+  if (globalPoseReset || nodeGlobalPose->GetNumberOfTransforms() != nbNodes ||
+    nodeGlobalPose->GetScaleMode() != scaleMode ||
+    nodeGlobalPose->GetMTime() < hierarchy->GetMTime())
+  {
+    nodeGlobalPose->SetScaleMode(scaleMode);
+    if (nodeGlobalPose->GetNumberOfTransforms() != nbNodes)
+    {
+      nodeGlobalPose->SetNumberOfTransforms(nbNodes);
+    }
+
+    ComputeNodeGlobalTransforms(scaleMode, nodes, 0, nbNodes, localPose, hierarchy, nodeGlobalPose, globalPose);
+    nbComputedNodes = nbNodes;
 
-    // Store global transform
-    hierarchyPoseGC->InsertNextTransform(nodeGlobalPosition, nodeGlobalOrientation);
+    nodeGlobalPose->Modified();
+  }
+  else
+  {
+    // Evaluation nodes of the modified bones, in evaluation order
+    std::vector<vtkIdType> modifiedIndices;
+    const std::vector<vtkIdType>& modifiedIds = localPose->GetModifiedTransformIds();
+    modifiedIndices.reserve(modifiedIds.size());
+    for (size_t i = 0; i < modifiedIds.size(); i++)
+    {
+      vtkIdType index = hierarchy->GetBoneEvaluationIndex(modifiedIds[i]);
+      if (index != -1)
+      {
+        modifiedIndices.push_back(index);
+      }
+    }
+    std::sort(modifiedIndices.begin(), modifiedIndices.end());
 
-    if (boneId != -1)
+    // Recompute each modified subtree once, skipping the nested ones
+    vtkIdType subtreeEnd = 0;
+    for (size_t i = 0; i < modifiedIndices.size(); i++)
     {
-      globalPose->SetTransform(boneId, nodeGlobalPosition, nodeGlobalOrientation);
+      vtkIdType subtreeStart = modifiedIndices[i];
+      if (subtreeStart < subtreeEnd)
+      {
+        continue;
+      }
+
+      subtreeEnd = nodes[subtreeStart].SubtreeEnd;
+      ComputeNodeGlobalTransforms(scaleMode, nodes, subtreeStart, subtreeEnd,
+        localPose, hierarchy, nodeGlobalPose, globalPose);
+      nbComputedNodes += subtreeEnd - subtreeStart;
     }
   }
+
+  localPose->ClearModifiedTransforms();
+  nodeGlobalPose->ClearModifiedTransforms();
+
+  return nbComputedNodes;
 }
 
 //-----------------------------------------------------------------------------
@@ -187,16 +732,23 @@ void vtkSkeletonPose::Multiply(vtkSkeletonPose* skeleton_1, vtkSkeletonPose* ske
     return;
   }
 
+  if (outputPose->GetNumberOfTransforms() != skeleton_1->GetNumberOfTransforms())
+  {
+    outputPose->SetNumberOfTransforms(skeleton_1->GetNumberOfTransforms());
+  }
+
   for (int k = 0; k < skeleton_1->GetNumberOfTransforms(); ++k)
   {
     double bonePosition[3] = { 0, 0, 0 };
     double boneOrientation[4] = { 1, 0, 0, 0 };
 
-    double* boneTransform_1 = skeleton_1->GetTransform(k);
+    double boneTransform_1[7];
+    skeleton_1->GetTransform(k, boneTransform_1);
     double boneOrientation_1[4] = { boneTransform_1[3], boneTransform_1[4], boneTransform_1[5], boneTransform_1[6] };
     double bonePosition_1[3] = { boneTransform_1[0], boneTransform_1[1], boneTransform_1[2] };
 
-    double* boneTransform_2 = skeleton_2->GetTransform(k);
+    double boneTransform_2[7];
+    skeleton_2->GetTransform(k, boneTransform_2);
     double boneOrientation_2[4] = { boneTransform_2[3], boneTransform_2[4], boneTransform_2[5], boneTransform_2[6] };
     double bonePosition_2[3] = { boneTransform_2[0], boneTransform_2[1], boneTransform_2[2] };
 
@@ -209,7 +761,40 @@ void vtkSkeletonPose::Multiply(vtkSkeletonPose* skeleton_1, vtkSkeletonPose* ske
     // Compute bone orientation
     vtkMath::MultiplyQuaternion(boneOrientation_1, boneOrientation_2, boneOrientation);
 
-    outputPose->InsertNextTransform(bonePosition, boneOrientation);
+    outputPose->SetTransform(k, bonePosition, boneOrientation);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::MultiplyToPalette(vtkSkeletonPose* skeleton_1, vtkSkeletonPose* skeleton_2,
+  vtkSkeletonPose* outputPose, std::vector<float>& palette)
+{
+  if (skeleton_1->GetNumberOfTransforms() != skeleton_2->GetNumberOfTransforms())
+  {
+    return;
+  }
+
+  int scaleMode = std::max(skeleton_1->GetScaleMode(), skeleton_2->GetScaleMode());
+  outputPose->SetScaleMode(scaleMode);
+
+  vtkIdType nbTransforms = skeleton_1->GetNumberOfTransforms();
+  if (outputPose->GetNumberOfTransforms() != nbTransforms)
+  {
+    outputPose->SetNumberOfTransforms(nbTransforms);
+  }
+  palette.resize(12 * nbTransforms);
+
+  switch (scaleMode)
+  {
+    case NO_SCALE:
+      MultiplyToPaletteKernel<NO_SCALE>(skeleton_1, skeleton_2, outputPose, palette.data());
+      break;
+    case UNIFORM_SCALE:
+      MultiplyToPaletteKernel<UNIFORM_SCALE>(skeleton_1, skeleton_2, outputPose, palette.data());
+      break;
+    default:
+      MultiplyToPaletteKernel<NON_UNIFORM_SCALE>(skeleton_1, skeleton_2, outputPose, palette.data());
+      break;
   }
 }
 
@@ -221,13 +806,20 @@ void vtkSkeletonPose::Interpolate(vtkSkeletonPose* skeleton_1, vtkSkeletonPose*
     return;
   }
 
+  if (outputPose->GetNumberOfTransforms() != skeleton_1->GetNumberOfTransforms())
+  {
+    outputPose->SetNumberOfTransforms(skeleton_1->GetNumberOfTransforms());
+  }
+
   for (int k = 0; k < skeleton_1->GetNumberOfTransforms(); ++k)
   {
-    double* boneTransform_1 = skeleton_1->GetTransform(k);
+    double boneTransform_1[7];
+    skeleton_1->GetTransform(k, boneTransform_1);
     double boneOrientation_1[4] = { boneTransform_1[3], boneTransform_1[4], boneTransform_1[5], boneTransform_1[6] };
     double bonePosition_1[3] = { boneTransform_1[0], boneTransform_1[1], boneTransform_1[2] };
 
-    double* boneTransform_2 = skeleton_2->GetTransform(k);
+    double boneTransform_2[7];
+    skeleton_2->GetTransform(k, boneTransform_2);
     double boneOrientation_2[4] = { boneTransform_2[3], boneTransform_2[4], boneTransform_2[5], boneTransform_2[6] };
     double bonePosition_2[3] = { boneTransform_2[0], boneTransform_2[1], boneTransform_2[2] };
 
@@ -243,7 +835,7 @@ void vtkSkeletonPose::Interpolate(vtkSkeletonPose* skeleton_1, vtkSkeletonPose*
     vtkQuaternion<double> orientationQ_2(boneOrientation_2);
     vtkQuaternion<double> boneOrientation = orientationQ_1.Slerp(alpha, orientationQ_2);
 
-    outputPose->InsertNextTransform(bonePosition, boneOrientation.GetData());
+    outputPose->SetTransform(k, bonePosition, boneOrientation.GetData());
   }
 }
 
@@ -264,33 +856,61 @@ void vtkSkeletonPose::ExtractBones(vtkSkeletonPose* skeleton, vtkSkeletonHierarc
   {
     vtkIdType parent = hierarchy->GetParentId(k);
 
-    vtkIdType boneId = hierarchy->GetNodeTypes()->GetTuple1(k);
+    vtkIdType boneId = hierarchy->GetNodeBoneId(k);
     vtkIdType pointId = -1;
     vtkIdType parentId = -1;
 
     lastBonePointId = pointId;
     if (boneId == -1)
     {
-      double* transform = hierarchy->GetNodeTransforms()->GetTransform(k);
-      pointId = points->InsertNextPoint(transform[0], transform[1], transform[2]);
+      double position[3];
+      hierarchy->GetNodeTransforms()->GetPosition(k, position);
+      pointId = points->InsertNextPoint(position);
 
       continue;
     }
 
-    double* transform = globalPose->GetTransform(boneId);
-    pointId = points->InsertNextPoint(transform[0], transform[1], transform[2]);
+    double position[3];
+    globalPose->GetPosition(boneId, position);
+    pointId = points->InsertNextPoint(position);
 
-    if (parent == -1 || hierarchy->GetNodeTypes()->GetTuple1(parent) == -1)
+    if (parent == -1 || hierarchy->GetNodeBoneId(parent) == -1)
     {
       continue;
     }
 
-    vtkNew<vtkLine> bone;
-    bone->GetPointIds()->SetId(0, parent);
-    bone->GetPointIds()->SetId(1, pointId);
-    lines->InsertNextCell(bone);
+    lines->InsertNextCell(2);
+    lines->InsertCellPoint(parent);
+    lines->InsertCellPoint(pointId);
   }
 
   output->SetPoints(points);
   output->SetLines(lines);
 }
+
+//-----------------------------------------------------------------------------
+void vtkSkeletonPose::SkinVectors(vtkDataArray* input, vtkDoubleArray* weights, vtkIntArray* boneIds,
+  const std::vector<float>& palette, double w, vtkFloatArray* output, const unsigned char* movedBones)
+{
+  if (input == nullptr || weights == nullptr || boneIds == nullptr || output == nullptr ||
+    input->GetNumberOfComponents() != 3 || weights->GetNumberOfComponents() != 4 ||
+    boneIds->GetNumberOfComponents() != 4)
+  {
+    return;
+  }
+
+  vtkIdType nbTuples = input->GetNumberOfTuples();
+  if (output->GetNumberOfComponents() != 3 || output->GetNumberOfTuples() != nbTuples)
+  {
+    output->SetNumberOfComponents(3);
+    output->SetNumberOfTuples(nbTuples);
+    movedBones = nullptr;
+  }
+
+  switch (input->GetDataType())
+  {
+    vtkTemplateMacro(SkinTypedVectors(static_cast<const VTK_TT*>(input->GetVoidPointer(0)), nbTuples,
+      weights, boneIds, palette, movedBones, static_cast<float>(w), output->GetPointer(0)));
+  }
+  output->Modified();
+}
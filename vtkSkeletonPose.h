@@ -18,25 +18,51 @@ PURPOSE.  See the above copyright notice for more information.
 * Array of transforms internally stored as chunks of 7 float in a vtkFloatArray.
 * The first 3 values of the 7-tuples transform correspond to an xyz position
 * whereas the last 4 values correspond to a wxyz quaternion.
+*
+* The pose keeps track of the transforms that changed since the last call to
+* ClearModifiedTransforms(): SetTransform() only flags a transform when its
+* value actually changes. UpdateGlobalPose() relies on these flags to only
+* recompute the subtrees of modified bones.
+*
+* Transforms can also carry a scale, stored apart from the 7-tuples. The
+* scale mode tells what the scales can be, so that the kernels (global pose,
+* palette) are specialized at compile time and unscaled rigs, the common case,
+* do not pay for scale support:
+* - NO_SCALE: no scale is stored, all scales are 1 (default),
+* - UNIFORM_SCALE: the 3 components of each scale are equal,
+* - NON_UNIFORM_SCALE: any scale. Scales are composed per component, without
+*   the shear a non-uniform parent scale gives a rotated child.
+* A scaled transform applies the scale, then the rotation, then the translation.
 */
 
 #ifndef vtkSkeletonPose_h
 #define vtkSkeletonPose_h
 
+#include "vtkSkinningModule.h" // For export macro
 #include "vtkObject.h"
 
+#include <vector>
+
 class vtkSkeletonHierarchy;
 
+class vtkDataArray;
+class vtkDoubleArray;
 class vtkFloatArray;
+class vtkIntArray;
 class vtkPolyData;
 
-class vtkSkeletonPose : public vtkObject
+class VTKSKINNING_EXPORT vtkSkeletonPose : public vtkObject
 {
 public:
+  enum ScaleModes { NO_SCALE = 0, UNIFORM_SCALE, NON_UNIFORM_SCALE };
+
   static vtkSkeletonPose* New();
   vtkTypeMacro(vtkSkeletonPose, vtkObject)
 
-  double* GetTransform(vtkIdType index);
+  /** Copy a transform in caller storage. Reads of a pose are reentrant: const
+  * methods can be called from several threads as long as no thread modifies it. */
+  void GetTransform(vtkIdType index, double transform[7]) const;
+  void GetPosition(vtkIdType index, double position[3]) const;
   void SetTransform(vtkIdType index, double* transform);
   void SetTransform(vtkIdType index, double* position, double* orientation);
 
@@ -46,10 +72,59 @@ public:
   void SetNumberOfTransforms(vtkIdType nbBones);
   vtkIdType GetNumberOfTransforms() const;
 
-  void GetTransformMatrix(vtkIdType index, double* transformMatrix);
+  /** Scale mode of the pose (default NO_SCALE). Switching to a scaled mode
+  * initializes the scales to 1, switching to NO_SCALE drops them. */
+  vtkGetMacro(ScaleMode, int);
+  void SetScaleMode(int mode);
+
+  /** MTime of the vtkSkeletonAnimation whose rest transforms the pose holds
+  * for the nodes without keys, 0 if none. Set by
+  * vtkSkeletonAnimation::ComputeInterpolatedPose() so that they are only
+  * written once. Reset by SetNumberOfTransforms() and scale mode changes; other
+  * writers of the pose must reset it. */
+  vtkGetMacro(RestTransformsAnimationTime, vtkMTimeType);
+  vtkSetMacro(RestTransformsAnimationTime, vtkMTimeType);
+
+  /** Scale of a transform. Always 1 in NO_SCALE mode, where SetScale() is ignored. */
+  void GetScale(vtkIdType index, double scale[3]) const;
+  void SetScale(vtkIdType index, const double scale[3]);
+
+  /** Smallest scale mode able to represent the given scale. */
+  static int ClassifyScale(const double scale[3]);
+
+  void GetTransformMatrix(vtkIdType index, double* transformMatrix) const;
+
+  /** Include the MTime of the internal array. */
+  vtkMTimeType GetMTime() override;
+
+  /** Modified transforms tracking. */
+  bool IsTransformModified(vtkIdType index) const;
+  vtkIdType GetNumberOfModifiedTransforms() const;
+  const std::vector<vtkIdType>& GetModifiedTransformIds() const;
+  void MarkTransformModified(vtkIdType index);
+  void ClearModifiedTransforms();
+
+  /** Compose two transforms: output = parent * local. */
+  static void ComposeTransform(const double parent[7], const double local[7], double output[7]);
+
+  /** Compose two scaled transforms (see the class description). */
+  static void ComposeTransform(const double parent[7], const double parentScale[3],
+    const double local[7], const double localScale[3], double output[7], double outputScale[3]);
+
+  static void GetIdentityTransform(double transform[7]);
 
   static void ComputeGlobalPose(vtkSkeletonPose* localPose, vtkSkeletonHierarchy* structure, vtkSkeletonPose* globalPose);
 
+  /** Incremental version of ComputeGlobalPose.
+  * nodeGlobalPose caches the global transform of every evaluation node of the
+  * hierarchy between calls and must not be shared. Only the subtrees of the
+  * modified transforms of localPose are recomputed, then localPose modified
+  * flags are cleared. A full evaluation is done when the hierarchy changed or
+  * when globalPose is resized or changes scale mode.
+  * Returns the number of recomputed nodes. */
+  static vtkIdType UpdateGlobalPose(vtkSkeletonPose* localPose, vtkSkeletonHierarchy* hierarchy,
+    vtkSkeletonPose* nodeGlobalPose, vtkSkeletonPose* globalPose);
+
   /** Take the inverse of the frame (used to compute the inversed bind pose frames). */
   //static vtkSkeletonPose* Inverse(vtkSkeletonPose* skeleton);
 
@@ -57,6 +132,22 @@ public:
   *  The two skeleton must have the same number of bones.  */
   static void Multiply(vtkSkeletonPose* skeleton_1, vtkSkeletonPose* skeleton_2, vtkSkeletonPose* outputPose);
 
+  /** Multiply() fused with the packing of the products as a GPU-ready skinning
+  * palette: 12 floats per transform, the 3 rows of the row-major 3x4 matrix.
+  * The scale mode of outputPose is the widest of the two inputs. */
+  static void MultiplyToPalette(vtkSkeletonPose* skeleton_1, vtkSkeletonPose* skeleton_2,
+    vtkSkeletonPose* outputPose, std::vector<float>& palette);
+
+  /** CPU skinning of 3 components vectors with a palette of MultiplyToPalette():
+  * each output tuple is the sum of the transformed input tuple by its 4 weighted
+  * bones. w is 1 for points and 0 for directions (normals). output is resized.
+  * movedBones optionally flags the bones of the palette that changed since
+  * output was skinned from the same input: only the tuples they influence are
+  * skinned again. It is ignored when output has to be resized. */
+  static void SkinVectors(vtkDataArray* input, vtkDoubleArray* weights, vtkIntArray* boneIds,
+    const std::vector<float>& palette, double w, vtkFloatArray* output,
+    const unsigned char* movedBones = nullptr);
+
   /** Interpolate each bone frames of the input skeletons between the two poses given an alpha interpolated value.
   * alpha is supposed to be between [0,1]. */
   static void Interpolate(vtkSkeletonPose* skeleton_1, vtkSkeletonPose* skeleton_2, float alpha, vtkSkeletonPose* outputPose);
@@ -72,6 +163,12 @@ private:
   void operator=(const vtkSkeletonPose&) = delete;
 
   vtkFloatArray* Transforms;
+  vtkFloatArray* Scales; // 3 components per transform, empty in NO_SCALE mode
+  int ScaleMode;
+  vtkMTimeType RestTransformsAnimationTime;
+
+  std::vector<unsigned char> TransformModified;
+  std::vector<vtkIdType> ModifiedTransformIds;
 };
 
 #endif
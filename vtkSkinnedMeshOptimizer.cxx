@@ -0,0 +1,399 @@
+#include "vtkSkinnedMeshOptimizer.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h> // For New macro
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Forsyth scoring parameters
+const float CacheDecayPower = 1.5f;
+const float LastTriangleScore = 0.75f;
+const float ValenceBoostScale = 2.0f;
+const float ValenceBoostPower = 0.5f;
+
+float ComputeVertexScore(int cachePosition, int remainingTriangles, int cacheSize)
+{
+  if (remainingTriangles == 0)
+  {
+    // No triangle needs this vertex anymore
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if (cachePosition >= 0)
+  {
+    if (cachePosition < 3)
+    {
+      // Used by the last triangle: fixed score to avoid favoring a direction
+      score = LastTriangleScore;
+    }
+    else
+    {
+      float scaler = 1.0f / (cacheSize - 3);
+      score = std::pow(1.0f - (cachePosition - 3) * scaler, CacheDecayPower);
+    }
+  }
+
+  // Favor vertices with few remaining triangles to get rid of them quickly
+  score += ValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -ValenceBoostPower);
+  return score;
+}
+}
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSkinnedMeshOptimizer)
+
+//-----------------------------------------------------------------------------
+vtkSkinnedMeshOptimizer::vtkSkinnedMeshOptimizer()
+{
+  this->CacheSize = 32;
+  this->ReorderTriangles = true;
+  this->ReorderPoints = true;
+  this->InputACMR = 0.0;
+  this->OutputACMR = 0.0;
+}
+
+//-----------------------------------------------------------------------------
+vtkSkinnedMeshOptimizer::~vtkSkinnedMeshOptimizer()
+{
+}
+
+//-----------------------------------------------------------------------------
+double vtkSkinnedMeshOptimizer::ComputeACMR(const std::vector<vtkIdType>& triangles,
+  vtkIdType nbPoints, int cacheSize)
+{
+  vtkIdType nbTriangles = static_cast<vtkIdType>(triangles.size() / 3);
+  if (nbTriangles == 0)
+  {
+    return 0.0;
+  }
+
+  // FIFO cache: a point is cached if it was inserted less than cacheSize misses ago
+  std::vector<vtkIdType> insertionTimes(nbPoints, -1);
+  vtkIdType nbMisses = 0;
+  for (size_t i = 0; i < triangles.size(); i++)
+  {
+    vtkIdType& insertionTime = insertionTimes[triangles[i]];
+    if (insertionTime < 0 || nbMisses - insertionTime >= cacheSize)
+    {
+      insertionTime = nbMisses;
+      nbMisses++;
+    }
+  }
+
+  return static_cast<double>(nbMisses) / nbTriangles;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<vtkIdType> vtkSkinnedMeshOptimizer::OptimizeTriangleOrder(
+  const std::vector<vtkIdType>& triangles, vtkIdType nbPoints, int cacheSize)
+{
+  vtkIdType nbTriangles = static_cast<vtkIdType>(triangles.size() / 3);
+
+  std::vector<vtkIdType> order;
+  order.reserve(nbTriangles);
+  if (nbTriangles == 0)
+  {
+    return order;
+  }
+
+  // Triangles of each point. The first remainingTriangles[pointId] entries of a point
+  // are the triangles not emitted yet.
+  std::vector<vtkIdType> offsets(nbPoints + 1, 0);
+  for (size_t i = 0; i < triangles.size(); i++)
+  {
+    offsets[triangles[i] + 1]++;
+  }
+  for (vtkIdType pointId = 0; pointId < nbPoints; pointId++)
+  {
+    offsets[pointId + 1] += offsets[pointId];
+  }
+
+  std::vector<int> remainingTriangles(nbPoints, 0);
+  std::vector<vtkIdType> pointTriangles(triangles.size());
+  for (vtkIdType triangleId = 0; triangleId < nbTriangles; triangleId++)
+  {
+    for (int k = 0; k < 3; k++)
+    {
+      vtkIdType pointId = triangles[3 * triangleId + k];
+      pointTriangles[offsets[pointId] + remainingTriangles[pointId]++] = triangleId;
+    }
+  }
+
+  std::vector<int> cachePositions(nbPoints, -1);
+  std::vector<float> pointScores(nbPoints);
+  for (vtkIdType pointId = 0; pointId < nbPoints; pointId++)
+  {
+    pointScores[pointId] = ComputeVertexScore(-1, remainingTriangles[pointId], cacheSize);
+  }
+
+  std::vector<unsigned char> emitted(nbTriangles, 0);
+  vtkIdType bestTriangle = 0;
+  float bestScore = -1.0f;
+  for (vtkIdType triangleId = 0; triangleId < nbTriangles; triangleId++)
+  {
+    float score = pointScores[triangles[3 * triangleId]] +
+      pointScores[triangles[3 * triangleId + 1]] + pointScores[triangles[3 * triangleId + 2]];
+    if (score > bestScore)
+    {
+      bestScore = score;
+      bestTriangle = triangleId;
+    }
+  }
+
+  std::vector<vtkIdType> cache;
+  std::vector<vtkIdType> newCache;
+  cache.reserve(cacheSize + 3);
+  newCache.reserve(cacheSize + 3);
+  vtkIdType nextTriangle = 0;
+
+  while (static_cast<vtkIdType>(order.size()) < nbTriangles)
+  {
+    if (bestTriangle == -1)
+    {
+      // No candidate around the cache: restart from the next triangle in input order
+      while (emitted[nextTriangle])
+      {
+        nextTriangle++;
+      }
+      bestTriangle = nextTriangle;
+    }
+
+    order.push_back(bestTriangle);
+    emitted[bestTriangle] = 1;
+
+    // Remove the triangle from the remaining triangles of its points
+    const vtkIdType* trianglePoints = &triangles[3 * bestTriangle];
+    for (int k = 0; k < 3; k++)
+    {
+      vtkIdType pointId = trianglePoints[k];
+      vtkIdType* first = &pointTriangles[offsets[pointId]];
+      vtkIdType* last = first + remainingTriangles[pointId];
+      vtkIdType* found = std::find(first, last, bestTriangle);
+      if (found != last)
+      {
+        std::swap(*found, *(last - 1));
+        remainingTriangles[pointId]--;
+      }
+    }
+
+    // Move the triangle points to the front of the cache
+    newCache.clear();
+    for (int k = 0; k < 3; k++)
+    {
+      if (std::find(newCache.begin(), newCache.end(), trianglePoints[k]) == newCache.end())
+      {
+        newCache.push_back(trianglePoints[k]);
+      }
+    }
+    for (size_t i = 0; i < cache.size(); i++)
+    {
+      if (std::find(trianglePoints, trianglePoints + 3, cache[i]) == trianglePoints + 3)
+      {
+        newCache.push_back(cache[i]);
+      }
+    }
+
+    // Update the scores of the cached and evicted points
+    for (size_t i = 0; i < newCache.size(); i++)
+    {
+      vtkIdType pointId = newCache[i];
+      cachePositions[pointId] = static_cast<int>(i) < cacheSize ? static_cast<int>(i) : -1;
+      pointScores[pointId] = ComputeVertexScore(cachePositions[pointId], remainingTriangles[pointId], cacheSize);
+    }
+
+    // Best candidate among the triangles of these points
+    bestTriangle = -1;
+    bestScore = -1.0f;
+    for (size_t i = 0; i < newCache.size(); i++)
+    {
+      vtkIdType pointId = newCache[i];
+      for (int j = 0; j < remainingTriangles[pointId]; j++)
+      {
+        vtkIdType triangleId = pointTriangles[offsets[pointId] + j];
+        float score = pointScores[triangles[3 * triangleId]] +
+          pointScores[triangles[3 * triangleId + 1]] + pointScores[triangles[3 * triangleId + 2]];
+        if (score > bestScore)
+        {
+          bestScore = score;
+          bestTriangle = triangleId;
+        }
+      }
+    }
+
+    if (static_cast<int>(newCache.size()) > cacheSize)
+    {
+      newCache.resize(cacheSize);
+    }
+    cache.swap(newCache);
+  }
+
+  return order;
+}
+
+//-----------------------------------------------------------------------------
+int vtkSkinnedMeshOptimizer::RequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkPolyData* input = vtkPolyData::GetData(inputVector[0]);
+  vtkPolyData* output = vtkPolyData::GetData(outputVector);
+
+  this->InputACMR = 0.0;
+  this->OutputACMR = 0.0;
+
+  if (input->GetPoints() == nullptr || input->GetNumberOfVerts() > 0 ||
+    input->GetNumberOfLines() > 0 || input->GetNumberOfStrips() > 0)
+  {
+    vtkWarningMacro(<< "Only polygonal meshes are optimized, passing the input through.");
+    output->ShallowCopy(input);
+    return 1;
+  }
+
+  vtkIdType nbPoints = input->GetNumberOfPoints();
+
+  // Split triangles from the other polygons
+  std::vector<vtkIdType> triangles;
+  std::vector<vtkIdType> triangleCellIds;
+  std::vector<vtkIdType> otherCellIds;
+  std::vector<std::vector<vtkIdType> > otherCells;
+
+  vtkCellArray* polys = input->GetPolys();
+  triangles.reserve(3 * polys->GetNumberOfCells());
+  triangleCellIds.reserve(polys->GetNumberOfCells());
+
+  vtkIdType npts;
+  vtkIdType* pts;
+  vtkIdType cellId = 0;
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts); cellId++)
+  {
+    if (npts == 3)
+    {
+      triangles.insert(triangles.end(), pts, pts + 3);
+      triangleCellIds.push_back(cellId);
+    }
+    else
+    {
+      otherCells.push_back(std::vector<vtkIdType>(pts, pts + npts));
+      otherCellIds.push_back(cellId);
+    }
+  }
+
+  this->InputACMR = vtkSkinnedMeshOptimizer::ComputeACMR(triangles, nbPoints, this->CacheSize);
+
+  // Triangle order
+  std::vector<vtkIdType> triangleOrder;
+  if (this->ReorderTriangles)
+  {
+    triangleOrder = vtkSkinnedMeshOptimizer::OptimizeTriangleOrder(triangles, nbPoints, this->CacheSize);
+  }
+  else
+  {
+    triangleOrder.resize(triangleCellIds.size());
+    for (size_t i = 0; i < triangleOrder.size(); i++)
+    {
+      triangleOrder[i] = static_cast<vtkIdType>(i);
+    }
+  }
+
+  // Point order: first use by the reordered cells, then unused points
+  std::vector<vtkIdType> newPointIds(nbPoints, -1);
+  vtkIdType nextPointId = 0;
+  if (this->ReorderPoints)
+  {
+    for (size_t i = 0; i < triangleOrder.size(); i++)
+    {
+      for (int k = 0; k < 3; k++)
+      {
+        vtkIdType pointId = triangles[3 * triangleOrder[i] + k];
+        if (newPointIds[pointId] == -1)
+        {
+          newPointIds[pointId] = nextPointId++;
+        }
+      }
+    }
+    for (size_t i = 0; i < otherCells.size(); i++)
+    {
+      for (size_t k = 0; k < otherCells[i].size(); k++)
+      {
+        if (newPointIds[otherCells[i][k]] == -1)
+        {
+          newPointIds[otherCells[i][k]] = nextPointId++;
+        }
+      }
+    }
+  }
+  for (vtkIdType pointId = 0; pointId < nbPoints; pointId++)
+  {
+    if (newPointIds[pointId] == -1)
+    {
+      newPointIds[pointId] = this->ReorderPoints ? nextPointId++ : pointId;
+    }
+  }
+
+  // Points and point data
+  vtkPoints* inPoints = input->GetPoints();
+  vtkNew<vtkPoints> outPoints;
+  outPoints->SetDataType(inPoints->GetDataType());
+  outPoints->SetNumberOfPoints(nbPoints);
+
+  vtkPointData* inPD = input->GetPointData();
+  vtkPointData* outPD = output->GetPointData();
+  outPD->CopyAllocate(inPD, nbPoints);
+
+  for (vtkIdType pointId = 0; pointId < nbPoints; pointId++)
+  {
+    outPoints->SetPoint(newPointIds[pointId], inPoints->GetPoint(pointId));
+    outPD->CopyData(inPD, pointId, newPointIds[pointId]);
+  }
+
+  // Cells and cell data
+  vtkCellData* inCD = input->GetCellData();
+  vtkCellData* outCD = output->GetCellData();
+  outCD->CopyAllocate(inCD, polys->GetNumberOfCells());
+
+  vtkNew<vtkCellArray> outPolys;
+  outPolys->Allocate(polys->GetSize());
+
+  std::vector<vtkIdType> outTriangles(triangles.size());
+  for (size_t i = 0; i < triangleOrder.size(); i++)
+  {
+    vtkIdType triangleId = triangleOrder[i];
+    vtkIdType ids[3];
+    for (int k = 0; k < 3; k++)
+    {
+      ids[k] = newPointIds[triangles[3 * triangleId + k]];
+      outTriangles[3 * i + k] = ids[k];
+    }
+    vtkIdType newCellId = outPolys->InsertNextCell(3, ids);
+    outCD->CopyData(inCD, triangleCellIds[triangleId], newCellId);
+  }
+
+  for (size_t i = 0; i < otherCells.size(); i++)
+  {
+    std::vector<vtkIdType> ids(otherCells[i].size());
+    for (size_t k = 0; k < ids.size(); k++)
+    {
+      ids[k] = newPointIds[otherCells[i][k]];
+    }
+    vtkIdType newCellId = outPolys->InsertNextCell(static_cast<vtkIdType>(ids.size()), ids.data());
+    outCD->CopyData(inCD, otherCellIds[i], newCellId);
+  }
+
+  this->OutputACMR = vtkSkinnedMeshOptimizer::ComputeACMR(outTriangles, nbPoints, this->CacheSize);
+
+  output->SetPoints(outPoints);
+  output->SetPolys(outPolys);
+  output->GetFieldData()->ShallowCopy(input->GetFieldData());
+
+  return 1;
+}
@@ -0,0 +1,92 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkinnedMeshOptimizer
+* @brief   vtkSkinnedMeshOptimizer.
+*
+* Reorder the triangles and points of a mesh for GPU vertex processing.
+* Skinned vertices are expensive (four bone matrix products each), so the
+* number of vertex shader invocations matters:
+* - triangles are reordered for post-transform vertex cache reuse, using Tom
+*   Forsyth's linear-speed vertex cache optimization,
+* - points are then renumbered in order of first use by the triangles, for
+*   vertex fetch locality.
+*
+* All point data arrays (BoneIDs, Weights, TCoords_*, MaterialIds, normals...)
+* and cell data arrays are permuted consistently. Non triangle polygons are kept
+* after the triangles. Inputs with vertices, lines or strips are passed through.
+*
+* The average cache miss ratio (transformed vertices per triangle) of the input
+* and of the output for a FIFO cache of CacheSize entries is reported after
+* execution.
+*/
+
+#ifndef vtkSkinnedMeshOptimizer_h
+#define vtkSkinnedMeshOptimizer_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkPolyDataAlgorithm.h>
+
+#include <vector>
+
+class VTKSKINNING_EXPORT vtkSkinnedMeshOptimizer : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkSkinnedMeshOptimizer* New();
+  vtkTypeMacro(vtkSkinnedMeshOptimizer, vtkPolyDataAlgorithm)
+
+  /** Size of the simulated post-transform vertex cache (default 32). */
+  vtkGetMacro(CacheSize, int);
+  vtkSetClampMacro(CacheSize, int, 4, 64);
+
+  /** Enable/Disable the triangle reordering. On by default. */
+  vtkGetMacro(ReorderTriangles, bool);
+  vtkSetMacro(ReorderTriangles, bool);
+  vtkBooleanMacro(ReorderTriangles, bool);
+
+  /** Enable/Disable the point reordering. On by default. */
+  vtkGetMacro(ReorderPoints, bool);
+  vtkSetMacro(ReorderPoints, bool);
+  vtkBooleanMacro(ReorderPoints, bool);
+
+  /** Average cache miss ratio of the last input and output. */
+  vtkGetMacro(InputACMR, double);
+  vtkGetMacro(OutputACMR, double);
+
+protected:
+  vtkSkinnedMeshOptimizer();
+  ~vtkSkinnedMeshOptimizer() override;
+
+  int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) override;
+
+  /** Average cache miss ratio of a triangle list for a FIFO cache. */
+  static double ComputeACMR(const std::vector<vtkIdType>& triangles, vtkIdType nbPoints, int cacheSize);
+
+  /** Reorder a triangle list (3 point ids per triangle) for vertex cache reuse.
+  * Returns the new order of the triangles. */
+  static std::vector<vtkIdType> OptimizeTriangleOrder(const std::vector<vtkIdType>& triangles,
+    vtkIdType nbPoints, int cacheSize);
+
+private:
+  vtkSkinnedMeshOptimizer(const vtkSkinnedMeshOptimizer&) = delete;
+  void operator=(const vtkSkinnedMeshOptimizer&) = delete;
+
+  int CacheSize;
+  bool ReorderTriangles;
+  bool ReorderPoints;
+  double InputACMR;
+  double OutputACMR;
+};
+
+#endif
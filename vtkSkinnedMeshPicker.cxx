@@ -0,0 +1,690 @@
+#include "vtkSkinnedMeshPicker.h"
+
+#include "vtkSkeletonPolyDataMapper.h"
+#include "vtkSkeletonPose.h"
+
+#include <vtkCellArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIntArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h> // For New macro
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkProp3D.h>
+#include <vtkRenderer.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Maximum number of triangles of a leaf
+const vtkIdType LEAF_SIZE = 4;
+
+void InitializeBounds(float bounds[6])
+{
+  bounds[0] = bounds[2] = bounds[4] = VTK_FLOAT_MAX;
+  bounds[1] = bounds[3] = bounds[5] = -VTK_FLOAT_MAX;
+}
+
+void AddPointToBounds(const float point[3], float bounds[6])
+{
+  for (int c = 0; c < 3; c++)
+  {
+    bounds[2 * c] = std::min(bounds[2 * c], point[c]);
+    bounds[2 * c + 1] = std::max(bounds[2 * c + 1], point[c]);
+  }
+}
+
+void AddBoundsToBounds(const float input[6], float bounds[6])
+{
+  for (int c = 0; c < 3; c++)
+  {
+    bounds[2 * c] = std::min(bounds[2 * c], input[2 * c]);
+    bounds[2 * c + 1] = std::max(bounds[2 * c + 1], input[2 * c + 1]);
+  }
+}
+
+// Slab test of the segment origin + t * direction, t in [0, maxT]
+bool IntersectBounds(const float bounds[6], const double origin[3], const double invDirection[3], double maxT)
+{
+  double tMin = 0.0;
+  double tMax = maxT;
+  for (int c = 0; c < 3; c++)
+  {
+    double t0 = (bounds[2 * c] - origin[c]) * invDirection[c];
+    double t1 = (bounds[2 * c + 1] - origin[c]) * invDirection[c];
+    if (t0 > t1)
+    {
+      std::swap(t0, t1);
+    }
+    tMin = std::max(tMin, t0);
+    tMax = std::min(tMax, t1);
+    if (tMax < tMin)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Moller-Trumbore intersection of the segment origin + t * direction with a triangle
+bool IntersectTriangle(const float* v0, const float* v1, const float* v2,
+  const double origin[3], const double direction[3], double& t)
+{
+  double e1[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+  double e2[3] = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+  double p[3] = { direction[1] * e2[2] - direction[2] * e2[1],
+    direction[2] * e2[0] - direction[0] * e2[2],
+    direction[0] * e2[1] - direction[1] * e2[0] };
+  double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+  if (std::abs(det) < 1e-20)
+  {
+    return false;
+  }
+  double invDet = 1.0 / det;
+
+  double s[3] = { origin[0] - v0[0], origin[1] - v0[1], origin[2] - v0[2] };
+  double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+  if (u < 0.0 || u > 1.0)
+  {
+    return false;
+  }
+
+  double q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+  double v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * invDet;
+  if (v < 0.0 || u + v > 1.0)
+  {
+    return false;
+  }
+
+  t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+  return true;
+}
+}
+
+//-----------------------------------------------------------------------------
+// Recomputes the bounds of the nodes of a range of partitions, children first
+struct vtkSkinnedMeshPicker::PartitionRefitter
+{
+  vtkSkinnedMeshPicker* Picker;
+  const vtkIdType* Partitions;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    const std::vector<Triangle>& triangles = this->Picker->Triangles;
+    const float* points = this->Picker->SkinnedPoints->GetPointer(0);
+    std::vector<Node>& nodes = this->Picker->Nodes;
+
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      const Partition& partition = this->Picker->Partitions[this->Partitions[i]];
+      for (vtkIdType nodeId = partition.EndNode - 1; nodeId >= partition.FirstNode; nodeId--)
+      {
+        Node& node = nodes[nodeId];
+        InitializeBounds(node.Bounds);
+        if (node.Count > 0)
+        {
+          for (vtkIdType triangleId = node.First; triangleId < node.First + node.Count; triangleId++)
+          {
+            for (int k = 0; k < 3; k++)
+            {
+              AddPointToBounds(points + 3 * triangles[triangleId].PointIds[k], node.Bounds);
+            }
+          }
+        }
+        else
+        {
+          AddBoundsToBounds(nodes[node.Left].Bounds, node.Bounds);
+          AddBoundsToBounds(nodes[node.Right].Bounds, node.Bounds);
+        }
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSkinnedMeshPicker)
+
+//-----------------------------------------------------------------------------
+vtkSkinnedMeshPicker::vtkSkinnedMeshPicker()
+{
+  this->Mapper = nullptr;
+  this->Root = -1;
+  this->BuildTime = 0;
+  this->NumberOfRefittedPartitions = 0;
+
+  this->PickedCellId = -1;
+  this->PickedBoneId = -1;
+  this->PickPosition[0] = this->PickPosition[1] = this->PickPosition[2] = 0.0;
+}
+
+//-----------------------------------------------------------------------------
+vtkSkinnedMeshPicker::~vtkSkinnedMeshPicker()
+{
+  this->SetMapper(nullptr);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkinnedMeshPicker::SetMapper(vtkSkeletonPolyDataMapper* mapper)
+{
+  if (this->Mapper == mapper)
+  {
+    return;
+  }
+
+  if (this->Mapper != nullptr)
+  {
+    this->Mapper->Delete();
+  }
+  if (mapper != nullptr)
+  {
+    mapper->Register(this);
+  }
+  this->Mapper = mapper;
+  this->BuildTime = 0;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkinnedMeshPicker::GetNumberOfPartitions() const
+{
+  return static_cast<vtkIdType>(this->Partitions.size());
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkinnedMeshPicker::Update()
+{
+  this->NumberOfRefittedPartitions = 0;
+  if (this->Mapper == nullptr || this->Mapper->GetInput() == nullptr)
+  {
+    return;
+  }
+
+  // Does nothing when the render already evaluated the current pose
+  this->Mapper->UpdateSkinningPose();
+  const std::vector<float>& palette = this->Mapper->GetSkinningPalette();
+
+  vtkMTimeType inputTime = this->Mapper->GetInput()->GetMTime();
+  if (inputTime != this->BuildTime || palette.size() != this->Palette.size())
+  {
+    this->Palette = palette;
+    this->Build();
+    this->BuildTime = inputTime;
+    this->NumberOfRefittedPartitions = this->GetNumberOfPartitions();
+    return;
+  }
+
+  // Bones whose palette matrix changed since the last update
+  vtkIdType nbBones = static_cast<vtkIdType>(palette.size() / 12);
+  std::vector<unsigned char> movedBones(nbBones, 0);
+  bool moved = false;
+  for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+  {
+    movedBones[boneId] = !std::equal(palette.begin() + 12 * boneId, palette.begin() + 12 * (boneId + 1),
+      this->Palette.begin() + 12 * boneId);
+    moved = moved || movedBones[boneId];
+  }
+  if (!moved)
+  {
+    return;
+  }
+
+  this->Palette = palette;
+  this->SkinPoints(movedBones.data());
+
+  std::vector<vtkIdType> movedPartitions;
+  for (vtkIdType partitionId = 0; partitionId < this->GetNumberOfPartitions(); partitionId++)
+  {
+    const std::vector<vtkIdType>& bones = this->Partitions[partitionId].Bones;
+    if (std::any_of(bones.begin(), bones.end(), [&movedBones](vtkIdType boneId) { return movedBones[boneId] != 0; }))
+    {
+      movedPartitions.push_back(partitionId);
+    }
+  }
+
+  this->RefitPartitions(movedPartitions);
+  this->RefitTopNodes();
+  this->NumberOfRefittedPartitions = static_cast<vtkIdType>(movedPartitions.size());
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkinnedMeshPicker::Build()
+{
+  this->BindPoints = nullptr;
+  this->PointWeights = nullptr;
+  this->PointBoneIds = nullptr;
+  this->SkinnedPoints = nullptr;
+  this->Triangles.clear();
+  this->Nodes.clear();
+  this->Partitions.clear();
+  this->TopNodes.clear();
+  this->Root = -1;
+
+  vtkPolyData* input = this->Mapper->GetInput();
+  vtkDoubleArray* weights = vtkDoubleArray::SafeDownCast(input->GetPointData()->GetAbstractArray("Weights"));
+  vtkIntArray* boneIds = vtkIntArray::SafeDownCast(input->GetPointData()->GetAbstractArray("BoneIDs"));
+  vtkIdType nbPoints = input->GetNumberOfPoints();
+  vtkIdType nbBones = static_cast<vtkIdType>(this->Palette.size() / 12);
+  if (nbPoints == 0 || nbBones == 0 || input->GetPolys() == nullptr || weights == nullptr || boneIds == nullptr ||
+    weights->GetNumberOfComponents() != 4 || boneIds->GetNumberOfComponents() != 4)
+  {
+    return;
+  }
+
+  // Skinning attributes
+  this->BindPoints = input->GetPoints()->GetData();
+  this->PointWeights = weights;
+  this->PointBoneIds = boneIds;
+  this->SkinnedPoints = vtkSmartPointer<vtkFloatArray>::New();
+  this->SkinPoints(nullptr);
+  const double* pointWeights = weights->GetPointer(0);
+  const int* pointBoneIds = boneIds->GetPointer(0);
+
+  // Triangles and their dominant bone. Cell ids of polys come after the
+  // vertices and lines.
+  vtkIdType cellId = input->GetNumberOfVerts() + input->GetNumberOfLines();
+  vtkCellArray* polys = input->GetPolys();
+  vtkIdType npts;
+  vtkIdType* pts;
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts); cellId++)
+  {
+    if (npts != 3)
+    {
+      continue;
+    }
+
+    vtkIdType influenceBones[12];
+    float influenceWeights[12];
+    int nbInfluences = 0;
+    for (int k = 0; k < 3; k++)
+    {
+      for (int b = 0; b < 4; b++)
+      {
+        int boneId = pointBoneIds[4 * pts[k] + b];
+        float weight = static_cast<float>(pointWeights[4 * pts[k] + b]);
+        if (weight == 0.0f || boneId < 0 || boneId >= nbBones)
+        {
+          continue;
+        }
+
+        int i = 0;
+        while (i < nbInfluences && influenceBones[i] != boneId)
+        {
+          i++;
+        }
+        if (i == nbInfluences)
+        {
+          influenceBones[nbInfluences] = boneId;
+          influenceWeights[nbInfluences++] = 0.0f;
+        }
+        influenceWeights[i] += weight;
+      }
+    }
+
+    Triangle triangle;
+    triangle.PointIds[0] = pts[0];
+    triangle.PointIds[1] = pts[1];
+    triangle.PointIds[2] = pts[2];
+    triangle.CellId = cellId;
+    triangle.BoneId = -1;
+    float maxWeight = 0.0f;
+    for (int i = 0; i < nbInfluences; i++)
+    {
+      if (influenceWeights[i] > maxWeight)
+      {
+        maxWeight = influenceWeights[i];
+        triangle.BoneId = influenceBones[i];
+      }
+    }
+    this->Triangles.push_back(triangle);
+  }
+
+  // One hierarchy per dominant bone
+  std::stable_sort(this->Triangles.begin(), this->Triangles.end(),
+    [](const Triangle& t1, const Triangle& t2) { return t1.BoneId < t2.BoneId; });
+
+  vtkIdType nbTriangles = static_cast<vtkIdType>(this->Triangles.size());
+  std::vector<unsigned char> partitionBones(nbBones, 0);
+  for (vtkIdType first = 0; first < nbTriangles;)
+  {
+    vtkIdType end = first;
+    while (end < nbTriangles && this->Triangles[end].BoneId == this->Triangles[first].BoneId)
+    {
+      end++;
+    }
+
+    Partition partition;
+    partition.FirstNode = this->BuildNode(first, end - first);
+    partition.EndNode = static_cast<vtkIdType>(this->Nodes.size());
+
+    std::fill(partitionBones.begin(), partitionBones.end(), 0);
+    for (vtkIdType triangleId = first; triangleId < end; triangleId++)
+    {
+      for (int k = 0; k < 3; k++)
+      {
+        vtkIdType pointId = this->Triangles[triangleId].PointIds[k];
+        for (int b = 0; b < 4; b++)
+        {
+          int boneId = pointBoneIds[4 * pointId + b];
+          if (pointWeights[4 * pointId + b] != 0.0 && boneId >= 0 && boneId < nbBones)
+          {
+            partitionBones[boneId] = 1;
+          }
+        }
+      }
+    }
+    for (vtkIdType boneId = 0; boneId < nbBones; boneId++)
+    {
+      if (partitionBones[boneId])
+      {
+        partition.Bones.push_back(boneId);
+      }
+    }
+
+    this->Partitions.push_back(partition);
+    first = end;
+  }
+
+  if (this->Partitions.empty())
+  {
+    return;
+  }
+
+  std::vector<vtkIdType> partitionIds(this->Partitions.size());
+  for (size_t i = 0; i < partitionIds.size(); i++)
+  {
+    partitionIds[i] = static_cast<vtkIdType>(i);
+  }
+  this->RefitPartitions(partitionIds);
+
+  // Top hierarchy over the bounds of the partitions
+  this->Root = this->BuildTopNode(partitionIds, 0, partitionIds.size());
+  this->RefitTopNodes();
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkinnedMeshPicker::BuildNode(vtkIdType first, vtkIdType count)
+{
+  vtkIdType nodeId = static_cast<vtkIdType>(this->Nodes.size());
+  Node node;
+  InitializeBounds(node.Bounds);
+  node.Left = node.Right = -1;
+  node.First = first;
+  node.Count = count;
+  this->Nodes.push_back(node);
+
+  if (count <= LEAF_SIZE)
+  {
+    return nodeId;
+  }
+
+  // Median split of the centroids along their largest extent
+  const float* points = this->SkinnedPoints->GetPointer(0);
+  auto centroid = [points](const Triangle& triangle, int axis) {
+    return points[3 * triangle.PointIds[0] + axis] + points[3 * triangle.PointIds[1] + axis] +
+      points[3 * triangle.PointIds[2] + axis];
+  };
+
+  float centroidBounds[6];
+  InitializeBounds(centroidBounds);
+  for (vtkIdType triangleId = first; triangleId < first + count; triangleId++)
+  {
+    float c[3] = { centroid(this->Triangles[triangleId], 0), centroid(this->Triangles[triangleId], 1),
+      centroid(this->Triangles[triangleId], 2) };
+    AddPointToBounds(c, centroidBounds);
+  }
+  int axis = 0;
+  for (int c = 1; c < 3; c++)
+  {
+    if (centroidBounds[2 * c + 1] - centroidBounds[2 * c] > centroidBounds[2 * axis + 1] - centroidBounds[2 * axis])
+    {
+      axis = c;
+    }
+  }
+
+  vtkIdType half = count / 2;
+  std::nth_element(this->Triangles.begin() + first, this->Triangles.begin() + first + half,
+    this->Triangles.begin() + first + count,
+    [&centroid, axis](const Triangle& t1, const Triangle& t2) { return centroid(t1, axis) < centroid(t2, axis); });
+
+  vtkIdType left = this->BuildNode(first, half);
+  vtkIdType right = this->BuildNode(first + half, count - half);
+  this->Nodes[nodeId].Left = left;
+  this->Nodes[nodeId].Right = right;
+  this->Nodes[nodeId].First = -1;
+  this->Nodes[nodeId].Count = 0;
+  return nodeId;
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkinnedMeshPicker::BuildTopNode(std::vector<vtkIdType>& partitions, size_t first, size_t count)
+{
+  if (count == 1)
+  {
+    return this->Partitions[partitions[first]].FirstNode;
+  }
+
+  vtkIdType nodeId = static_cast<vtkIdType>(this->Nodes.size());
+  Node node;
+  InitializeBounds(node.Bounds);
+  node.First = -1;
+  node.Count = 0;
+  this->Nodes.push_back(node);
+  this->TopNodes.push_back(nodeId);
+
+  auto center = [this](vtkIdType partitionId, int axis) {
+    const float* bounds = this->Nodes[this->Partitions[partitionId].FirstNode].Bounds;
+    return bounds[2 * axis] + bounds[2 * axis + 1];
+  };
+
+  float centerBounds[6];
+  InitializeBounds(centerBounds);
+  for (size_t i = first; i < first + count; i++)
+  {
+    float c[3] = { center(partitions[i], 0), center(partitions[i], 1), center(partitions[i], 2) };
+    AddPointToBounds(c, centerBounds);
+  }
+  int axis = 0;
+  for (int c = 1; c < 3; c++)
+  {
+    if (centerBounds[2 * c + 1] - centerBounds[2 * c] > centerBounds[2 * axis + 1] - centerBounds[2 * axis])
+    {
+      axis = c;
+    }
+  }
+
+  size_t half = count / 2;
+  std::nth_element(partitions.begin() + first, partitions.begin() + first + half, partitions.begin() + first + count,
+    [&center, axis](vtkIdType p1, vtkIdType p2) { return center(p1, axis) < center(p2, axis); });
+
+  vtkIdType left = this->BuildTopNode(partitions, first, half);
+  vtkIdType right = this->BuildTopNode(partitions, first + half, count - half);
+  this->Nodes[nodeId].Left = left;
+  this->Nodes[nodeId].Right = right;
+  return nodeId;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkinnedMeshPicker::SkinPoints(const unsigned char* movedBones)
+{
+  vtkSkeletonPose::SkinVectors(this->BindPoints, this->PointWeights, this->PointBoneIds,
+    this->Palette, 1.0, this->SkinnedPoints, movedBones);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkinnedMeshPicker::RefitPartitions(const std::vector<vtkIdType>& partitions)
+{
+  if (partitions.empty())
+  {
+    return;
+  }
+
+  PartitionRefitter refitter;
+  refitter.Picker = this;
+  refitter.Partitions = partitions.data();
+  vtkSMPTools::For(0, static_cast<vtkIdType>(partitions.size()), 1, refitter);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkinnedMeshPicker::RefitTopNodes()
+{
+  for (auto it = this->TopNodes.rbegin(); it != this->TopNodes.rend(); ++it)
+  {
+    Node& node = this->Nodes[*it];
+    InitializeBounds(node.Bounds);
+    AddBoundsToBounds(this->Nodes[node.Left].Bounds, node.Bounds);
+    AddBoundsToBounds(this->Nodes[node.Right].Bounds, node.Bounds);
+  }
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkinnedMeshPicker::FindClosestTriangle(const double p1[3], const double p2[3],
+  double& t, double x[3]) const
+{
+  if (this->Root < 0)
+  {
+    return -1;
+  }
+
+  double direction[3] = { p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2] };
+  double invDirection[3];
+  for (int c = 0; c < 3; c++)
+  {
+    invDirection[c] = direction[c] != 0.0 ? 1.0 / direction[c] : VTK_DOUBLE_MAX;
+  }
+
+  const float* points = this->SkinnedPoints->GetPointer(0);
+  vtkIdType closestTriangle = -1;
+  double closestT = 1.0;
+
+  std::vector<vtkIdType> stack(1, this->Root);
+  while (!stack.empty())
+  {
+    const Node& node = this->Nodes[stack.back()];
+    stack.pop_back();
+    if (!IntersectBounds(node.Bounds, p1, invDirection, closestT))
+    {
+      continue;
+    }
+
+    if (node.Count > 0)
+    {
+      for (vtkIdType triangleId = node.First; triangleId < node.First + node.Count; triangleId++)
+      {
+        const vtkIdType* pointIds = this->Triangles[triangleId].PointIds;
+        double triangleT;
+        if (IntersectTriangle(points + 3 * pointIds[0], points + 3 * pointIds[1], points + 3 * pointIds[2],
+          p1, direction, triangleT) && triangleT >= 0.0 && triangleT <= closestT)
+        {
+          closestT = triangleT;
+          closestTriangle = triangleId;
+        }
+      }
+    }
+    else
+    {
+      stack.push_back(node.Right);
+      stack.push_back(node.Left);
+    }
+  }
+
+  if (closestTriangle != -1)
+  {
+    t = closestT;
+    for (int c = 0; c < 3; c++)
+    {
+      x[c] = p1[c] + closestT * direction[c];
+    }
+  }
+  return closestTriangle;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSkinnedMeshPicker::IntersectWithLine(const double p1[3], const double p2[3],
+  double& t, double x[3], vtkIdType& cellId)
+{
+  vtkIdType triangleId = this->FindClosestTriangle(p1, p2, t, x);
+  if (triangleId == -1)
+  {
+    return false;
+  }
+
+  cellId = this->Triangles[triangleId].CellId;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSkinnedMeshPicker::Pick(double selectionX, double selectionY, vtkRenderer* renderer, vtkProp3D* prop)
+{
+  this->PickedCellId = -1;
+  this->PickedBoneId = -1;
+  this->PickPosition[0] = this->PickPosition[1] = this->PickPosition[2] = 0.0;
+  if (renderer == nullptr)
+  {
+    return false;
+  }
+
+  this->Update();
+
+  // Segment between the near and far planes, in world coordinates
+  double ray[2][4];
+  for (int i = 0; i < 2; i++)
+  {
+    renderer->SetDisplayPoint(selectionX, selectionY, static_cast<double>(i));
+    renderer->DisplayToWorld();
+    renderer->GetWorldPoint(ray[i]);
+    if (ray[i][3] == 0.0)
+    {
+      return false;
+    }
+    for (int c = 0; c < 3; c++)
+    {
+      ray[i][c] /= ray[i][3];
+    }
+    ray[i][3] = 1.0;
+  }
+
+  // Then in the coordinates of the mapper input
+  vtkNew<vtkMatrix4x4> inverse;
+  if (prop != nullptr)
+  {
+    vtkMatrix4x4::Invert(prop->GetMatrix(), inverse);
+    for (int i = 0; i < 2; i++)
+    {
+      inverse->MultiplyPoint(ray[i], ray[i]);
+      for (int c = 0; c < 3; c++)
+      {
+        ray[i][c] /= ray[i][3];
+      }
+      ray[i][3] = 1.0;
+    }
+  }
+
+  double t;
+  double x[4] = { 0.0, 0.0, 0.0, 1.0 };
+  vtkIdType triangleId = this->FindClosestTriangle(ray[0], ray[1], t, x);
+  if (triangleId == -1)
+  {
+    return false;
+  }
+
+  if (prop != nullptr)
+  {
+    prop->GetMatrix()->MultiplyPoint(x, x);
+    for (int c = 0; c < 3; c++)
+    {
+      x[c] /= x[3];
+    }
+  }
+
+  this->PickedCellId = this->Triangles[triangleId].CellId;
+  this->PickedBoneId = this->Triangles[triangleId].BoneId;
+  this->PickPosition[0] = x[0];
+  this->PickPosition[1] = x[1];
+  this->PickPosition[2] = x[2];
+  return true;
+}
@@ -0,0 +1,164 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkinnedMeshPicker
+* @brief   vtkSkinnedMeshPicker.
+*
+* Ray picking on the triangles of a vtkSkeletonPolyDataMapper input deformed
+* by the current pose of the mapper, whereas the VTK pickers only see the
+* bind-pose geometry (skinning happens in the vertex shader).
+*
+* Triangles are partitioned by dominant bone (largest summed weight of their
+* vertices), and each partition has its own bounding volume hierarchy. A small
+* top hierarchy groups the partitions.
+*
+* The hierarchies are built once per input. When the pose changes, Update()
+* compares the skinning palette with the previous one: only the points
+* influenced by the bones that moved are skinned again, on the CPU, and only
+* the partitions containing such points are refitted (their topology is kept,
+* bounds are recomputed bottom-up), followed by the top hierarchy.
+*
+* Only triangles are picked. Morph targets are ignored.
+*/
+
+#ifndef vtkSkinnedMeshPicker_h
+#define vtkSkinnedMeshPicker_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkObject.h>
+#include <vtkSmartPointer.h> // For the skinning attributes
+
+#include <vector>
+
+class vtkDataArray;
+class vtkDoubleArray;
+class vtkFloatArray;
+class vtkIntArray;
+class vtkProp3D;
+class vtkRenderer;
+class vtkSkeletonPolyDataMapper;
+
+class VTKSKINNING_EXPORT vtkSkinnedMeshPicker : public vtkObject
+{
+public:
+  static vtkSkinnedMeshPicker* New();
+  vtkTypeMacro(vtkSkinnedMeshPicker, vtkObject)
+
+  /** Mapper providing the mesh and the skinning palette. */
+  void SetMapper(vtkSkeletonPolyDataMapper* mapper);
+  vtkGetMacro(Mapper, vtkSkeletonPolyDataMapper*);
+
+  /** Bring the hierarchies up to date with the current pose of the mapper:
+  * build them when the input changed, refit them when bones moved.
+  * Called by Pick(). */
+  void Update();
+
+  /** Closest triangle intersected by the segment [p1, p2], in the mapper input
+  * coordinates. Returns false if there is none, else the parametric
+  * coordinate t along the segment, the intersection point x and the cell id
+  * of the triangle in the input. Update() must have been called. */
+  bool IntersectWithLine(const double p1[3], const double p2[3], double& t, double x[3], vtkIdType& cellId);
+
+  /** Pick at display coordinates. prop is the actor of the mapper, its
+  * transform is applied when given. Returns true if a triangle was hit. */
+  bool Pick(double selectionX, double selectionY, vtkRenderer* renderer, vtkProp3D* prop = nullptr);
+
+  /** Results of the last Pick(): cell id (-1 if nothing was hit), dominant
+  * bone of the cell and world position. */
+  vtkGetMacro(PickedCellId, vtkIdType);
+  vtkGetMacro(PickedBoneId, vtkIdType);
+  vtkGetVector3Macro(PickPosition, double);
+
+  /** Number of triangle partitions and number of partitions refitted by the
+  * last Update(). */
+  vtkIdType GetNumberOfPartitions() const;
+  vtkGetMacro(NumberOfRefittedPartitions, vtkIdType);
+
+protected:
+  vtkSkinnedMeshPicker();
+  ~vtkSkinnedMeshPicker() override;
+
+  /** Gather the triangles and skinning attributes of the input and build the
+  * hierarchies. */
+  void Build();
+
+  /** Skin the points influenced by the flagged bones, all the points if
+  * movedBones is null. See vtkSkeletonPose::SkinVectors(). */
+  void SkinPoints(const unsigned char* movedBones);
+
+  /** Recompute the bounds of the nodes of the given partitions. */
+  void RefitPartitions(const std::vector<vtkIdType>& partitions);
+
+  /** Recompute the bounds of the top hierarchy nodes. */
+  void RefitTopNodes();
+
+  /** Closest intersected triangle, -1 if none. */
+  vtkIdType FindClosestTriangle(const double p1[3], const double p2[3], double& t, double x[3]) const;
+
+private:
+  vtkSkinnedMeshPicker(const vtkSkinnedMeshPicker&) = delete;
+  void operator=(const vtkSkinnedMeshPicker&) = delete;
+
+  struct Triangle
+  {
+    vtkIdType PointIds[3];
+    vtkIdType CellId;
+    vtkIdType BoneId; // Dominant bone
+  };
+
+  struct Node
+  {
+    float Bounds[6];
+    vtkIdType Left; // Child nodes, interior nodes only
+    vtkIdType Right;
+    vtkIdType First; // Triangles, leaves only
+    vtkIdType Count; // 0 for interior nodes
+  };
+
+  struct Partition
+  {
+    vtkIdType FirstNode; // Root of the partition hierarchy
+    vtkIdType EndNode; // Nodes of a partition are contiguous
+    std::vector<vtkIdType> Bones; // Bones influencing the points of the partition
+  };
+
+  struct PartitionRefitter; // Refits a range of partitions
+
+  vtkIdType BuildNode(vtkIdType first, vtkIdType count);
+  vtkIdType BuildTopNode(std::vector<vtkIdType>& partitions, size_t first, size_t count);
+
+  vtkSkeletonPolyDataMapper* Mapper;
+
+  // Skinning attributes of the input, 4 influences per point
+  vtkSmartPointer<vtkDataArray> BindPoints;
+  vtkSmartPointer<vtkDoubleArray> PointWeights;
+  vtkSmartPointer<vtkIntArray> PointBoneIds;
+  vtkSmartPointer<vtkFloatArray> SkinnedPoints;
+  std::vector<float> Palette; // Palette of SkinnedPoints
+
+  std::vector<Triangle> Triangles; // Sorted by partition, then by leaf
+  std::vector<Node> Nodes; // Partition nodes, then top nodes
+  std::vector<Partition> Partitions;
+  std::vector<vtkIdType> TopNodes; // Parents before children
+  vtkIdType Root;
+  vtkMTimeType BuildTime; // Input time of the hierarchies
+
+  vtkIdType NumberOfRefittedPartitions;
+
+  vtkIdType PickedCellId;
+  vtkIdType PickedBoneId;
+  double PickPosition[3];
+};
+
+#endif
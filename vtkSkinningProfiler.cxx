@@ -0,0 +1,271 @@
+#include "vtkSkinningProfiler.h"
+
+#include <vtkObjectFactory.h> // For New macro
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+double GetClockTime()
+{
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Small thread ids are easier to read in trace viewers than hashes.
+unsigned int GetTraceThreadId()
+{
+  static std::mutex idLock;
+  static std::vector<std::thread::id> ids;
+
+  std::lock_guard<std::mutex> guard(idLock);
+  std::thread::id id = std::this_thread::get_id();
+  auto it = std::find(ids.begin(), ids.end(), id);
+  if (it != ids.end())
+  {
+    return static_cast<unsigned int>(it - ids.begin());
+  }
+  ids.push_back(id);
+  return static_cast<unsigned int>(ids.size() - 1);
+}
+}
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSkinningProfiler)
+
+//-----------------------------------------------------------------------------
+vtkSkinningProfiler::vtkSkinningProfiler()
+{
+  this->Enabled = true;
+  this->TraceEnabled = false;
+  this->WindowSize = 120;
+  this->MaximumNumberOfTraceEvents = 1000000;
+  this->Origin = GetClockTime();
+
+  this->Reset();
+}
+
+//-----------------------------------------------------------------------------
+vtkSkinningProfiler::~vtkSkinningProfiler()
+{
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkinningProfiler::SetWindowSize(int size)
+{
+  size = std::max(1, size);
+  if (this->WindowSize == size)
+  {
+    return;
+  }
+
+  this->WindowSize = size;
+  this->Reset();
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+double vtkSkinningProfiler::GetTime() const
+{
+  return GetClockTime() - this->Origin;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkinningProfiler::AddSample(int stage, double startTime, double duration)
+{
+  if (!this->Enabled || stage < 0 || stage >= NUMBER_OF_STAGES)
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(this->Lock);
+
+  std::vector<double>& samples = this->Samples[stage];
+  if (samples.size() < static_cast<size_t>(this->WindowSize))
+  {
+    samples.push_back(duration);
+  }
+  else
+  {
+    samples[this->NextSample[stage]] = duration;
+  }
+  this->NextSample[stage] = (this->NextSample[stage] + 1) % this->WindowSize;
+  this->LastTime[stage] = duration;
+
+  if (this->TraceEnabled &&
+    static_cast<vtkIdType>(this->TraceEvents.size()) < this->MaximumNumberOfTraceEvents)
+  {
+    TraceEvent event = { stage, startTime, duration, GetTraceThreadId() };
+    this->TraceEvents.push_back(event);
+  }
+}
+
+//-----------------------------------------------------------------------------
+double vtkSkinningProfiler::GetLastTime(int stage)
+{
+  if (stage < 0 || stage >= NUMBER_OF_STAGES)
+  {
+    return 0.0;
+  }
+  std::lock_guard<std::mutex> guard(this->Lock);
+  return this->LastTime[stage];
+}
+
+//-----------------------------------------------------------------------------
+double vtkSkinningProfiler::GetAverageTime(int stage)
+{
+  if (stage < 0 || stage >= NUMBER_OF_STAGES)
+  {
+    return 0.0;
+  }
+  std::lock_guard<std::mutex> guard(this->Lock);
+  const std::vector<double>& samples = this->Samples[stage];
+  if (samples.empty())
+  {
+    return 0.0;
+  }
+
+  double sum = 0.0;
+  for (size_t i = 0; i < samples.size(); i++)
+  {
+    sum += samples[i];
+  }
+  return sum / samples.size();
+}
+
+//-----------------------------------------------------------------------------
+double vtkSkinningProfiler::GetMinimumTime(int stage)
+{
+  if (stage < 0 || stage >= NUMBER_OF_STAGES)
+  {
+    return 0.0;
+  }
+  std::lock_guard<std::mutex> guard(this->Lock);
+  const std::vector<double>& samples = this->Samples[stage];
+  return samples.empty() ? 0.0 : *std::min_element(samples.begin(), samples.end());
+}
+
+//-----------------------------------------------------------------------------
+double vtkSkinningProfiler::GetMaximumTime(int stage)
+{
+  if (stage < 0 || stage >= NUMBER_OF_STAGES)
+  {
+    return 0.0;
+  }
+  std::lock_guard<std::mutex> guard(this->Lock);
+  const std::vector<double>& samples = this->Samples[stage];
+  return samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkinningProfiler::GetNumberOfSamples(int stage)
+{
+  if (stage < 0 || stage >= NUMBER_OF_STAGES)
+  {
+    return 0;
+  }
+  std::lock_guard<std::mutex> guard(this->Lock);
+  return static_cast<vtkIdType>(this->Samples[stage].size());
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSkinningProfiler::GetNumberOfTraceEvents()
+{
+  std::lock_guard<std::mutex> guard(this->Lock);
+  return static_cast<vtkIdType>(this->TraceEvents.size());
+}
+
+//-----------------------------------------------------------------------------
+const char* vtkSkinningProfiler::GetStageName(int stage)
+{
+  switch (stage)
+  {
+  case KEY_LOOKUP:
+    return "Key lookup";
+  case GLOBAL_POSE:
+    return "Global pose";
+  case PALETTE_UPLOAD:
+    return "Palette upload";
+  case BUFFER_BUILD:
+    return "Buffer build";
+  case SHADER_BUILD:
+    return "Shader build";
+  case RENDER:
+    return "Render";
+  default:
+    return "Unknown";
+  }
+}
+
+//-----------------------------------------------------------------------------
+std::string vtkSkinningProfiler::GetSummary()
+{
+  std::stringstream summary;
+  summary << std::fixed << std::setprecision(3);
+  summary << "Stage (ms)        last     avg     min     max\n";
+  for (int stage = 0; stage < NUMBER_OF_STAGES; stage++)
+  {
+    summary << std::left << std::setw(16) << vtkSkinningProfiler::GetStageName(stage)
+      << std::right
+      << std::setw(8) << 1.0e3 * this->GetLastTime(stage)
+      << std::setw(8) << 1.0e3 * this->GetAverageTime(stage)
+      << std::setw(8) << 1.0e3 * this->GetMinimumTime(stage)
+      << std::setw(8) << 1.0e3 * this->GetMaximumTime(stage) << "\n";
+  }
+  return summary.str();
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSkinningProfiler::WriteChromeTrace(const char* fileName)
+{
+  if (fileName == nullptr)
+  {
+    vtkErrorMacro(<< "No file name specified.");
+    return false;
+  }
+
+  std::ofstream file(fileName);
+  if (!file.is_open())
+  {
+    vtkErrorMacro(<< "Could not open " << fileName << " for writing.");
+    return false;
+  }
+
+  std::lock_guard<std::mutex> guard(this->Lock);
+
+  // Trace-event timestamps and durations are expressed in microseconds.
+  file << std::fixed << std::setprecision(3);
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for (size_t i = 0; i < this->TraceEvents.size(); i++)
+  {
+    const TraceEvent& event = this->TraceEvents[i];
+    file << (i == 0 ? "\n" : ",\n")
+      << "{\"name\":\"" << vtkSkinningProfiler::GetStageName(event.Stage) << "\","
+      << "\"cat\":\"skinning\",\"ph\":\"X\","
+      << "\"ts\":" << 1.0e6 * event.StartTime << ","
+      << "\"dur\":" << 1.0e6 * event.Duration << ","
+      << "\"pid\":1,\"tid\":" << event.ThreadId << "}";
+  }
+  file << "\n]}\n";
+
+  return !file.fail();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSkinningProfiler::Reset()
+{
+  std::lock_guard<std::mutex> guard(this->Lock);
+  for (int stage = 0; stage < NUMBER_OF_STAGES; stage++)
+  {
+    this->Samples[stage].clear();
+    this->Samples[stage].reserve(this->WindowSize);
+    this->NextSample[stage] = 0;
+    this->LastTime[stage] = 0.0;
+  }
+  this->TraceEvents.clear();
+}
@@ -0,0 +1,170 @@
+/*=========================================================================
+
+Program:   Visualization Toolkit
+
+Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+All rights reserved.
+See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+* @class   vtkSkinningProfiler
+* @brief   vtkSkinningProfiler.
+*
+* Lightweight per-stage timer for the animation/render loop.
+* Each stage keeps rolling statistics over the last WindowSize samples.
+* When tracing is enabled, every sample is also recorded as a trace event
+* that can be written in the Chrome trace-event JSON format
+* (chrome://tracing, Perfetto).
+*
+* Samples are usually recorded with the ScopedTimer helper:
+* \code
+* {
+*   vtkSkinningProfiler::ScopedTimer timer(profiler, vtkSkinningProfiler::GLOBAL_POSE);
+*   ...
+* }
+* \endcode
+*/
+
+#ifndef vtkSkinningProfiler_h
+#define vtkSkinningProfiler_h
+
+#include "vtkSkinningModule.h" // For export macro
+#include <vtkObject.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+class VTKSKINNING_EXPORT vtkSkinningProfiler : public vtkObject
+{
+public:
+  enum Stage
+  {
+    KEY_LOOKUP = 0,
+    GLOBAL_POSE,
+    PALETTE_UPLOAD,
+    BUFFER_BUILD,
+    SHADER_BUILD,
+    RENDER,
+    NUMBER_OF_STAGES
+  };
+
+  static vtkSkinningProfiler* New();
+  vtkTypeMacro(vtkSkinningProfiler, vtkObject)
+
+  /** Enable/Disable sample recording. Enabled by default. */
+  vtkGetMacro(Enabled, bool);
+  vtkSetMacro(Enabled, bool);
+  vtkBooleanMacro(Enabled, bool);
+
+  /** Enable/Disable trace event recording. Disabled by default. */
+  vtkGetMacro(TraceEnabled, bool);
+  vtkSetMacro(TraceEnabled, bool);
+  vtkBooleanMacro(TraceEnabled, bool);
+
+  /** Number of samples used to compute the rolling statistics (default 120). */
+  vtkGetMacro(WindowSize, int);
+  void SetWindowSize(int size);
+
+  /** Maximum number of recorded trace events. Recording stops once reached. */
+  vtkGetMacro(MaximumNumberOfTraceEvents, vtkIdType);
+  vtkSetMacro(MaximumNumberOfTraceEvents, vtkIdType);
+
+  /** Time in seconds elapsed since the creation of the profiler. */
+  double GetTime() const;
+
+  /** Record a sample of the given stage. Times are in seconds (see GetTime()). */
+  void AddSample(int stage, double startTime, double duration);
+
+  /** Rolling statistics of a stage, in seconds. */
+  double GetLastTime(int stage);
+  double GetAverageTime(int stage);
+  double GetMinimumTime(int stage);
+  double GetMaximumTime(int stage);
+  vtkIdType GetNumberOfSamples(int stage);
+
+  static const char* GetStageName(int stage);
+
+  /** Multi-line human readable summary of the rolling statistics (in ms). */
+  std::string GetSummary();
+
+  /** Write the recorded trace events in the Chrome trace-event JSON format. */
+  bool WriteChromeTrace(const char* fileName);
+
+  vtkIdType GetNumberOfTraceEvents();
+
+  /** Clear statistics and trace events. */
+  void Reset();
+
+  /** Record the duration of the enclosing scope as a sample of a stage. */
+  class ScopedTimer
+  {
+  public:
+    ScopedTimer(vtkSkinningProfiler* profiler, int stage)
+      : Profiler(profiler), Stage(stage), StartTime(0.0)
+    {
+      if (this->Profiler != nullptr && this->Profiler->GetEnabled())
+      {
+        this->StartTime = this->Profiler->GetTime();
+      }
+      else
+      {
+        this->Profiler = nullptr;
+      }
+    }
+
+    ~ScopedTimer()
+    {
+      if (this->Profiler != nullptr)
+      {
+        this->Profiler->AddSample(this->Stage, this->StartTime,
+          this->Profiler->GetTime() - this->StartTime);
+      }
+    }
+
+  private:
+    ScopedTimer(const ScopedTimer&) = delete;
+    void operator=(const ScopedTimer&) = delete;
+
+    vtkSkinningProfiler* Profiler;
+    int Stage;
+    double StartTime;
+  };
+
+protected:
+  vtkSkinningProfiler();
+  ~vtkSkinningProfiler() override;
+
+private:
+  vtkSkinningProfiler(const vtkSkinningProfiler&) = delete;
+  void operator=(const vtkSkinningProfiler&) = delete;
+
+  struct TraceEvent
+  {
+    int Stage;
+    double StartTime;
+    double Duration;
+    unsigned int ThreadId;
+  };
+
+  bool Enabled;
+  bool TraceEnabled;
+  int WindowSize;
+  vtkIdType MaximumNumberOfTraceEvents;
+  double Origin; // Clock value at creation
+
+  // Rolling window of samples per stage
+  std::vector<double> Samples[NUMBER_OF_STAGES];
+  size_t NextSample[NUMBER_OF_STAGES];
+  double LastTime[NUMBER_OF_STAGES];
+
+  std::vector<TraceEvent> TraceEvents;
+  std::mutex Lock;
+};
+
+#endif